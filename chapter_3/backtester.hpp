@@ -0,0 +1,387 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <tbb/parallel_for.h>
+#include "exploring_circular_array.hpp"
+#include "flat_hash_map.hpp"
+#include "indexed_heap.hpp"
+#include "position_engine.hpp"
+#include "strategy.hpp"
+
+namespace backtest
+{
+
+using circular_array::Order;
+using circular_array::LimitOrderBook;
+
+enum class EventType : uint8_t {
+    BOOK,    // market-by-price level update: quantity is the new level quantity, 0 deletes the level
+    TRADE    // print: quantity traded at price, is_bid = the aggressor bought
+};
+
+// One historical market data event of one instrument
+struct MarketEvent {
+    int64_t timestamp;   // ns
+    double price;
+    int quantity;
+    EventType type;
+    bool is_bid;
+};
+
+// One instrument's history, in timestamp order
+using EventStream = std::vector<MarketEvent>;
+
+// Read-only window on one instrument's events (an EventStream, or a mapped event file)
+struct StreamView {
+    const MarketEvent* events;
+    size_t count;
+};
+
+inline std::vector<StreamView> views(const std::vector<const EventStream*>& streams) {
+    std::vector<StreamView> out;
+    for (const EventStream* s : streams)
+        out.push_back(StreamView{s->data(), s->size()});
+    return out;
+}
+
+// k-way merge of instrument streams into one timestamp ordered sequence: a 4-ary heap
+// (indexed_heap) of the next event time of each stream, O(log k) per event
+class EventMerger {
+private:
+    struct Head {
+        int64_t ticks;          // timestamp of the stream's next event, the heap key
+        int32_t heap_pos[1];
+    };
+    std::vector<StreamView> streams;
+    std::vector<size_t> cursor;
+    std::vector<Head> heads;
+    indexed_heap::IndexedHeap<Head> heap;
+
+public:
+    EventMerger(std::vector<StreamView> streams)
+        : streams(std::move(streams)), cursor(this->streams.size(), 0), heads(this->streams.size()),
+          heap(heads, static_cast<int>(this->streams.size()), 0, false) {
+        for (size_t s = 0; s < this->streams.size(); s++) {
+            if (this->streams[s].count > 0) {
+                heads[s].ticks = this->streams[s].events[0].timestamp;
+                heap.push(static_cast<int32_t>(s));
+            }
+        }
+    }
+    EventMerger(const std::vector<const EventStream*>& streams) : EventMerger(views(streams)) {}
+
+    // false once every stream is exhausted
+    bool next(int32_t& stream, const MarketEvent*& event) {
+        if (heap.empty())
+            return false;
+        stream = heap.top();
+        event = &streams[stream].events[cursor[stream]++];
+        heap.remove(stream);
+        if (cursor[stream] < streams[stream].count) {
+            heads[stream].ticks = streams[stream].events[cursor[stream]].timestamp;
+            heap.push(stream);
+        }
+        return true;
+    }
+};
+
+struct BacktestConfig {
+    int precision = 2;                  // price decimals, as the books
+    int book_depth = 2000;              // circular array book depth (ticks)
+    int max_orders = 64;                // simulated resting orders per instrument, more are rejected
+    int max_levels = 512;               // price levels tracked per side for queue positions
+    int64_t latency = 0;                // ns between submit and the order reaching the book
+    int64_t sample_interval = 1000000000;   // ns between PnL points
+};
+
+struct SimFill {
+    int64_t timestamp;
+    int32_t instrument;
+    int order_id;
+    double price;
+    int quantity;
+    bool is_bid;
+};
+
+// Strategy orders against historical liquidity. The history isn't changed by our orders (no
+// market impact); fills follow a conservative queue model:
+// - an order that crosses the book when it arrives takes the opposite touch, up to its quantity
+// - the rest joins the back of its level: queue_ahead = the level's visible quantity
+// - a level update can only shrink queue_ahead (cancels are assumed to come from behind us
+//   until the level is smaller than our place in it)
+// - a trade at our price consumes queue_ahead first, then fills us; a trade through our price
+//   means the whole level went, we are filled at our price
+class SimulatedVenue : public strategy::OrderGateway {
+private:
+    struct SimOrder {
+        int id;
+        int64_t ticks;
+        double price;
+        int quantity;
+        int64_t queue_ahead;
+        int64_t active_at;      // reaches the book at this time (latency)
+        bool is_bid;
+        bool active;
+    };
+    LimitOrderBook& book;
+    const BacktestConfig& config;
+    int32_t instrument;
+    double step_value;
+    const int64_t* clock;
+    std::vector<SimOrder> orders;   // in arrival order, so FIFO among our own orders
+    flat_hash::FlatHashMap<int64_t, int64_t> levels[2];   // visible quantity by ticks, [0] offers, [1] bids
+    std::vector<SimFill> pending_fills;
+    int rejected = 0;
+
+    int64_t to_ticks(double price) const { return std::llround(price * step_value); }
+    int64_t visible(bool is_bid, int64_t ticks) {
+        int64_t* quantity = levels[is_bid].find(ticks);
+        return quantity != nullptr ? *quantity : 0;
+    }
+    void fill(SimOrder& order, double price, int quantity) {
+        order.quantity -= quantity;
+        pending_fills.push_back(SimFill{*clock, instrument, order.id, price, quantity, order.is_bid});
+    }
+    void activate(SimOrder& order) {
+        order.active = true;
+        Order touch = order.is_bid ? book.get_best_offer() : book.get_best_bid();
+        bool crosses = touch.quantity > 0 && (order.is_bid ? touch.price <= order.price : touch.price >= order.price);
+        if (crosses)
+            fill(order, touch.price, std::min(order.quantity, touch.quantity));
+        order.queue_ahead = visible(order.is_bid, order.ticks);
+    }
+    void remove_done() {
+        orders.erase(std::remove_if(orders.begin(), orders.end(), [](const SimOrder& o) { return o.quantity == 0; }), orders.end());
+    }
+
+public:
+    SimulatedVenue(LimitOrderBook& book, const BacktestConfig& config, int32_t instrument, const int64_t* clock)
+        : book(book), config(config), instrument(instrument), step_value(std::pow(10, config.precision)), clock(clock),
+          levels{flat_hash::FlatHashMap<int64_t, int64_t>(config.max_levels), flat_hash::FlatHashMap<int64_t, int64_t>(config.max_levels)} {
+        orders.reserve(config.max_orders);
+    }
+
+    void submit(const Order& order, bool is_bid) override {
+        if (static_cast<int>(orders.size()) >= config.max_orders || order.quantity <= 0) {
+            rejected++;
+            return;
+        }
+        orders.push_back(SimOrder{order.id, to_ticks(order.price), order.price, order.quantity, 0, *clock + config.latency, is_bid, false});
+        if (config.latency == 0) {
+            activate(orders.back());
+            remove_done();
+        }
+    }
+
+    bool cancel(int id) {
+        for (size_t i = 0; i < orders.size(); i++) {
+            if (orders[i].id == id) {
+                orders.erase(orders.begin() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Orders whose latency has elapsed reach the book (before the event at "now" is applied)
+    void advance(int64_t now) {
+        bool any = false;
+        for (SimOrder& o : orders) {
+            if (!o.active && o.active_at <= now) {
+                activate(o);
+                any = true;
+            }
+        }
+        if (any)
+            remove_done();
+    }
+
+    // Called with every event of the instrument, after the book has been updated
+    void on_event(const MarketEvent& e) {
+        int64_t ticks = to_ticks(e.price);
+        if (e.type == EventType::BOOK) {
+            if (e.quantity == 0)
+                levels[e.is_bid].erase(ticks);
+            else
+                levels[e.is_bid].insert(ticks, e.quantity);
+            for (SimOrder& o : orders)
+                if (o.active && o.is_bid == e.is_bid && o.ticks == ticks)
+                    o.queue_ahead = std::min<int64_t>(o.queue_ahead, e.quantity);
+            return;
+        }
+        // a buyer lifts offers (our sells), a seller hits bids (our buys)
+        int64_t remaining = e.quantity;
+        bool resting_bid = !e.is_bid;
+        for (SimOrder& o : orders) {
+            if (!o.active || o.is_bid != resting_bid)
+                continue;
+            bool through = resting_bid ? ticks < o.ticks : ticks > o.ticks;
+            if (through) {
+                fill(o, o.price, o.quantity);
+            }
+            else if (ticks == o.ticks && remaining > 0) {
+                int64_t consumed = std::min(o.queue_ahead, remaining);
+                o.queue_ahead -= consumed;
+                remaining -= consumed;
+                int quantity = static_cast<int>(std::min<int64_t>(remaining, o.quantity));
+                if (quantity > 0) {
+                    fill(o, o.price, quantity);
+                    remaining -= quantity;
+                }
+            }
+        }
+        remove_done();
+    }
+
+    // No orders, no levels, storage kept
+    void clear() {
+        orders.clear();
+        levels[0].clear();
+        levels[1].clear();
+        pending_fills.clear();
+        rejected = 0;
+    }
+
+    std::vector<SimFill>& fills() { return pending_fills; }
+    size_t resting() const { return orders.size(); }
+    int64_t queue_ahead(int id) const {
+        for (const SimOrder& o : orders)
+            if (o.id == id)
+                return o.queue_ahead;
+        return -1;
+    }
+    int rejected_orders() const { return rejected; }
+};
+
+struct PnlPoint {
+    int64_t timestamp;
+    double realized;
+    double unrealized;
+};
+
+struct BacktestResult {
+    std::vector<PnlPoint> pnl;          // every sample_interval of event time, and at the end
+    std::vector<int64_t> positions;     // final position by instrument
+    uint64_t events = 0;
+    uint64_t fills = 0;
+    int rejected_orders = 0;
+};
+
+// Replays the merged history of a set of instruments through one circular_array book, one
+// simulated venue and one strategy per instrument, single threaded (run independent days or
+// instrument groups in parallel with run_parallel). For every event, in timestamp order:
+// orders whose latency has elapsed reach the venue, the event updates the book, the venue
+// applies it to the simulated orders, fills go to a position_engine::PositionEngine, and book
+// updates call strategy.on_book_update(). make(book, gateway) builds the strategy of an
+// instrument, e.g. a strategy::StrategyModule.
+template <class Strategy>
+class Backtester {
+private:
+    struct Instrument {
+        LimitOrderBook book;
+        SimulatedVenue venue;
+        Strategy strategy;
+
+        template <class Factory>
+        Instrument(const BacktestConfig& config, int32_t id, const int64_t* clock, Factory& make)
+            : book(config.precision, config.book_depth), venue(book, config, id, clock), strategy(make(book, venue)) {}
+    };
+    BacktestConfig config;
+    int64_t clock = 0;
+    std::vector<std::unique_ptr<Instrument>> instruments;
+    position_engine::PositionEngine positions;
+
+public:
+    template <class Factory>
+    Backtester(size_t num_instruments, const BacktestConfig& config, Factory make)
+        : config(config), positions(static_cast<int>(num_instruments)) {
+        for (size_t i = 0; i < num_instruments; i++)
+            instruments.emplace_back(new Instrument(this->config, static_cast<int32_t>(i), &clock, make));
+    }
+
+    // streams[i] is instrument i's history
+    BacktestResult run(const std::vector<const EventStream*>& streams) { return run(views(streams)); }
+    BacktestResult run(std::vector<StreamView> streams) {
+        BacktestResult result;
+        EventMerger merger(std::move(streams));
+        int32_t stream;
+        const MarketEvent* event;
+        int64_t next_sample = -1;
+        while (merger.next(stream, event)) {
+            clock = event->timestamp;
+            if (next_sample < 0)
+                next_sample = clock + config.sample_interval;
+            while (clock >= next_sample) {
+                positions.revalue();
+                result.pnl.push_back(PnlPoint{next_sample, positions.portfolio().realized, positions.portfolio().unrealized});
+                next_sample += config.sample_interval;
+            }
+            Instrument& instrument = *instruments[stream];
+            instrument.venue.advance(clock);
+            if (event->type == EventType::BOOK) {
+                if (event->quantity == 0)
+                    instrument.book.delete_order(Order(0, event->price, 0), event->is_bid);
+                else
+                    instrument.book.update_order(Order(0, event->price, event->quantity), event->is_bid);
+            }
+            instrument.venue.on_event(*event);
+            if (event->type == EventType::BOOK) {
+                Order bid = instrument.book.get_best_bid();
+                Order offer = instrument.book.get_best_offer();
+                if (bid.quantity > 0 && offer.quantity > 0)
+                    positions.on_bbo(stream, bid.price, offer.price);
+                instrument.strategy.on_book_update();
+            }
+            std::vector<SimFill>& fills = instrument.venue.fills();
+            for (const SimFill& f : fills)
+                positions.on_fill(f.instrument, f.is_bid ? f.quantity : -f.quantity, f.price);
+            result.fills += fills.size();
+            fills.clear();
+            result.events++;
+        }
+        positions.resync();
+        result.pnl.push_back(PnlPoint{clock, positions.portfolio().realized, positions.portfolio().unrealized});
+        for (size_t i = 0; i < instruments.size(); i++) {
+            result.positions.push_back(positions.instrument(static_cast<int32_t>(i)).position);
+            result.rejected_orders += instruments[i]->venue.rejected_orders();
+        }
+        return result;
+    }
+
+    // Empty books, venues and positions for another run over the same instruments, nothing
+    // reallocated (strategies are reset by the caller, e.g. StrategyModule::reset)
+    void reset() {
+        clock = 0;
+        for (std::unique_ptr<Instrument>& instrument : instruments) {
+            instrument->book.clear();
+            instrument->venue.clear();
+        }
+        positions.clear();
+    }
+    size_t size() const { return instruments.size(); }
+
+    SimulatedVenue& venue(int32_t instrument) { return instruments[instrument]->venue; }
+    LimitOrderBook& book(int32_t instrument) { return instruments[instrument]->book; }
+    Strategy& strategy(int32_t instrument) { return instruments[instrument]->strategy; }
+};
+
+// Independent backtests (e.g. one per day, or per group of instruments) on the TBB pool, one
+// Backtester per job; results in job order, each identical to a serial run of the job
+template <class Factory>
+std::vector<BacktestResult> run_parallel(const std::vector<std::vector<const EventStream*>>& jobs,
+                                         const BacktestConfig& config, Factory make) {
+    using Strategy = decltype(make(std::declval<LimitOrderBook&>(), std::declval<strategy::OrderGateway&>()));
+    std::vector<BacktestResult> results(jobs.size());
+    tbb::parallel_for(size_t(0), jobs.size(), [&](size_t j) {
+        Backtester<Strategy> backtester(jobs[j].size(), config, make);
+        results[j] = backtester.run(jobs[j]);
+    });
+    return results;
+}
+
+} // namespace backtest
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace book_depth
+{
+
+// Market-by-price snapshot of one side, best level first, filled by the book without allocating.
+// Prices and quantities are kept in separate arrays (SoA) so the kernels below can load
+// 4 levels per instruction instead of striding over Order objects.
+template <int N>
+struct alignas(64) DepthLevels {
+    double price[N];
+    int32_t quantity[N];
+    int64_t cumulative[N];  // filled by cumulative_sum(), not by the book
+    int count;
+
+    static constexpr int capacity() { return N; }
+};
+
+// out[i] = qty[0] + ... + qty[i], widened to 64 bits.
+// AVX2: 4 levels per step, log2(4) shift+add inside the register, then the running total is added.
+inline void cumulative_sum(const int32_t* qty, int64_t* out, int n) {
+    int i = 0;
+    int64_t total = 0;
+#if defined(__AVX2__)
+    __m256i carry = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(qty + i)));
+        x = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));                   // [a, a+b | c, c+d]
+        __m256i low = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 1, 0, 0)); // [., ., a+b, a+b]
+        x = _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_setzero_si256(), low, 0xF0));
+        x = _mm256_add_epi64(x, carry);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), x);
+        carry = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    if (i > 0)
+        total = out[i - 1];
+#endif
+    for (; i < n; i++) {
+        total += qty[i];
+        out[i] = total;
+    }
+}
+
+// Index of the first level where the cumulative volume reaches "shares", or n if the side is too thin.
+inline int levels_to_fill(const int64_t* cumulative, int n, int64_t shares) {
+    int i = 0;
+#if defined(__AVX2__)
+    __m256i target = _mm256_set1_epi64x(shares - 1);
+    for (; i + 4 <= n; i += 4) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cumulative + i));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(c, target)));
+        if (mask != 0)
+            return i + __builtin_ctz(mask);
+    }
+#endif
+    for (; i < n; i++) {
+        if (cumulative[i] >= shares)
+            return i;
+    }
+    return n;
+}
+
+// Walks the snapshot (after cumulative_sum) to fill "shares".
+// Returns the last price touched (the limit price needed to sweep that size) and writes the VWAP of the fill.
+// Returns 0 and leaves vwap untouched when the visible depth can't fill the size.
+template <int N>
+inline double price_to_fill(const DepthLevels<N>& depth, int64_t shares, double* vwap) {
+    int last = levels_to_fill(depth.cumulative, depth.count, shares);
+    if (shares <= 0 || last == depth.count)
+        return 0;
+
+    // notional of the fully taken levels [0, last), then the partial one
+    double notional = 0;
+    int i = 0;
+#if defined(__AVX2__)
+    __m256d acc = _mm256_setzero_pd();
+    for (; i + 4 <= last; i += 4) {
+        __m256d p = _mm256_loadu_pd(depth.price + i);
+        __m256d q = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(depth.quantity + i)));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(p, q));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, acc);
+    notional = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < last; i++)
+        notional += depth.price[i] * depth.quantity[i];
+
+    int64_t taken = last > 0 ? depth.cumulative[last - 1] : 0;
+    notional += depth.price[last] * static_cast<double>(shares - taken);
+    *vwap = notional / static_cast<double>(shares);
+    return depth.price[last];
+}
+
+} // namespace book_depth
@@ -0,0 +1,603 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include "flat_hash_map.hpp"
+
+namespace bplus_tree
+{
+
+class Order {
+public:
+    int id;
+    double price;
+    int quantity;
+
+    Order() : id(0), price(0), quantity(0) {}
+    Order(int id, double price, int quantity) : id(id), price(price), quantity(quantity) {}
+    void reset()
+    {
+        id=0;
+        price=0.0;
+        quantity=0.0;
+    }
+};
+
+const int NODE_KEYS = 8;     // 8 x int64 keys = one 64-byte cache line
+const int32_t NIL = -1;
+const int64_t NO_KEY = INT64_MAX; // unused key slots, never smaller than a real key
+
+// Number of keys in the (sorted, NO_KEY padded) node that are smaller than "key".
+// With AVX2 the whole cache line is compared in two instructions, no branches.
+inline int count_less(const int64_t* keys, int64_t key) {
+#if defined(__AVX2__)
+    __m256i k = _mm256_set1_epi64x(key);
+    __m256i lo = _mm256_load_si256(reinterpret_cast<const __m256i*>(keys));
+    __m256i hi = _mm256_load_si256(reinterpret_cast<const __m256i*>(keys + 4));
+    int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, lo)))
+             | (_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, hi))) << 4);
+    return __builtin_popcount(mask);
+#else
+    int n = 0;
+    for (int i = 0; i < NODE_KEYS; i++)
+        n += keys[i] < key;
+    return n;
+#endif
+}
+
+// B+tree from price ticks to a price level slot.
+// Inner nodes and leaves come from index-linked pools; the key array of every node is one
+// aligned cache line. Leaves are chained both ways so depth can be walked in price order.
+// Deletes free a node only once it is empty (no borrow/merge): separators stay valid routing
+// keys, and for a book, where levels come and go around the touch, it avoids rebalancing churn.
+// Both pools are reserved up front and never grow, so node references stay valid: every live
+// leaf holds a key, so "capacity" + 1 leaves always suffice; inner nodes can outnumber the
+// reserve only after pathological insert / delete patterns, and then insert() throws before
+// changing anything.
+class PriceTree {
+private:
+    struct alignas(64) Leaf {
+        int64_t keys[NODE_KEYS];
+        int32_t values[NODE_KEYS];
+        int32_t next;
+        int32_t prev;
+        int32_t count;
+    };
+    struct alignas(64) Inner {
+        int64_t keys[NODE_KEYS];            // separators: child i holds keys in [keys[i-1], keys[i])
+        int32_t children[NODE_KEYS + 1];
+        int32_t count;                      // number of children
+    };
+
+    std::vector<Leaf> leaves;
+    std::vector<Inner> inners;
+    int32_t free_leaf;
+    int32_t free_inner;
+    int32_t spare_leaves;                   // nodes new_leaf() / new_inner() can still hand out
+    int32_t spare_inners;
+    int32_t root;
+    int height;                             // 0 => root is a leaf
+    int32_t first_leaf;
+    int32_t last_leaf;
+    int size;
+
+    // path from the root to the current leaf: node and the child position taken
+    int32_t path_node[64];
+    int path_pos[64];
+
+    int32_t new_leaf() {
+        spare_leaves--;
+        int32_t idx;
+        if (free_leaf != NIL) {
+            idx = free_leaf;
+            free_leaf = leaves[idx].next;
+        } else {
+            idx = leaves.size();
+            leaves.emplace_back();
+        }
+        Leaf& leaf = leaves[idx];
+        for (int i = 0; i < NODE_KEYS; i++)
+            leaf.keys[i] = NO_KEY;
+        leaf.next = leaf.prev = NIL;
+        leaf.count = 0;
+        return idx;
+    }
+    int32_t new_inner() {
+        spare_inners--;
+        int32_t idx;
+        if (free_inner != NIL) {
+            idx = free_inner;
+            free_inner = inners[idx].children[0];
+        } else {
+            idx = inners.size();
+            inners.emplace_back();
+        }
+        Inner& inner = inners[idx];
+        for (int i = 0; i < NODE_KEYS; i++)
+            inner.keys[i] = NO_KEY;
+        inner.count = 0;
+        return idx;
+    }
+    void free_leaf_node(int32_t idx) {
+        spare_leaves++;
+        leaves[idx].next = free_leaf;
+        free_leaf = idx;
+    }
+    void free_inner_node(int32_t idx) {
+        spare_inners++;
+        inners[idx].children[0] = free_inner;
+        free_inner = idx;
+    }
+
+    // Walks down to the leaf that owns "key", filling path_node/path_pos
+    int32_t descend(int64_t key) {
+        int32_t node = root;
+        for (int level = height; level > 0; level--) {
+            const Inner& inner = inners[node];
+            // child = number of separators <= key
+            int pos = count_less(inner.keys, key + 1);
+            path_node[level] = node;
+            path_pos[level] = pos;
+            node = inner.children[pos];
+        }
+        return node;
+    }
+
+    // Inserts separator "key" with right child "child" after position "pos" of the inner node at "level"
+    void insert_in_parent(int level, int64_t key, int32_t child) {
+        if (level > height) {
+            // the root was split: grow the tree by one level
+            int32_t new_root = new_inner();
+            Inner& r = inners[new_root];
+            r.children[0] = root;
+            r.children[1] = child;
+            r.keys[0] = key;
+            r.count = 2;
+            root = new_root;
+            height++;
+            return;
+        }
+        int32_t node = path_node[level];
+        int pos = path_pos[level];
+        if (inners[node].count <= NODE_KEYS) {
+            Inner& inner = inners[node];
+            for (int i = inner.count - 1; i > pos; i--) {
+                inner.children[i + 1] = inner.children[i];
+                inner.keys[i] = inner.keys[i - 1];
+            }
+            inner.children[pos + 1] = child;
+            inner.keys[pos] = key;
+            inner.count++;
+            return;
+        }
+
+        // full: split 9 separators / 10 children around the middle separator
+        int64_t keys[NODE_KEYS + 1];
+        int32_t children[NODE_KEYS + 2];
+        {
+            const Inner& inner = inners[node];
+            for (int i = 0; i < NODE_KEYS + 1; i++)
+                children[i] = inner.children[i];
+            for (int i = 0; i < NODE_KEYS; i++)
+                keys[i] = inner.keys[i];
+        }
+        for (int i = NODE_KEYS + 1; i > pos + 1; i--)
+            children[i] = children[i - 1];
+        children[pos + 1] = child;
+        for (int i = NODE_KEYS; i > pos; i--)
+            keys[i] = keys[i - 1];
+        keys[pos] = key;
+
+        const int left_children = (NODE_KEYS + 2) / 2;
+        int32_t right = new_inner();
+        Inner& l = inners[node];
+        Inner& r = inners[right];
+        for (int i = 0; i < NODE_KEYS; i++)
+            l.keys[i] = NO_KEY;
+        for (int i = 0; i < left_children; i++)
+            l.children[i] = children[i];
+        for (int i = 0; i < left_children - 1; i++)
+            l.keys[i] = keys[i];
+        l.count = left_children;
+        for (int i = left_children; i < NODE_KEYS + 2; i++)
+            r.children[i - left_children] = children[i];
+        for (int i = left_children; i < NODE_KEYS + 1; i++)
+            r.keys[i - left_children] = keys[i];
+        r.count = NODE_KEYS + 2 - left_children;
+        insert_in_parent(level + 1, keys[left_children - 1], right);
+    }
+
+    // Removes child "pos" from the inner node at "level", freeing nodes that become empty
+    void remove_from_parent(int level) {
+        if (level > height)
+            return;
+        int32_t node = path_node[level];
+        int pos = path_pos[level];
+        Inner& inner = inners[node];
+        // drop the child and the separator on its left (or on its right for the first child)
+        int key_pos = pos > 0 ? pos - 1 : 0;
+        for (int i = pos; i < inner.count - 1; i++)
+            inner.children[i] = inner.children[i + 1];
+        for (int i = key_pos; i < NODE_KEYS - 1; i++)
+            inner.keys[i] = inner.keys[i + 1];
+        inner.keys[NODE_KEYS - 1] = NO_KEY;
+        inner.count--;
+        if (inner.count == 0) {
+            free_inner_node(node);
+            remove_from_parent(level + 1);
+        }
+    }
+
+public:
+    PriceTree(int capacity) : free_leaf(NIL), free_inner(NIL), spare_leaves(capacity + 1), spare_inners(capacity / 2 + 64),
+                              root(NIL), height(0), first_leaf(NIL), last_leaf(NIL), size(0) {
+        leaves.reserve(spare_leaves);
+        inners.reserve(spare_inners);
+    }
+
+    int32_t* find(int64_t key) {
+        if (root == NIL)
+            return nullptr;
+        Leaf& leaf = leaves[descend(key)];
+        int pos = count_less(leaf.keys, key);
+        if (pos < leaf.count && leaf.keys[pos] == key)
+            return &leaf.values[pos];
+        return nullptr;
+    }
+
+    // Returns false if the key was already there (value left untouched)
+    bool insert(int64_t key, int32_t value) {
+        if (root == NIL) {
+            root = first_leaf = last_leaf = new_leaf();
+            height = 0;
+        }
+        int32_t idx = descend(key);
+        int pos = count_less(leaves[idx].keys, key);
+        if (pos < leaves[idx].count && leaves[idx].keys[pos] == key)
+            return false;
+        if (leaves[idx].count == NODE_KEYS && !can_split())
+            throw "PriceTree node pool exhausted";
+        size++;
+
+        if (leaves[idx].count < NODE_KEYS) {
+            Leaf& leaf = leaves[idx];
+            for (int i = leaf.count; i > pos; i--) {
+                leaf.keys[i] = leaf.keys[i - 1];
+                leaf.values[i] = leaf.values[i - 1];
+            }
+            leaf.keys[pos] = key;
+            leaf.values[pos] = value;
+            leaf.count++;
+            return true;
+        }
+
+        // full leaf: split in two halves, the new key goes to its side
+        int32_t right = new_leaf();
+        Leaf& l = leaves[idx];
+        Leaf& r = leaves[right];
+        int64_t keys[NODE_KEYS + 1];
+        int32_t values[NODE_KEYS + 1];
+        for (int i = 0, j = 0; i < NODE_KEYS + 1; i++) {
+            if (i == pos) {
+                keys[i] = key;
+                values[i] = value;
+            } else {
+                keys[i] = l.keys[j];
+                values[i] = l.values[j];
+                j++;
+            }
+        }
+        const int left_count = (NODE_KEYS + 1) / 2 + 1;
+        for (int i = 0; i < NODE_KEYS; i++)
+            l.keys[i] = NO_KEY;
+        for (int i = 0; i < left_count; i++) {
+            l.keys[i] = keys[i];
+            l.values[i] = values[i];
+        }
+        l.count = left_count;
+        for (int i = left_count; i < NODE_KEYS + 1; i++) {
+            r.keys[i - left_count] = keys[i];
+            r.values[i - left_count] = values[i];
+        }
+        r.count = NODE_KEYS + 1 - left_count;
+
+        r.next = l.next;
+        r.prev = idx;
+        if (l.next != NIL)
+            leaves[l.next].prev = right;
+        else
+            last_leaf = right;
+        l.next = right;
+
+        insert_in_parent(1, r.keys[0], right);
+        return true;
+    }
+
+    bool erase(int64_t key) {
+        if (root == NIL)
+            return false;
+        int32_t idx = descend(key);
+        Leaf& leaf = leaves[idx];
+        int pos = count_less(leaf.keys, key);
+        if (pos >= leaf.count || leaf.keys[pos] != key)
+            return false;
+        for (int i = pos; i < leaf.count - 1; i++) {
+            leaf.keys[i] = leaf.keys[i + 1];
+            leaf.values[i] = leaf.values[i + 1];
+        }
+        leaf.count--;
+        leaf.keys[leaf.count] = NO_KEY;
+        size--;
+        if (leaf.count > 0)
+            return true;
+
+        // empty leaf: unlink it from the chain and from its parent
+        if (leaf.prev != NIL)
+            leaves[leaf.prev].next = leaf.next;
+        else
+            first_leaf = leaf.next;
+        if (leaf.next != NIL)
+            leaves[leaf.next].prev = leaf.prev;
+        else
+            last_leaf = leaf.prev;
+        free_leaf_node(idx);
+        if (height == 0) {
+            root = NIL;
+            return true;
+        }
+        remove_from_parent(1);
+        if (size == 0) {
+            // the last leaf took every inner node with it
+            root = NIL;
+            height = 0;
+            return true;
+        }
+        // collapse single-child roots
+        while (height > 0 && inners[root].count == 1) {
+            int32_t old_root = root;
+            root = inners[root].children[0];
+            free_inner_node(old_root);
+            height--;
+        }
+        return true;
+    }
+
+    // A split takes one leaf and at most one inner node per level, plus a new root: while this
+    // holds, insert() can't run out of nodes
+    bool can_split() const { return spare_leaves >= 1 && spare_inners >= height + 1 && height + 2 < 64; }
+
+    bool empty() const { return size == 0; }
+    int count() const { return size; }
+
+    // Lowest / highest key, O(1) through the leaf chain ends
+    int64_t min_key() const { return leaves[first_leaf].keys[0]; }
+    int64_t max_key() const { return leaves[last_leaf].keys[leaves[last_leaf].count - 1]; }
+    int32_t min_value() const { return leaves[first_leaf].values[0]; }
+    int32_t max_value() const { return leaves[last_leaf].values[leaves[last_leaf].count - 1]; }
+
+    // Visits up to "max_levels" values in ascending (or descending) key order, following the leaf chain
+    template <class F>
+    void for_each(bool ascending, int max_levels, F f) const {
+        int visited = 0;
+        if (ascending) {
+            for (int32_t l = first_leaf; l != NIL && visited < max_levels; l = leaves[l].next)
+                for (int i = 0; i < leaves[l].count && visited < max_levels; i++, visited++)
+                    f(leaves[l].keys[i], leaves[l].values[i]);
+        } else {
+            for (int32_t l = last_leaf; l != NIL && visited < max_levels; l = leaves[l].prev)
+                for (int i = leaves[l].count - 1; i >= 0 && visited < max_levels; i--, visited++)
+                    f(leaves[l].keys[i], leaves[l].values[i]);
+        }
+    }
+};
+
+
+class LimitOrderBook {
+private:
+    // Aggregated price level, orders queued FIFO through an intrusive list
+    struct Level {
+        int64_t ticks;
+        double price;
+        int quantity;
+        int32_t head;
+        int32_t tail;
+        int32_t next_free;
+    };
+    struct OrderNode {
+        int id;
+        int quantity;
+        int32_t level;
+        int32_t prev;
+        int32_t next;
+        bool is_bid;
+    };
+
+    PriceTree bids;
+    PriceTree offers;
+    std::vector<Level> levels;
+    std::vector<OrderNode> orders;
+    int32_t free_level;
+    int32_t free_order;
+    flat_hash::FlatHashMap<int, int32_t> order_index;   // order id => slot in "orders"
+    int depth;
+    double step_value;
+
+    int64_t price_to_ticks(double price) const {
+        return std::llround(price * step_value);
+    }
+
+    void unlink_order(int32_t o) {
+        OrderNode& order = orders[o];
+        Level& level = levels[order.level];
+        if (order.prev != NIL) orders[order.prev].next = order.next; else level.head = order.next;
+        if (order.next != NIL) orders[order.next].prev = order.prev; else level.tail = order.prev;
+        level.quantity -= order.quantity;
+        order_index.erase(order.id);
+        order.next = free_order;
+        free_order = o;
+    }
+
+    void remove_level(int32_t l, bool is_bid) {
+        // drops every order still resting at the level, then the level itself
+        for (int32_t o = levels[l].head; o != NIL; ) {
+            int32_t next = orders[o].next;
+            unlink_order(o);
+            o = next;
+        }
+        (is_bid ? bids : offers).erase(levels[l].ticks);
+        levels[l].next_free = free_level;
+        free_level = l;
+    }
+
+    Order level_to_order(int32_t l) const {
+        const Level& level = levels[l];
+        int id = level.head != NIL ? orders[level.head].id : 0;
+        return Order(id, level.price, level.quantity);
+    }
+
+public:
+    LimitOrderBook(int precision, int depth, int max_orders = 0)
+        : bids(depth), offers(depth), free_level(NIL), free_order(NIL),
+          order_index(max_orders > 0 ? max_orders : depth * 4), depth(depth) {
+        step_value = std::pow(10, precision);
+        int order_capacity = max_orders > 0 ? max_orders : depth * 4;
+        levels.resize(2 * depth);
+        for (int32_t i = 2 * depth - 1; i >= 0; i--) {
+            levels[i].next_free = free_level;
+            free_level = i;
+        }
+        orders.resize(order_capacity);
+        for (int32_t i = order_capacity - 1; i >= 0; i--) {
+            orders[i].next = free_order;
+            free_order = i;
+        }
+    }
+
+    void add_order(const Order& order, bool is_bid) {
+        if (order_index.find(order.id) != nullptr) {
+            update_order(order, is_bid);
+            return;
+        }
+        if (free_order == NIL)
+            return; // out of order slots
+        PriceTree& side = is_bid ? bids : offers;
+        int64_t ticks = price_to_ticks(order.price);
+        int32_t* found = side.find(ticks);
+        int32_t l;
+        if (found != nullptr) {
+            l = *found;
+        } else {
+            if (side.count() == depth) {
+                // full: discard worse prices, otherwise evict the worst level
+                int64_t worst = is_bid ? side.min_key() : side.max_key();
+                if (is_bid ? ticks <= worst : ticks >= worst)
+                    return;
+                // checked before the eviction, so a throw leaves the book unchanged (conservative:
+                // the insert may not even need to split)
+                if (!side.can_split())
+                    throw "PriceTree node pool exhausted";
+                remove_level(is_bid ? side.min_value() : side.max_value(), is_bid);
+            }
+            l = free_level;
+            side.insert(ticks, l);   // before taking the level: throws with the book unchanged if the tree is out of nodes
+            free_level = levels[l].next_free;
+            Level& level = levels[l];
+            level.ticks = ticks;
+            level.price = order.price;
+            level.quantity = 0;
+            level.head = level.tail = NIL;
+        }
+        int32_t o = free_order;
+        free_order = orders[o].next;
+        OrderNode& node = orders[o];
+        node.id = order.id;
+        node.quantity = order.quantity;
+        node.level = l;
+        node.is_bid = is_bid;
+        node.next = NIL;
+        node.prev = levels[l].tail;
+        if (levels[l].tail != NIL) orders[levels[l].tail].next = o; else levels[l].head = o;
+        levels[l].tail = o;
+        levels[l].quantity += order.quantity;
+        order_index.insert(order.id, o);
+    }
+
+    void update_order(const Order& order, bool is_bid) {
+        int32_t* o = order_index.find(order.id);
+        if (o == nullptr) {
+            add_order(order, is_bid);
+            return;
+        }
+        OrderNode& node = orders[*o];
+        if (node.is_bid == is_bid && levels[node.level].ticks == price_to_ticks(order.price)) {
+            // same price: quantity change in place, keeps queue position
+            levels[node.level].quantity += order.quantity - node.quantity;
+            node.quantity = order.quantity;
+            return;
+        }
+        delete_order(order, is_bid);
+        add_order(order, is_bid);
+    }
+
+    // Cancel by order id: O(1) through the id index; the tree is only touched if the level empties
+    void delete_order(const Order& order, bool /*is_bid*/) {
+        int32_t* found = order_index.find(order.id);
+        if (found == nullptr)
+            return;
+        int32_t o = *found;
+        int32_t l = orders[o].level;
+        bool side = orders[o].is_bid;
+        unlink_order(o);
+        if (levels[l].head == NIL)
+            remove_level(l, side);
+    }
+
+    Order get_best_bid() {
+        if (bids.empty()) {
+            throw "Order book is empty";
+        }
+        return level_to_order(bids.max_value());
+    }
+    Order get_lowest_bid() {
+        if (bids.empty()) {
+            throw "Order book is empty";
+        }
+        return level_to_order(bids.min_value());
+    }
+
+    Order get_best_offer() {
+        if (offers.empty()) {
+            throw "Order book is empty";
+        }
+        return level_to_order(offers.min_value());
+    }
+    Order get_highest_offer() {
+        if (offers.empty()) {
+            throw "Order book is empty";
+        }
+        return level_to_order(offers.max_value());
+    }
+
+    // Aggregated depth from the best price outwards, walking the linked leaves
+    template <class F>
+    void for_each_level(bool is_bid, int max_levels, F f) const {
+        (is_bid ? bids : offers).for_each(!is_bid, max_levels, [&](int64_t, int32_t l) {
+            f(level_to_order(l));
+        });
+    }
+
+    void print_bids() {
+        for_each_level(true, depth, [](const Order& o) { std::cout << o.price << " "; });
+        std::cout << std::endl;
+    }
+    void print_offers() {
+        for_each_level(false, depth, [](const Order& o) { std::cout << o.price << " "; });
+        std::cout << std::endl;
+    }
+};
+
+} // namespace bplus_tree
@@ -3,6 +3,8 @@
 #include <cmath>
 #include <algorithm>
 #include <iostream>
+#include <cstdint>
+#include "book_depth.hpp"
 
 namespace circular_array
 {
@@ -31,208 +33,246 @@ private:
     int precision;
     int depth;
     double step_value;
-    
+    int top_levels;         // window (in ticks from the touch) whose volume is kept up to date
+    int64_t top_volume[2];  // [0] offers, [1] bids
+
+    // Ticks between the slot and the best price of its side (ring order), -1 if the slot is outside ini..end
+    int distance_from_best(int index, bool is_bid) const {
+        int ini = is_bid ? ptr_bid_ini - &bids[0] : ptr_offer_ini - &offers[0];
+        int end = is_bid ? ptr_bid_end - &bids[0] : ptr_offer_end - &offers[0];
+        int span = (end - ini + depth) % depth;
+        int distance = is_bid ? (end - index + depth) % depth : (index - ini + depth) % depth;
+        return distance <= span ? distance : -1;
+    }
+
+    int64_t volume_near_touch(bool is_bid) const {
+        int64_t volume = 0;
+        for_each_slot(is_bid, [&](const Order& o, int ticks) {
+            if (ticks >= top_levels)
+                return false;
+            volume += o.quantity;
+            return true;
+        });
+        return volume;
+    }
+
+    // Writes a slot (index -1: price discarded, nothing written) and keeps top_volume in sync:
+    // O(1) when the ring didn't move, O(top_levels) re-scan when price_to_index shifted the
+    // ini/end pointers (which can happen even when the price itself ends up discarded).
+    void set_level(int index, const Order& order, bool is_bid, const Order* ini_before, const Order* end_before) {
+        std::vector<Order>& side = is_bid ? bids : offers;
+        int previous = 0;
+        if (index > -1) {
+            previous = side[index].quantity;
+            side[index] = order;
+        }
+        bool moved = is_bid ? (ptr_bid_ini != ini_before || ptr_bid_end != end_before)
+                            : (ptr_offer_ini != ini_before || ptr_offer_end != end_before);
+        if (moved)
+            top_volume[is_bid] = volume_near_touch(is_bid);
+        else if (index > -1) {
+            int distance = distance_from_best(index, is_bid);
+            if (distance > -1 && distance < top_levels)
+                top_volume[is_bid] += order.quantity - previous;
+        }
+    }
+
+    // Visits the ring from the best price outwards: f(slot, ticks from best) returns false to stop.
+    // No modulo in the loop, the index just wraps at the end of the array.
+    template <class F>
+    void for_each_slot(bool is_bid, F f) const {
+        const Order* ini = is_bid ? ptr_bid_ini : ptr_offer_ini;
+        const Order* end = is_bid ? ptr_bid_end : ptr_offer_end;
+        if (ini == nullptr)
+            return;
+        const std::vector<Order>& side = is_bid ? bids : offers;
+        int first = ini - &side[0];
+        int last = end - &side[0];
+        int slots = (last - first + depth) % depth + 1;
+        int i = is_bid ? last : first;
+        for (int ticks = 0; ticks < slots; ticks++) {
+            if (!f(side[i], ticks))
+                return;
+            if (is_bid)
+                i = (i == 0) ? depth - 1 : i - 1;
+            else
+                i = (i == depth - 1) ? 0 : i + 1;
+        }
+    }
+
+    // Deleting the best (or the worst) level shrinks the ring to the next slot that still has quantity,
+    // so the pointers never rest on an emptied slot. A side left with nothing goes back to nullptr (fresh book).
+    // Returns true if a pointer moved.
+    bool trim(bool is_bid) {
+        Order*& ini = is_bid ? ptr_bid_ini : ptr_offer_ini;
+        Order*& end = is_bid ? ptr_bid_end : ptr_offer_end;
+        if (ini == nullptr)
+            return false;
+        std::vector<Order>& side = is_bid ? bids : offers;
+        Order* first = &side[0];
+        Order* last = first + depth - 1;
+        Order* ini_before = ini;
+        Order* end_before = end;
+        while (ini->quantity == 0 && ini != end)
+            ini = (ini == last) ? first : ini + 1;
+        while (end->quantity == 0 && end != ini)
+            end = (end == first) ? last : end - 1;
+        if (ini->quantity == 0)
+            ini = end = nullptr;
+        return ini != ini_before || end != end_before;
+    }
+
 protected:
     Order* ptr_bid_ini;
     Order* ptr_bid_end;
     Order* ptr_offer_ini;
     Order* ptr_offer_end;
 
+// The goal of this method is to update the ini/end pointers based on the incoming price
+// (in case the price is not valid or out of range, do nothing). Returns the ring slot of the
+// price, -1 if it is discarded. With update_pointers false it only looks the slot up: neither
+// the pointers nor the slots change.
 int price_to_index(double price, bool is_bid, bool update_pointers=true)
 {
-    // the goal of this method is to update the ini/end pointers based on the incoming price
-    // (in case the price is not valid or out of range, do nothing)
-    if (is_bid)
+    return is_bid ? side_index<true>(price, update_pointers) : side_index<false>(price, update_pointers);
+}
+
+private:
+    // One implementation for both sides (IsBid picks the pointers and the array at compile time).
+    // The common case, a price inside ini..end, is straight-line code: the slot is ini + ticks,
+    // wrapped with a mask instead of a modulo. Everything that moves the pointers is out of line.
+    template <bool IsBid>
+    int side_index(double price, bool update_pointers)
+    {
+        const Order* ini = IsBid ? ptr_bid_ini : ptr_offer_ini;
+        const Order* end = IsBid ? ptr_bid_end : ptr_offer_end;
+        if (__builtin_expect(ini == nullptr, 0))
+            return side_index_slow<IsBid>(price, update_pointers);
+        bool inside = (price >= ini->price) & (price <= end->price);
+        if (__builtin_expect(!inside, 0))
+            return side_index_slow<IsBid>(price, update_pointers);
+        const Order* first = IsBid ? &bids[0] : &offers[0];
+        // price >= ini: truncating ticks + 0.5 rounds like lround, without the library call
+        int index = static_cast<int>(ini - first) + static_cast<int>((price - ini->price) * step_value + 0.5);
+        index -= depth & -static_cast<int>(index >= depth);
+        if (__builtin_expect(index >= depth, 0))
+            index %= depth;   // a ring wider than depth (only after a gap shift)
+        return index;
+    }
+
+    // Empty side, a price that grows the ring, a discarded price, or a shift of the whole ring
+    // (gaps up/down, full reset)
+    template <bool IsBid>
+    __attribute__((noinline, cold)) int side_index_slow(double price, bool update_pointers)
     {
-        double diff = 0;
-        if (ptr_bid_ini == nullptr)
+        Order*& ini = IsBid ? ptr_bid_ini : ptr_offer_ini;
+        Order*& end = IsBid ? ptr_bid_end : ptr_offer_end;
+        std::vector<Order>& side = IsBid ? bids : offers;
+        if (ini == nullptr)
         {
             if (update_pointers)
-                ptr_bid_ini = ptr_bid_end = &bids[0];
+                ini = end = &side[0];
             return 0;
         }
-        else if (price >= ptr_bid_ini->price && price <= ptr_bid_end->price)
+
+        double span = std::abs(std::max(end->price, price) - std::min(ini->price, price)) * step_value;
+        if (span < depth)
         {
-            // in this case, ini/end pointer stay the same
-            int qty_steps = (price - ptr_bid_ini->price) / step_value;
-            return (ptr_bid_ini + qty_steps) - &bids[0];
-        }
-        else if ( std::abs( std::max(ptr_bid_end->price, price) - std::min(ptr_bid_ini->price, price)) * step_value < depth){
             //In this scenario, we have available array items
             // Here we need to update ini/end pointer to their new postion.
             // Due to this condition, the end pointer will be at the new price
             // We must count if advancing the pointers, how many times we cycle. If we cycle more than once, all existing element values should be invalidated.
-            int qty_steps = round((price - ptr_bid_end->price) * step_value);
+            int qty_steps = round((price - end->price) * step_value);
             int cycles = abs(qty_steps) / depth;
-            if (price > ptr_bid_end->price && cycles >= 1) //means that all the existing values are invalidated. It is like having a buffer from scratch
+            if (price > end->price && cycles >= 1) //means that all the existing values are invalidated. It is like having a buffer from scratch
             {
                 if (update_pointers)
-                    ptr_bid_ini = ptr_bid_end = &bids[0];
+                    ini = end = &side[0];
                 return 0;
             }
-            else{
-                int current_ini_position = ptr_bid_ini - &bids[0];
-                int current_end_position = ptr_bid_end - &bids[0];
-                int new_ini_position = (( (qty_steps>=0 ? current_ini_position: current_end_position) + qty_steps) % depth + depth) % depth;
-                int new_end_position = (( (qty_steps>=0 ? current_end_position: current_ini_position) + qty_steps) % depth + depth) % depth;
-                
-                
-                if (price < ptr_bid_ini->price)
-                {
-                    if (update_pointers)
-                        ptr_bid_ini = &bids[0] + new_ini_position; // update to the new ini ptr
-                    return new_ini_position;
-                }
-                if (price > ptr_bid_end->price)
-                {
-                    if (update_pointers)
-                        ptr_bid_end = &bids[0] + new_end_position; // update end ptr
-                    return new_end_position;
-                }
+            int current_ini_position = ini - &side[0];
+            int current_end_position = end - &side[0];
+            int new_ini_position = (( (qty_steps>=0 ? current_ini_position: current_end_position) + qty_steps) % depth + depth) % depth;
+            int new_end_position = (( (qty_steps>=0 ? current_end_position: current_ini_position) + qty_steps) % depth + depth) % depth;
+            if (price < ini->price)
+            {
+                if (update_pointers)
+                    ini = &side[0] + new_ini_position; // update to the new ini ptr
+                return new_ini_position;
             }
+            if (update_pointers)
+                end = &side[0] + new_end_position; // update end ptr
+            return new_end_position;
         }
-        else if (price < ptr_bid_ini->price) //all array's item are used, hence discard
-            return -1; //discard the incoming price
-        else if ( std::abs( std::max(ptr_bid_end->price, price) - std::min(ptr_bid_ini->price, price)) * step_value > depth)
+        // all array's item are used: a price behind the worst level is discarded
+        if (IsBid ? price < ini->price : price > end->price)
+            return -1;
+        if (!(span > depth))
+            return -1;
+
+        //In this scenario, we want to shift the circular buffer
+        //here we need to update ini/end pointer to their new postion.
+        // Due to this condition, the end pointer will be at the new price
+        // We must count if advancing the pointers, how many times we cycle. If we cycle more than once, all existing element values should be invalidated.
+        int new_ini_position, new_end_position, skipped;
+        if (IsBid)
         {
-            //In this scenario, we want to shift the circular buffer
-            //here we need to update ini/end pointer to their new postion.
-            // Due to this condition, the end pointer will be at the new price
-            // We must count if advancing the pointers, how many times we cycle. If we cycle more than once, all existing element values should be invalidated.
-            int qty_steps = round((price - ptr_bid_end->price) * step_value);
+            int qty_steps = round((price - end->price) * step_value);
             int cycles = abs(qty_steps) / depth;
-            if (price > ptr_bid_end->price && cycles >= 1) //means that all the existing values are invalidated. It is like having a buffer from scratch
+            if (price > end->price && cycles >= 1) //means that all the existing values are invalidated. It is like having a buffer from scratch
             {
                 if (update_pointers)
-                    ptr_bid_ini = ptr_bid_end = &bids[0];
+                    ini = end = &side[0];
                 return 0;
             }
-            else{
-                int current_ini_position = ptr_bid_ini - &bids[0];
-                int current_end_position = ptr_bid_end - &bids[0];
-                int new_ini_position = (( (qty_steps>=0 ? current_ini_position: current_end_position) + qty_steps) % depth + depth) % depth;
-                int new_end_position = (( (qty_steps>=0 ? current_end_position: current_ini_position) + qty_steps) % depth + depth) % depth;
-                if (qty_steps>1)
-                {
-                    //since we are skipping, clean/reset intermediate elements 
-                    //this scenario happens when there is a gap up/down in the market
-                    for(int i=0; i<new_end_position; i++)
-                        bids[i].reset();
-                }
-                if (update_pointers)
-                {
-                    ptr_bid_ini = &bids[0] + new_ini_position; // update to the new ini ptr
-                    ptr_bid_end = &bids[0] + new_end_position; // update end ptr
-                }
-                if (price < ptr_bid_ini->price)                   
-                    return new_ini_position;
-                if (price > ptr_bid_end->price)
-                    return new_end_position;
-            }            
-        }        
-    }
-        else  /*HANDLE OFFER*/
+            int current_ini_position = ini - &side[0];
+            int current_end_position = end - &side[0];
+            new_ini_position = (( (qty_steps>=0 ? current_ini_position: current_end_position) + qty_steps) % depth + depth) % depth;
+            new_end_position = (( (qty_steps>=0 ? current_end_position: current_ini_position) + qty_steps) % depth + depth) % depth;
+            skipped = qty_steps;
+        }
+        else
         {
-            double diff = 0;
-            if (ptr_offer_ini == nullptr)
+            int qty_steps_ini = static_cast<int>(std::round((price - ini->price) * step_value));
+            int qty_steps_end = static_cast<int>(std::round((end->price - price) * step_value));
+            int cycles = abs(qty_steps_ini) / depth;
+            if (price < ini->price && cycles >= 1) //means that all the existing values are invalidated. It is like having a buffer from scratch
             {
                 if (update_pointers)
-                    ptr_offer_ini = ptr_offer_end = &offers[0];
+                    ini = end = &side[0];
                 return 0;
             }
-            else if (price >= ptr_offer_ini->price && price <= ptr_offer_end->price)
-            {
-                // In this scenario, we are adding in the middle of the buffer's range.
-                // in this case, ini/end pointer stay the same
-                int qty_steps = (price - ptr_offer_ini->price) / step_value;
-                return (ptr_offer_ini + qty_steps) - &offers[0];
-            }
-            else if ( std::abs( std::max(ptr_offer_end->price, price) - std::min(ptr_offer_ini->price, price)) * step_value < depth){
-                //In this scenario, we have available array items
-                //here we need to update ini/end pointer to their new postion.
-                // Due to this condition, the end pointer will be at the new price
-                // We must count if advancing the pointers, how many times we cycle. If we cycle more than once, all existing element values should be invalidated.
-                int qty_steps = round((price - ptr_offer_end->price) * step_value);
-                int cycles = abs(qty_steps) / depth;
-                if (price > ptr_offer_end->price && cycles >= 1) //means that all the existing values are invalidated. It is like having a buffer from scratch
-                {
-                    if (update_pointers)
-                        ptr_offer_ini = ptr_offer_end = &offers[0];
-                    return 0;
-                }
-                else{
-                    int current_ini_position = ptr_offer_ini - &offers[0];
-                    int current_end_position = ptr_offer_end - &offers[0];
-                    int new_ini_position = (( (qty_steps>=0 ? current_ini_position: current_end_position) + qty_steps) % depth + depth) % depth;
-                    int new_end_position = (( (qty_steps>=0 ? current_end_position: current_ini_position) + qty_steps) % depth + depth) % depth;
-                    
-                    
-                    if (price < ptr_offer_ini->price)
-                    {
-                        if (update_pointers)
-                            ptr_offer_ini = &offers[0] + new_ini_position; // update to the new ini ptr
-                        return new_ini_position;
-                    }
-                    if (price > ptr_offer_end->price)
-                    {
-                        if (update_pointers)
-                            ptr_offer_end = &offers[0] + new_end_position; // update end ptr
-                        return new_end_position;
-                    }
-                }
-            }
-            else if (price > ptr_offer_end->price) //all array's item are used, hence discard
-                return -1; //discard the incoming price
-            else if ( std::abs( std::max(ptr_offer_end->price, price) - std::min(ptr_offer_ini->price, price)) * step_value > depth)
-            {
-                //In this scenario, we want to shift the circular buffer
-                //here we need to update ini/end pointer to their new postion.
-                // Due to this condition, the end pointer will be at the new price
-                // We must count if advancing the pointers, how many times we cycle. If we cycle more than once, all existing element values should be invalidated.
-
-                int qty_steps_ini = static_cast<int>(std::round((price - ptr_offer_ini->price) * step_value));
-                int qty_steps_end = static_cast<int>(std::round((ptr_offer_end->price - price) * step_value));
-
-                int cycles = abs(qty_steps_ini) / depth;
-                if (price < ptr_offer_ini->price && cycles >= 1) //means that all the existing values are invalidated. It is like having a buffer from scratch
-                {
-                    ptr_offer_ini = ptr_offer_end = &offers[0];
-                    return 0;
-                }
-                else{
-                    int current_ini_position = ptr_offer_ini - &offers[0];
-                    int current_end_position = ptr_offer_end - &offers[0];                    
-                    int new_ini_position = (( current_ini_position + qty_steps_ini ) % depth + depth) % depth;
-                    int new_end_position = (( current_end_position + qty_steps_end-1 ) % depth + depth) % depth;
-
-                    if (qty_steps_ini>1)
-                    {
-                        //since we are skipping, clean/reset intermediate elements 
-                        //this scenario happens when there is a gap up/down in the market
-                        for(int i=0; i<new_end_position; i++)
-                            offers[i].reset();
-                    }
-                    if (update_pointers)
-                    {
-                        ptr_offer_ini = &offers[0] + new_ini_position; // update to the new ini ptr
-                        ptr_offer_end = &offers[0] + new_end_position; // update end ptr
-                    }
-                    if (price < ptr_offer_ini->price)                   
-                        return new_ini_position;
-                    if (price > ptr_offer_end->price)
-                        return new_end_position;
-
-                }            
-            }
+            int current_ini_position = ini - &side[0];
+            int current_end_position = end - &side[0];
+            new_ini_position = (( current_ini_position + qty_steps_ini ) % depth + depth) % depth;
+            new_end_position = (( current_end_position + qty_steps_end-1 ) % depth + depth) % depth;
+            skipped = qty_steps_ini;
         }
-    return -1;
-}
+        if (skipped>1 && update_pointers)
+        {
+            //since we are skipping, clean/reset intermediate elements
+            //this scenario happens when there is a gap up/down in the market
+            for(int i=0; i<new_end_position; i++)
+                side[i].reset();
+        }
+        if (update_pointers)
+        {
+            ini = &side[0] + new_ini_position; // update to the new ini ptr
+            end = &side[0] + new_end_position; // update end ptr
+        }
+        if (price < ini->price)
+            return new_ini_position;
+        if (price > end->price)
+            return new_end_position;
+        return -1;
+    }
 
 
 
 
 public:
-    LimitOrderBook(int precision, int depth) : precision(precision), depth(depth) {
+    LimitOrderBook(int precision, int depth, int top_levels = 5) : precision(precision), depth(depth), top_levels(top_levels) {
+        top_volume[0] = top_volume[1] = 0;
         bids.resize(depth);
         offers.resize(depth);
         ptr_bid_ini = ptr_offer_ini = nullptr;
@@ -242,52 +282,82 @@ public:
 
     virtual void add_order(const Order& order, bool is_bid) {        
         if (is_bid) {
+            Order* ini = ptr_bid_ini;
+            Order* end = ptr_bid_end;
             int index = price_to_index(order.price, true);
-            if (index > -1)
-                bids[index] = order;
+            set_level(index, order, true, ini, end);
         } else {
+            Order* ini = ptr_offer_ini;
+            Order* end = ptr_offer_end;
             int index = price_to_index(order.price, false);
-            if (index > -1)
-                offers[index] = order;
+            set_level(index, order, false, ini, end);
         }
     }
 
 
     void update_order(const Order& order, bool is_bid) {
+        Order* ini = is_bid ? ptr_bid_ini : ptr_offer_ini;
+        Order* end = is_bid ? ptr_bid_end : ptr_offer_end;
         int index = price_to_index(order.price, is_bid);
-        if (index == -1)
-            return; 
-        if (is_bid) {
-            bids[index] = order;
-        } else {
-            offers[index] = order;
-        }
+        set_level(index, order, is_bid, ini, end);
     }
 
     void delete_order(const Order& order, bool is_bid) {
+        Order* ini = is_bid ? ptr_bid_ini : ptr_offer_ini;
+        Order* end = is_bid ? ptr_bid_end : ptr_offer_end;
         int index = price_to_index(order.price, is_bid);
-        if (index == -1)
-            return; 
-        if (is_bid) {
-            bids[index] = Order();
-        } else {
-            offers[index] = Order();
+        set_level(index, Order(), is_bid, ini, end);
+        if (index > -1 && trim(is_bid))
+            top_volume[is_bid] = volume_near_touch(is_bid);
+    }
+
+    // Top-N market-by-price depth into a caller-owned snapshot, best level first, empty ticks skipped.
+    // Returns the number of levels written; never allocates.
+    template <int N>
+    int get_depth(bool is_bid, book_depth::DepthLevels<N>& out) const {
+        int n = 0;
+        for_each_slot(is_bid, [&](const Order& o, int) {
+            if (o.quantity > 0) {
+                out.price[n] = o.price;
+                out.quantity[n] = o.quantity;
+                n++;
+            }
+            return n < N;
+        });
+        out.count = n;
+        return n;
+    }
+
+    // Aggregated volume resting within "top_levels" ticks of the touch, maintained on every update
+    int64_t get_top_volume(bool is_bid) const {
+        return top_volume[is_bid];
+    }
+
+    // Empty book, storage kept (e.g. between backtest runs)
+    void clear() {
+        for (int i = 0; i < depth; i++) {
+            bids[i].reset();
+            offers[i].reset();
         }
+        ptr_bid_ini = ptr_offer_ini = nullptr;
+        ptr_bid_end = ptr_offer_end = nullptr;
+        top_volume[0] = top_volume[1] = 0;
     }
 
+    // An empty side returns Order() (quantity 0)
     virtual Order get_best_bid() {
-        return *ptr_bid_end;
+        return ptr_bid_end != nullptr ? *ptr_bid_end : Order();
     }
     Order get_lowest_bid() {
-        return *ptr_bid_ini;
+        return ptr_bid_ini != nullptr ? *ptr_bid_ini : Order();
     }
 
 
     Order get_best_offer() {
-        return *ptr_offer_ini;
+        return ptr_offer_ini != nullptr ? *ptr_offer_ini : Order();
     }
     Order get_highest_offer() {
-        return *ptr_offer_end;
+        return ptr_offer_end != nullptr ? *ptr_offer_end : Order();
     }
 
     void print_bids()
@@ -297,7 +367,7 @@ public:
             std::cout << i << "_" << bids[i].price << " * ";
         }
         std::cout << std::endl;
-        std::cout << "Bid ini/end=" << ptr_bid_ini->price << "/" << ptr_bid_end->price << std::endl;
+        std::cout << "Bid ini/end=" << get_lowest_bid().price << "/" << get_best_bid().price << std::endl;
     }
     void print_offers()
     {
@@ -306,7 +376,7 @@ public:
             std::cout << i << "_" << offers[i].price << " * ";
         }
         std::cout << std::endl;
-        std::cout << "Offer ini/end=" << ptr_offer_ini->price << "/" << ptr_offer_end->price << std::endl;
+        std::cout << "Offer ini/end=" << get_best_offer().price << "/" << get_highest_offer().price << std::endl;
     }
 
 };
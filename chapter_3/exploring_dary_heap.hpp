@@ -0,0 +1,88 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include "indexed_heap.hpp"
+
+namespace dary_heap
+{
+
+class Order {
+public:
+    int id;
+    double price;
+    int quantity;
+
+    Order() : id(0), price(0), quantity(0) {}
+    Order(int id, double price, int quantity) : id(id), price(price), quantity(quantity) {}
+    void reset()
+    {
+        id=0;
+        price=0.0;
+        quantity=0.0;
+    }
+};
+
+// One side of the book: indexed_heap::PriceLevelSide, the "best" heap gives O(1) best price,
+// the opposite "worst" heap finds the level to evict when the side is full
+using BookSide = indexed_heap::PriceLevelSide<Order>;
+
+class LimitOrderBook {
+private:
+    BookSide bids;
+    BookSide offers;
+    double step_value;
+
+    int64_t price_to_ticks(double price) const {
+        return std::llround(price * step_value);
+    }
+    static Order value_or_throw(const Order* order) {
+        if (order == nullptr) {
+            throw "Order book is empty";
+        }
+        return *order;
+    }
+
+public:
+    LimitOrderBook(int precision, int depth) : bids(depth, true), offers(depth, false) {
+        step_value = std::pow(10, precision);
+    }
+
+    void add_order(const Order& order, bool is_bid) {
+        (is_bid ? bids : offers).add(price_to_ticks(order.price), order);
+    }
+
+    void update_order(const Order& order, bool is_bid) {
+        (is_bid ? bids : offers).update(price_to_ticks(order.price), order);
+    }
+
+    void delete_order(const Order& order, bool is_bid) {
+        (is_bid ? bids : offers).erase(price_to_ticks(order.price));
+    }
+
+    Order get_best_bid() {
+        return value_or_throw(bids.best());
+    }
+    Order get_lowest_bid() {
+        return value_or_throw(bids.worst());
+    }
+
+    Order get_best_offer() {
+        return value_or_throw(offers.best());
+    }
+    Order get_highest_offer() {
+        return value_or_throw(offers.worst());
+    }
+
+    void print_bids() {
+        if (!bids.empty())
+            std::cout << "Bid best/lowest=" << get_best_bid().price << "/" << get_lowest_bid().price << std::endl;
+    }
+    void print_offers() {
+        if (!offers.empty())
+            std::cout << "Offer best/highest=" << get_best_offer().price << "/" << get_highest_offer().price << std::endl;
+    }
+};
+
+} // namespace dary_heap
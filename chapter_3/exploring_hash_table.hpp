@@ -1,6 +1,10 @@
 #pragma once
 #include <unordered_map>
 #include <list>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include "indexed_heap.hpp"
 
 namespace hash_table
 {
@@ -30,8 +34,8 @@ private:
     Order* lowestOffer;
     Order* highestOffer; 
 public:
-    LimitOrderBook() {}
-    LimitOrderBook(int precision, int depth): _depth(depth) {}
+    LimitOrderBook() : _depth(0), lowestBid(nullptr), highestBid(nullptr), lowestOffer(nullptr), highestOffer(nullptr) {}
+    LimitOrderBook(int precision, int depth): _depth(depth), lowestBid(nullptr), highestBid(nullptr), lowestOffer(nullptr), highestOffer(nullptr) {}
 
     void add_order(const Order& order, bool is_bid) {
         //add a new level in the order book
@@ -104,5 +108,72 @@ public:
     {
     }
 
+};
+
+// Same idea, but the price levels live in a flat open-addressing table keyed by integer ticks
+// (no hashing of doubles, no node allocation per level). Lowest/highest are tracked by a
+// min-heap and a max-heap of level slots, so they stay correct after any delete in O(log n)
+// instead of having to traverse the map (indexed_heap::PriceLevelSide, as the d-ary heap book).
+using FlatBookSide = indexed_heap::PriceLevelSide<Order>;
+
+class FlatLimitOrderBook {
+private:
+    FlatBookSide book_bids;
+    FlatBookSide book_offers;
+    double step_value;
+
+    int64_t price_to_ticks(double price) const {
+        return std::llround(price * step_value);
+    }
+    static Order value_or_empty(const Order* order) {
+        return order != nullptr ? *order : Order();
+    }
+
+public:
+    FlatLimitOrderBook(int precision, int depth) : book_bids(depth, true), book_offers(depth, false) {
+        step_value = std::pow(10, precision);
+    }
+
+    void add_order(const Order& order, bool is_bid) {
+        if (is_bid)
+            book_bids.add(price_to_ticks(order.price), order);
+        else
+            book_offers.add(price_to_ticks(order.price), order);
+    }
+
+    void delete_order(const Order& order, bool is_bid) {
+        if (is_bid)
+            book_bids.erase(price_to_ticks(order.price));
+        else
+            book_offers.erase(price_to_ticks(order.price));
+    }
+    void update_order(const Order& order, bool is_bid){
+        // same price => overwritten in place
+        add_order(order, is_bid);
+    }
+
+
+    Order get_best_bid() {
+        return value_or_empty(book_bids.best());
+    }
+    Order get_lowest_bid() {
+        return value_or_empty(book_bids.worst());
+    }
+
+
+    Order get_best_offer() {
+        return value_or_empty(book_offers.best());
+    }
+    Order get_highest_offer() {
+        return value_or_empty(book_offers.worst());
+    }
+
+    void print_bids()
+    {
+    }
+    void print_offers()
+    {
+    }
+
 };
 }
\ No newline at end of file
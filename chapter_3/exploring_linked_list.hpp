@@ -1,5 +1,6 @@
 #pragma once
 #include <iostream>
+#include <vector>
 
 namespace linked_list {
 class Order {
@@ -25,31 +26,76 @@ public:
 };
 
 
+// Fixed-capacity pool of nodes for the book.
+// All nodes live in one contiguous block allocated up front, and released nodes
+// are chained through their own "next" pointer (freelist), so add/delete never
+// touch the global allocator and recently freed (cache-hot) nodes are reused first.
+class OrderArena {
+private:
+    std::vector<Order> nodes;
+    Order* free_list;
+
+public:
+    OrderArena(int capacity) : free_list(nullptr) {
+        nodes.reserve(capacity);
+        for (int i = 0; i < capacity; i++)
+            nodes.emplace_back(0.0);
+        for (int i = capacity - 1; i >= 0; i--) {
+            nodes[i].next = free_list;
+            free_list = &nodes[i];
+        }
+    }
+    // nodes point into each other, so the arena can't be copied around
+    OrderArena(const OrderArena&) = delete;
+    OrderArena& operator=(const OrderArena&) = delete;
+
+    Order* allocate(const Order& order) {
+        Order* node = free_list;
+        if (node == nullptr)
+            return nullptr; // arena exhausted
+        free_list = node->next;
+        node->id = order.id;
+        node->price = order.price;
+        node->next = nullptr;
+        return node;
+    }
+    void release(Order* node) {
+        node->next = free_list;
+        free_list = node;
+    }
+};
+
+
 class LimitOrderBook {
 public:
     Order* head;
     Order* tail;
     int depth;
     int size;
+    OrderArena arena; // the book never holds more than "depth" nodes
 
-    LimitOrderBook(int presicion, int depth) : head(nullptr), tail(nullptr), depth(depth), size(0) {}
-    LimitOrderBook(int depth) : head(nullptr), tail(nullptr), depth(depth), size(0) {}
+    LimitOrderBook(int presicion, int depth) : head(nullptr), tail(nullptr), depth(depth), size(0), arena(depth) {}
+    LimitOrderBook(int depth) : head(nullptr), tail(nullptr), depth(depth), size(0), arena(depth) {}
   
     void add_order(const Order& order, bool is_bid) {
-        Order* newNode = new Order(order);
         if (size == depth) {
-            if (order.price <= head->price) {
+            if (head == NULL || order.price <= head->price) {
                 // discard
-                delete newNode;
                 return;
             } else {
-                // remove the head (lowest value)
+                // remove the head (lowest value) before taking a node, so the arena
+                // only needs "depth" slots
                 Order* temp = head;
                 head = head->next;
-                delete temp;
+                if (head == NULL)
+                    tail = NULL;
+                arena.release(temp);
                 size--;
             }
         }
+        Order* newNode = arena.allocate(order);
+        if (newNode == NULL)
+            return;
 
         if (head == NULL || head->price >= order.price) {
             newNode->next = head;
@@ -76,7 +122,9 @@ public:
         if (head->price == order.price) {
             Order* temp = head;
             head = head->next;
-            delete temp;
+            if (head == NULL)
+                tail = NULL;
+            arena.release(temp);
             size--;
             return;
         }
@@ -87,7 +135,9 @@ public:
         if (current->next != NULL) {
             Order* temp = current->next;
             current->next = current->next->next;
-            delete temp;
+            if (temp == tail)
+                tail = current; // released nodes get reused, tail can't keep pointing there
+            arena.release(temp);
             size--;
         }
     }
@@ -0,0 +1,234 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+namespace skip_list
+{
+
+class Order {
+public:
+    int id;
+    double price;
+    int quantity;
+
+    Order() : id(0), price(0), quantity(0) {}
+    Order(int id, double price, int quantity) : id(id), price(price), quantity(quantity) {}
+    void reset()
+    {
+        id=0;
+        price=0.0;
+        quantity=0.0;
+    }
+};
+
+// With p=1/4 per level, 8 levels comfortably cover books of ~64k price levels
+const int MAX_LEVEL = 8;
+const int32_t NIL = -1;
+
+// One side of the book, kept as a skip list sorted best price first.
+// Nodes come from a fixed pool (index 0 is the head sentinel) and link to each other
+// by 32-bit index, so a whole node (key + every forward link + the order) fits in a
+// single cache line: walking the list touches exactly one line per visited node.
+class PriceLevels {
+private:
+    struct alignas(64) Node {
+        int64_t key;                // price in ticks, negated for bids so best is always first
+        double price;
+        int32_t forward[MAX_LEVEL];
+        int32_t id;
+        int32_t quantity;
+        int32_t level;
+    };
+
+    std::vector<Node> pool;
+    int32_t free_list;  // released nodes, chained through forward[0]
+    int32_t tail;       // worst price level, evicted when the book is full
+    int depth;
+    int size;
+    int level;          // highest level currently in use
+    uint32_t seed;
+    int32_t update[MAX_LEVEL];
+
+    int random_level() {
+        // xorshift32, then count pairs of zero bits => geometric distribution with p=1/4
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        int lvl = 1 + __builtin_ctz(seed | (1u << (2 * (MAX_LEVEL - 1)))) / 2;
+        return lvl;
+    }
+
+    // Fills "update" with the last node before "key" on every level and returns the first node >= key
+    int32_t find(int64_t key) {
+        int32_t x = 0;
+        for (int i = level - 1; i >= 0; i--) {
+            int32_t next = pool[x].forward[i];
+            while (next != NIL && pool[next].key < key) {
+                x = next;
+                next = pool[x].forward[i];
+            }
+            update[i] = x;
+        }
+        return pool[x].forward[0];
+    }
+
+    void unlink(int32_t node) {
+        for (int i = 0; i < pool[node].level; i++) {
+            if (pool[update[i]].forward[i] == node)
+                pool[update[i]].forward[i] = pool[node].forward[i];
+        }
+        while (level > 1 && pool[0].forward[level - 1] == NIL)
+            level--;
+        if (node == tail)
+            tail = (update[0] == 0) ? NIL : update[0];
+        pool[node].forward[0] = free_list;
+        free_list = node;
+        size--;
+    }
+
+    static Order to_order(const Node& node) {
+        return Order(node.id, node.price, node.quantity);
+    }
+
+public:
+    PriceLevels(int depth) : pool(depth + 1), free_list(NIL), tail(NIL), depth(depth), size(0), level(1), seed(2463534242u) {
+        for (int i = 0; i < MAX_LEVEL; i++)
+            pool[0].forward[i] = NIL;
+        pool[0].level = MAX_LEVEL;
+        for (int32_t i = depth; i >= 1; i--) {
+            pool[i].forward[0] = free_list;
+            free_list = i;
+        }
+    }
+
+    // Adds (or overwrites) the level at "key". Returns false when the price falls outside the depth.
+    bool insert(int64_t key, const Order& order) {
+        int32_t x = find(key);
+        if (x != NIL && pool[x].key == key) {
+            pool[x].id = order.id;
+            pool[x].price = order.price;
+            pool[x].quantity = order.quantity;
+            return true;
+        }
+        if (size == depth) {
+            if (tail == NIL || key >= pool[tail].key)
+                return false; // discard, worse than everything in the book
+            // drop the worst level and search again, since the predecessors may have changed
+            find(pool[tail].key);
+            unlink(tail);
+            x = find(key);
+        }
+
+        int32_t node = free_list;
+        free_list = pool[node].forward[0];
+        int lvl = random_level();
+        if (lvl > level) {
+            for (int i = level; i < lvl; i++)
+                update[i] = 0;
+            level = lvl;
+        }
+        Node& n = pool[node];
+        n.key = key;
+        n.price = order.price;
+        n.id = order.id;
+        n.quantity = order.quantity;
+        n.level = lvl;
+        for (int i = 0; i < lvl; i++) {
+            n.forward[i] = pool[update[i]].forward[i];
+            pool[update[i]].forward[i] = node;
+        }
+        if (n.forward[0] == NIL)
+            tail = node;
+        size++;
+        return true;
+    }
+
+    void erase(int64_t key) {
+        int32_t x = find(key);
+        if (x != NIL && pool[x].key == key)
+            unlink(x);
+    }
+
+    bool empty() const { return size == 0; }
+    int count() const { return size; }
+
+    Order best() const {
+        if (size == 0) {
+            throw "Order book is empty";
+        }
+        return to_order(pool[pool[0].forward[0]]);
+    }
+    Order worst() const {
+        if (size == 0) {
+            throw "Order book is empty";
+        }
+        return to_order(pool[tail]);
+    }
+
+    void print() const {
+        for (int32_t x = pool[0].forward[0]; x != NIL; x = pool[x].forward[0]) {
+            std::cout << pool[x].price << " ";
+        }
+        std::cout << std::endl;
+    }
+};
+
+
+class LimitOrderBook {
+private:
+    PriceLevels bids;
+    PriceLevels offers;
+    double step_value;
+
+    int64_t price_to_ticks(double price) const {
+        return std::llround(price * step_value);
+    }
+
+public:
+    LimitOrderBook(int precision, int depth) : bids(depth), offers(depth) {
+        step_value = std::pow(10, precision);
+    }
+
+    void add_order(const Order& order, bool is_bid) {
+        if (is_bid)
+            bids.insert(-price_to_ticks(order.price), order);
+        else
+            offers.insert(price_to_ticks(order.price), order);
+    }
+
+    void update_order(const Order& order, bool is_bid) {
+        add_order(order, is_bid);
+    }
+
+    void delete_order(const Order& order, bool is_bid) {
+        if (is_bid)
+            bids.erase(-price_to_ticks(order.price));
+        else
+            offers.erase(price_to_ticks(order.price));
+    }
+
+    Order get_best_bid() {
+        return bids.best();
+    }
+    Order get_lowest_bid() {
+        return bids.worst();
+    }
+
+    Order get_best_offer() {
+        return offers.best();
+    }
+    Order get_highest_offer() {
+        return offers.worst();
+    }
+
+    void print_bids() {
+        bids.print();
+    }
+    void print_offers() {
+        offers.print();
+    }
+};
+
+} // namespace skip_list
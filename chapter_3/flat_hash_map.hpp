@@ -0,0 +1,114 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace flat_hash
+{
+
+// Open-addressing hash map for integer keys (order ids, price ticks...).
+// - One flat array of slots sized once at construction (power of two), no allocation per insert
+// - Linear probing: a collision usually lands on the same or the next cache line
+// - Backward-shift deletion, so there are no tombstones and lookups don't degrade over the day
+// Capacity is fixed: insert() returns nullptr when the table is full, the caller decides what to drop.
+template <class Key, class Value>
+class FlatHashMap {
+private:
+    struct Slot {
+        Key key;
+        Value value;
+        bool used;
+    };
+    std::vector<Slot> slots;
+    size_t mask;
+    int shift;
+    size_t count;
+    size_t max_count;
+
+    size_t home(Key key) const {
+        // Fibonacci hashing (keep the top bits), spreads consecutive ids/ticks over the whole table
+        return static_cast<size_t>((static_cast<uint64_t>(key) * 11400714819323198485ull) >> shift);
+    }
+
+public:
+    // "capacity" is the number of keys we expect to hold; the table keeps itself at most 50% full
+    FlatHashMap(size_t capacity) : count(0), max_count(capacity) {
+        size_t size = 16;
+        shift = 60;
+        while (size < capacity * 2) {
+            size <<= 1;
+            shift--;
+        }
+        slots.resize(size);
+        mask = size - 1;
+        for (auto& slot : slots)
+            slot.used = false;
+    }
+
+    Value* find(Key key) {
+        for (size_t i = home(key); slots[i].used; i = (i + 1) & mask) {
+            if (slots[i].key == key)
+                return &slots[i].value;
+        }
+        return nullptr;
+    }
+
+    // Pulls the home slot of "key" into cache ahead of a find(), for batched lookups
+    void prefetch(Key key) const {
+        __builtin_prefetch(&slots[home(key)], 0, 3);
+    }
+
+    // Inserts or overwrites. Returns nullptr when the table is full.
+    Value* insert(Key key, const Value& value) {
+        size_t i = home(key);
+        for (; slots[i].used; i = (i + 1) & mask) {
+            if (slots[i].key == key) {
+                slots[i].value = value;
+                return &slots[i].value;
+            }
+        }
+        if (count == max_count)
+            return nullptr;
+        slots[i].key = key;
+        slots[i].value = value;
+        slots[i].used = true;
+        count++;
+        return &slots[i].value;
+    }
+
+    bool erase(Key key) {
+        size_t i = home(key);
+        for (; slots[i].used; i = (i + 1) & mask) {
+            if (slots[i].key == key)
+                break;
+        }
+        if (!slots[i].used)
+            return false;
+
+        // shift back the following entries of the probe sequence into the hole
+        size_t hole = i;
+        for (size_t j = (hole + 1) & mask; slots[j].used; j = (j + 1) & mask) {
+            size_t h = home(slots[j].key);
+            // move slots[j] only if its home is not in the (hole, j] range
+            bool movable = (hole <= j) ? (h <= hole || h > j) : (h <= hole && h > j);
+            if (movable) {
+                slots[hole] = slots[j];
+                hole = j;
+            }
+        }
+        slots[hole].used = false;
+        count--;
+        return true;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    void clear() {
+        for (auto& slot : slots)
+            slot.used = false;
+        count = 0;
+    }
+};
+
+} // namespace flat_hash
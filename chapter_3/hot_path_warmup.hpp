@@ -0,0 +1,237 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "exploring_circular_array.hpp"
+#include "strategy.hpp"
+#include "backtester.hpp"
+
+// Keeping the tick-to-trade path hot while the market is quiet. The first event after an idle
+// gap otherwise finds the parser, book, strategy, risk and encoder code and data evicted by
+// whatever ran meanwhile, and the branch predictors trained on something else. During the gap
+// TradingLoop drives synthetic events through the same functions (same code, same book, same
+// branches) and drops the result at the last step, the send.
+namespace warmup
+{
+
+using circular_array::Order;
+using circular_array::LimitOrderBook;
+
+// Feed wire format: one market-by-price update or trade, 24 bytes little endian
+struct FeedMessage {
+    int64_t timestamp;
+    int64_t price_ticks;
+    int32_t quantity;
+    uint8_t type;       // backtest::EventType
+    uint8_t side;       // 1 = bid (book) / buyer (trade)
+    uint8_t flags;
+    uint8_t reserved;
+};
+
+// Order entry wire format: a new order, 24 bytes little endian
+struct OrderMessage {
+    uint16_t msg_type;  // 'D', new order single
+    uint8_t side;       // 1 = buy
+    uint8_t flags;
+    int32_t id;
+    int64_t price_ticks;
+    int32_t quantity;
+    int32_t reserved;
+};
+
+const uint8_t FLAG_WARMUP = 1;   // synthetic message (warm-up pass), never sent
+
+// false for a truncated or malformed message
+inline bool parse(const char* bytes, size_t size, double step_value, backtest::MarketEvent& out) {
+    if (size < sizeof(FeedMessage))
+        return false;
+    FeedMessage m;
+    std::memcpy(&m, bytes, sizeof(m));
+    if (m.type > static_cast<uint8_t>(backtest::EventType::TRADE) || m.side > 1 || m.quantity < 0)
+        return false;
+    out = backtest::MarketEvent{m.timestamp, m.price_ticks / step_value, m.quantity, static_cast<backtest::EventType>(m.type), m.side == 1};
+    return true;
+}
+
+inline size_t encode(const Order& order, bool is_bid, double step_value, uint8_t flags, char* out) {
+    OrderMessage m{'D', static_cast<uint8_t>(is_bid), flags, order.id, std::llround(order.price * step_value), order.quantity, 0};
+    std::memcpy(out, &m, sizeof(m));
+    return sizeof(m);
+}
+
+// Where encoded orders go (the venue session)
+class OrderSink {
+public:
+    virtual ~OrderSink() = default;
+    virtual void send(const char* bytes, size_t size) = 0;
+};
+
+// Pre-trade checks of every order before it is encoded
+struct PreTradeLimits {
+    int max_quantity = 1000;
+    double price_band = 0.05;   // furthest from the reference a limit price may be, as a fraction of it
+};
+
+// Feed message -> parser -> book -> strategy -> pre-trade risk -> encoder -> sink, for one
+// instrument. In warm-up mode everything runs but the sink isn't called.
+class HotPath : public strategy::OrderGateway {
+private:
+    LimitOrderBook& book;
+    OrderSink& sink;
+    PreTradeLimits limits;
+    double step_value;
+    strategy::StrategyModule strategy;
+    bool warming = false;
+    char wire[sizeof(OrderMessage)];
+    uint64_t sent = 0;
+    uint64_t rejected = 0;
+    uint64_t suppressed = 0;
+    double last_trade = 0;     // 0 until the first print
+
+    // The band is checked against the mid, or the last print when one side of the book is empty;
+    // with neither there is nothing to check the price against and the order is rejected.
+    bool risk_check(const Order& order) {
+        Order bid = book.get_best_bid();
+        Order offer = book.get_best_offer();
+        if (order.quantity <= 0 || order.quantity > limits.max_quantity || order.price <= 0)
+            return false;
+        double reference = bid.quantity > 0 && offer.quantity > 0 ? (bid.price + offer.price) * 0.5 : last_trade;
+        if (reference <= 0)
+            return false;
+        return std::abs(order.price - reference) <= limits.price_band * reference;
+    }
+
+public:
+    HotPath(LimitOrderBook& book, OrderSink& sink, const strategy::StrategyParams& params = strategy::StrategyParams(),
+            const PreTradeLimits& limits = PreTradeLimits(), int precision = 2)
+        : book(book), sink(sink), limits(limits), step_value(std::pow(10, precision)), strategy(book, *this, params) {}
+
+    // Strategy orders (OrderGateway)
+    void submit(const Order& order, bool is_bid) override {
+        if (!risk_check(order)) {
+            rejected += !warming;
+            return;
+        }
+        size_t size = encode(order, is_bid, step_value, warming ? FLAG_WARMUP : 0, wire);
+        if (warming) {
+            suppressed++;
+            return;
+        }
+        sink.send(wire, size);
+        sent++;
+    }
+
+    // One feed message through the whole path; false if it didn't parse. warmup_mode: run
+    // everything, send nothing.
+    bool on_message(const char* bytes, size_t size, bool warmup_mode = false) {
+        backtest::MarketEvent e;
+        if (!parse(bytes, size, step_value, e))
+            return false;
+        warming = warmup_mode;
+        if (e.type == backtest::EventType::BOOK) {
+            if (e.quantity == 0)
+                book.delete_order(Order(0, e.price, 0), e.is_bid);
+            else
+                book.update_order(Order(0, e.price, e.quantity), e.is_bid);
+            strategy.on_book_update();
+        }
+        else if (!warmup_mode && e.quantity > 0) {
+            last_trade = e.price;
+        }
+        warming = false;
+        return true;
+    }
+
+    // One warm-up pass: the best bid (or offer) restated through parser, book and strategy (the
+    // book doesn't change), then an order at the touch through risk and the encoder. False
+    // with an empty book, nothing to restate.
+    bool warm(int64_t now) {
+        Order level = book.get_best_bid();
+        bool is_bid = level.quantity > 0;
+        if (!is_bid)
+            level = book.get_best_offer();
+        if (level.quantity == 0)
+            return false;
+        FeedMessage m{now, std::llround(level.price * step_value), level.quantity,
+                      static_cast<uint8_t>(backtest::EventType::BOOK), static_cast<uint8_t>(is_bid), FLAG_WARMUP, 0};
+        char bytes[sizeof(FeedMessage)];
+        std::memcpy(bytes, &m, sizeof(m));
+        on_message(bytes, sizeof(bytes), true);
+        warming = true;
+        submit(Order(0, level.price, 1), is_bid);
+        warming = false;
+        return true;
+    }
+
+    uint64_t orders_sent() const { return sent; }
+    uint64_t orders_rejected() const { return rejected; }
+    uint64_t warmup_orders() const { return suppressed; }
+    strategy::StrategyModule& module() { return strategy; }
+};
+
+struct LatencyStats {
+    uint64_t count = 0;
+    double total_ns = 0;
+    double max_ns = 0;
+
+    void add(double ns) {
+        count++;
+        total_ns += ns;
+        max_ns = std::max(max_ns, ns);
+    }
+    double mean() const { return count > 0 ? total_ns / count : 0.0; }
+};
+
+struct WarmupConfig {
+    bool enabled = true;
+    int64_t idle_threshold = 100000;    // ns without a real event: the next one counts as "first after idle"
+    int64_t warmup_interval = 20000;    // ns between warm-up passes while idle
+};
+
+// The trading loop's two calls: on_message for every real feed message, on_idle whenever a
+// poll found nothing. Times every real message and keeps the first-after-idle ones apart.
+class TradingLoop {
+private:
+    HotPath& path;
+    WarmupConfig config;
+    int64_t last_event = 0;
+    int64_t last_warmup = 0;
+    uint64_t passes = 0;
+    LatencyStats first_after_idle;
+    LatencyStats steady;
+
+public:
+    TradingLoop(HotPath& path, const WarmupConfig& config = WarmupConfig()) : path(path), config(config) {}
+
+    // now: event time in ns (the caller's clock)
+    void on_message(const char* bytes, size_t size, int64_t now) {
+        auto start = std::chrono::steady_clock::now();
+        path.on_message(bytes, size);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (now - last_event >= config.idle_threshold)
+            first_after_idle.add(ns);
+        else
+            steady.add(ns);
+        last_event = now;
+    }
+
+    // Returns true if it ran a warm-up pass
+    bool on_idle(int64_t now) {
+        if (!config.enabled || now - last_warmup < config.warmup_interval)
+            return false;
+        last_warmup = now;
+        if (!path.warm(now))
+            return false;
+        passes++;
+        return true;
+    }
+
+    const LatencyStats& first_after_idle_latency() const { return first_after_idle; }
+    const LatencyStats& steady_latency() const { return steady; }
+    uint64_t warmup_passes() const { return passes; }
+};
+
+} // namespace warmup
@@ -0,0 +1,178 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "flat_hash_map.hpp"
+
+namespace indexed_heap
+{
+
+const int ARITY = 4;    // 4 children = 4 x int32 slots, siblings share a cache line
+const int32_t NIL = -1;
+
+// 4-ary heap of level slots. Every level stores its own heap position (heap_pos[which]),
+// so a level can be removed or re-positioned in place in O(log n) without searching the heap.
+// Level needs an integer "ticks" key and an "int32_t heap_pos[]" array.
+// The heap refers to its owner's level vector, so it can't be copied or moved: a copy would
+// keep re-positioning the source's levels. Owners are not copyable / movable either.
+template <class Level>
+class IndexedHeap {
+private:
+    std::vector<int32_t> heap;
+    std::vector<Level>& levels;
+    int which;          // which heap_pos entry this heap owns
+    bool max_first;     // max-heap (best bid / worst offer) or min-heap
+    int size;
+
+    bool before(int32_t a, int32_t b) const {
+        return max_first ? levels[a].ticks > levels[b].ticks : levels[a].ticks < levels[b].ticks;
+    }
+    void place(int pos, int32_t level) {
+        heap[pos] = level;
+        levels[level].heap_pos[which] = pos;
+    }
+    void sift_up(int pos) {
+        int32_t level = heap[pos];
+        while (pos > 0) {
+            int parent = (pos - 1) / ARITY;
+            if (!before(level, heap[parent]))
+                break;
+            place(pos, heap[parent]);
+            pos = parent;
+        }
+        place(pos, level);
+    }
+    void sift_down(int pos) {
+        int32_t level = heap[pos];
+        while (true) {
+            int first = pos * ARITY + 1;
+            if (first >= size)
+                break;
+            int last = first + ARITY < size ? first + ARITY : size;
+            int best = first;
+            for (int c = first + 1; c < last; c++) {
+                if (before(heap[c], heap[best]))
+                    best = c;
+            }
+            if (!before(heap[best], level))
+                break;
+            place(pos, heap[best]);
+            pos = best;
+        }
+        place(pos, level);
+    }
+
+public:
+    IndexedHeap(std::vector<Level>& levels, int capacity, int which, bool max_first)
+        : heap(capacity), levels(levels), which(which), max_first(max_first), size(0) {}
+    IndexedHeap(const IndexedHeap&) = delete;
+    IndexedHeap& operator=(const IndexedHeap&) = delete;
+
+    void push(int32_t level) {
+        heap[size] = level;
+        levels[level].heap_pos[which] = size;
+        size++;
+        sift_up(size - 1);
+    }
+
+    void remove(int32_t level) {
+        int pos = levels[level].heap_pos[which];
+        size--;
+        if (pos != size) {
+            // move the last element into the hole and fix it up in whichever direction it needs
+            place(pos, heap[size]);
+            if (pos > 0 && before(heap[pos], heap[(pos - 1) / ARITY]))
+                sift_up(pos);
+            else
+                sift_down(pos);
+        }
+        levels[level].heap_pos[which] = NIL;
+    }
+
+    int32_t top() const { return heap[0]; }
+    bool empty() const { return size == 0; }
+    int count() const { return size; }
+};
+
+template <class Payload>
+struct PriceLevel {
+    int64_t ticks;
+    Payload order;
+    int32_t heap_pos[2];    // position of this level in each of the two heaps of its side
+};
+
+// One side of a price level book: levels in a slot pool, price (ticks) -> slot through a flat
+// hash map, a "best" heap for O(1) best price and the opposite "worst" heap to find the level
+// to evict when the side is full. Every operation is O(1) or O(log depth), nothing allocates.
+template <class Payload>
+class PriceLevelSide {
+private:
+    std::vector<PriceLevel<Payload>> levels;
+    IndexedHeap<PriceLevel<Payload>> best_heap;
+    IndexedHeap<PriceLevel<Payload>> worst_heap;
+    flat_hash::FlatHashMap<int64_t, int32_t> by_ticks;
+    std::vector<int32_t> free_levels;
+    int depth;
+    bool is_bid;
+
+    void remove_level(int32_t level) {
+        best_heap.remove(level);
+        worst_heap.remove(level);
+        by_ticks.erase(levels[level].ticks);
+        free_levels.push_back(level);
+    }
+
+public:
+    PriceLevelSide(int depth, bool is_bid)
+        : levels(depth), best_heap(levels, depth, 0, is_bid), worst_heap(levels, depth, 1, !is_bid),
+          by_ticks(depth), depth(depth), is_bid(is_bid) {
+        free_levels.reserve(depth);
+        for (int32_t i = depth - 1; i >= 0; i--)
+            free_levels.push_back(i);
+    }
+
+    // A known price is overwritten in place (the heaps don't move). On a full side a price worse
+    // than the worst level is discarded, otherwise the worst level is evicted.
+    void add(int64_t ticks, const Payload& order) {
+        int32_t* found = by_ticks.find(ticks);
+        if (found != nullptr) {
+            levels[*found].order = order;
+            return;
+        }
+        if (best_heap.count() == depth) {
+            int32_t w = worst_heap.top();
+            if (is_bid ? ticks <= levels[w].ticks : ticks >= levels[w].ticks)
+                return;
+            remove_level(w);
+        }
+        int32_t level = free_levels.back();
+        free_levels.pop_back();
+        levels[level].ticks = ticks;
+        levels[level].order = order;
+        by_ticks.insert(ticks, level);
+        best_heap.push(level);
+        worst_heap.push(level);
+    }
+
+    // Change at an existing level only: O(1), the price (heap key) doesn't change
+    bool update(int64_t ticks, const Payload& order) {
+        int32_t* found = by_ticks.find(ticks);
+        if (found == nullptr)
+            return false;
+        levels[*found].order = order;
+        return true;
+    }
+
+    void erase(int64_t ticks) {
+        int32_t* found = by_ticks.find(ticks);
+        if (found != nullptr)
+            remove_level(*found);
+    }
+
+    bool empty() const { return best_heap.empty(); }
+    int count() const { return best_heap.count(); }
+    // nullptr when the side is empty
+    const Payload* best() const { return best_heap.empty() ? nullptr : &levels[best_heap.top()].order; }
+    const Payload* worst() const { return worst_heap.empty() ? nullptr : &levels[worst_heap.top()].order; }
+};
+
+} // namespace indexed_heap
@@ -6,10 +6,50 @@
 #if RUN_UNIT_TEST == 1
 #include <iostream>
 #include "tests/exploring_circular_array_test.hpp"
+#include "tests/price_level_books_test.hpp"
+#include "tests/matching_engine_test.hpp"
+#include "tests/oms_execution_pipeline_test.hpp"
+#include "tests/position_engine_test.hpp"
+#include "tests/risk_kernel_test.hpp"
+#include "tests/risk_rules_test.hpp"
+#include "tests/tca_test.hpp"
+#include "tests/venue_metrics_test.hpp"
+#include "tests/feature_builder_test.hpp"
+#include "tests/mlp_inference_test.hpp"
+#include "tests/replay_buffer_test.hpp"
+#include "tests/vector_env_test.hpp"
+#include "tests/ohlcv_store_test.hpp"
+#include "tests/indicators_test.hpp"
+#include "tests/portfolio_book_test.hpp"
+#include "tests/backtester_test.hpp"
+#include "tests/parameter_sweep_test.hpp"
+#include "tests/thread_placement_test.hpp"
+#include "tests/hot_path_warmup_test.hpp"
+#include "tests/circular_array_differential_test.hpp"
 
 int main() {
 
     run_all_tests();
+    run_price_level_books_tests();
+    run_matching_engine_tests();
+    run_oms_execution_pipeline_tests();
+    run_position_engine_tests();
+    run_risk_kernel_tests();
+    run_risk_rules_tests();
+    run_tca_tests();
+    run_venue_metrics_tests();
+    run_feature_builder_tests();
+    run_mlp_inference_tests();
+    run_replay_buffer_tests();
+    run_vector_env_tests();
+    run_ohlcv_store_tests();
+    run_indicators_tests();
+    run_portfolio_book_tests();
+    run_backtester_tests();
+    run_parameter_sweep_tests();
+    run_thread_placement_tests();
+    run_hot_path_warmup_tests();
+    run_circular_array_differential_tests();
 
     std::cout << "Done..." << std::endl;
     return 0;
@@ -78,27 +118,72 @@ int main(){
 #include <iostream>
 #include <iomanip>
 #include <random>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <mutex>
+#include <queue>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
 #include <benchmark/benchmark.h>
 #include "exploring_circular_array.hpp"
 #include "exploring_hash_table.hpp"
 #include "exploring_linked_list.hpp"
 #include "exploring_queue.hpp"
 #include "exploring_binary_tree.hpp"
+#include "exploring_skip_list.hpp"
+#include "exploring_bplus_tree.hpp"
+#include "exploring_dary_heap.hpp"
+#include "matching_engine.hpp"
+#include "oms_execution_pipeline.hpp"
+#include "position_engine.hpp"
+#include "risk_kernel.hpp"
+#include "risk_rules.hpp"
+#include "tca.hpp"
+#include "../chapter_4/venue_metrics.hpp"
+#include "../chapter_4/feature_builder.hpp"
+#include "../chapter_4/mlp_inference.hpp"
+#include "../chapter_4/replay_buffer.hpp"
+#include "../chapter_4/vector_env.hpp"
+#include "../chapter_4/ohlcv_store.hpp"
+#include "../chapter_4/indicators.hpp"
+#include "../chapter_4/portfolio_book.hpp"
+#include "backtester.hpp"
+#include "parameter_sweep.hpp"
+#include "thread_placement.hpp"
+#include "hot_path_warmup.hpp"
+#include "perf_counters.hpp"
 #include "synchronized_limitorderbook.hpp"
 #include "smartblocking_limitorderbook.hpp"
 #include "lockfree_limitorderbook.hpp"
 
 const int _LOB_DEPTH = 50;
 
-static void AddOrder_CircularArray(benchmark::State& state) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // Set the CPU affinity to CPU 0
+// Count every call to the global allocator, so benchmarks can report allocations per operation.
+// Not inlined: at an inlined call site the compiler sees malloc paired with delete.
+static std::atomic<size_t> _ALLOCATIONS{0};
+__attribute__((noinline)) void* operator new(std::size_t size) {
+    _ALLOCATIONS.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept { std::free(p); }
 
-    if (sched_setaffinity(0, sizeof(mask), &mask) == -1) {
+// Benchmarks run on one core: $BENCH_CPU, default 0
+static void pin_benchmark_thread() {
+    static const int cpu = std::getenv("BENCH_CPU") != nullptr ? std::atoi(std::getenv("BENCH_CPU")) : 0;
+    if (!placement::pin_current_thread(cpu)) {
         perror("sched_setaffinity");
         exit(1);
     }
+}
+
+static void AddOrder_CircularArray(benchmark::State& state) {
+    pin_benchmark_thread();
 
     circular_array::LimitOrderBook lob(2, _LOB_DEPTH);
     // Variables to increment for each order
@@ -118,14 +203,7 @@ static void AddOrder_CircularArray(benchmark::State& state) {
 
 }
 static void AddOrder_HashtTable(benchmark::State& state) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // Set the CPU affinity to CPU 0
-
-    if (sched_setaffinity(0, sizeof(mask), &mask) == -1) {
-        perror("sched_setaffinity");
-        exit(1);
-    }
+    pin_benchmark_thread();
     hash_table::LimitOrderBook lob(2, _LOB_DEPTH);
     // Variables to increment for each order
     int id = 1;
@@ -142,15 +220,26 @@ static void AddOrder_HashtTable(benchmark::State& state) {
         price += 0.01;
     }
 }
-static void AddOrder_LinkedList(benchmark::State& state) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // Set the CPU affinity to CPU 0
+static void AddOrder_FlatHashTable(benchmark::State& state) {
+    pin_benchmark_thread();
+    hash_table::FlatLimitOrderBook lob(2, _LOB_DEPTH);
+    // Variables to increment for each order
+    int id = 1;
+    double price = 10.01;
 
-    if (sched_setaffinity(0, sizeof(mask), &mask) == -1) {
-        perror("sched_setaffinity");
-        exit(1);
+    for (auto _ : state) {
+        // Create a new order with incrementing id and price
+        hash_table::Order order(id, price, 100);
+        // Benchmark the add_order method
+        lob.add_order(order, true);
+
+        // Increment the id and price for the next order
+        id++;
+        price += 0.01;
     }
+}
+static void AddOrder_LinkedList(benchmark::State& state) {
+    pin_benchmark_thread();
     linked_list::LimitOrderBook lob(2, _LOB_DEPTH);
     // Variables to increment for each order
     int id = 1;
@@ -168,15 +257,28 @@ static void AddOrder_LinkedList(benchmark::State& state) {
     }
 
 }
-static void AddOrder_Queue(benchmark::State& state) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // Set the CPU affinity to CPU 0
+static void AddOrder_LinkedList_Allocations(benchmark::State& state) {
+    pin_benchmark_thread();
+    linked_list::LimitOrderBook lob(2, _LOB_DEPTH);
+    // Variables to increment for each order
+    int id = 1;
+    double price = 10.01;
 
-    if (sched_setaffinity(0, sizeof(mask), &mask) == -1) {
-        perror("sched_setaffinity");
-        exit(1);
+    size_t allocations = _ALLOCATIONS.load();
+    for (auto _ : state) {
+        // Create a new order with incrementing id and price
+        linked_list::Order order(id, price, 100);
+        // Benchmark the add_order method (head eviction + arena reuse once the book is full)
+        lob.add_order(order, true);
+
+        // Increment the id and price for the next order
+        id++;
+        price += 0.01;
     }
+    state.counters["allocs_per_op"] = benchmark::Counter(_ALLOCATIONS.load() - allocations, benchmark::Counter::kAvgIterations);
+}
+static void AddOrder_Queue(benchmark::State& state) {
+    pin_benchmark_thread();
     queue::LimitOrderBook lob(2, _LOB_DEPTH);
     // Variables to increment for each order
     int id = 1;
@@ -195,14 +297,7 @@ static void AddOrder_Queue(benchmark::State& state) {
 
 }
 static void AddOrder_BinaryTree(benchmark::State& state) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // Set the CPU affinity to CPU 0
-
-    if (sched_setaffinity(0, sizeof(mask), &mask) == -1) {
-        perror("sched_setaffinity");
-        exit(1);
-    }
+    pin_benchmark_thread();
     binary_tree::LimitOrderBook lob(2, _LOB_DEPTH);
     // Variables to increment for each order
     int id = 1;
@@ -221,17 +316,30 @@ static void AddOrder_BinaryTree(benchmark::State& state) {
 
 }
 
+static void AddOrder_SkipList(benchmark::State& state) {
+    pin_benchmark_thread();
+    skip_list::LimitOrderBook lob(2, _LOB_DEPTH);
+    // Variables to increment for each order
+    int id = 1;
+    double price = 10.01;
 
-static void DeleteOrder_CircularArray(benchmark::State& state) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // Set the CPU affinity to CPU 0
+    for (auto _ : state) {
+        // Create a new order with incrementing id and price
+        skip_list::Order order(id, price, 100);
+        // Benchmark the add_order method
+        lob.add_order(order, true);
 
-    if (sched_setaffinity(0, sizeof(mask), &mask) == -1) {
-        perror("sched_setaffinity");
-        exit(1);
+        // Increment the id and price for the next order
+        id++;
+        price += 0.01;
     }
 
+}
+
+
+static void DeleteOrder_CircularArray(benchmark::State& state) {
+    pin_benchmark_thread();
+
     circular_array::LimitOrderBook lob(2, _LOB_DEPTH);
     // Variables to increment for each order
     int id = 1;
@@ -266,14 +374,7 @@ static void DeleteOrder_CircularArray(benchmark::State& state) {
     }
 }
 static void DeleteOrder_HashTable(benchmark::State& state) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // Set the CPU affinity to CPU 0
-
-    if (sched_setaffinity(0, sizeof(mask), &mask) == -1) {
-        perror("sched_setaffinity");
-        exit(1);
-    }
+    pin_benchmark_thread();
 
     hash_table::LimitOrderBook lob(2, _LOB_DEPTH);
     // Variables to increment for each order
@@ -308,15 +409,44 @@ static void DeleteOrder_HashTable(benchmark::State& state) {
         lob.add_order(new_order, true);
     }
 }
-static void DeleteOrder_LinkedList(benchmark::State& state) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // Set the CPU affinity to CPU 0
+static void DeleteOrder_FlatHashTable(benchmark::State& state) {
+    pin_benchmark_thread();
 
-    if (sched_setaffinity(0, sizeof(mask), &mask) == -1) {
-        perror("sched_setaffinity");
-        exit(1);
+    hash_table::FlatLimitOrderBook lob(2, _LOB_DEPTH);
+    // Variables to increment for each order
+    int id = 1;
+    double price = 10.01;
+
+    // Initialize the LOB with orders
+    for (int i = 0; i < _LOB_DEPTH; ++i) {
+        hash_table::Order order(id, price, 100);
+        lob.add_order(order, true);
+        id++;
+        price += 0.01;
+    }
+
+    // Random number generator
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> distribution(1, _LOB_DEPTH);
+
+    for (auto _ : state) {
+        // Generate a random id
+        int random_id = distribution(generator);
+        // Create a new order with the random id
+        hash_table::Order order(random_id, 10.01 + (random_id - 1) * 0.01, 100);
+        // Benchmark the delete_order method
+        lob.delete_order(order, true);
+
+        // Generate a new random id for the new order
+        int new_id = distribution(generator);
+        // Create a new order with the new random id
+        hash_table::Order new_order(new_id, 10.01 + (new_id - 1) * 0.01, 100);
+        // Add the new order to the LOB
+        lob.add_order(new_order, true);
     }
+}
+static void DeleteOrder_LinkedList(benchmark::State& state) {
+    pin_benchmark_thread();
 
     linked_list::LimitOrderBook lob(2, _LOB_DEPTH);
     // Variables to increment for each order
@@ -351,15 +481,41 @@ static void DeleteOrder_LinkedList(benchmark::State& state) {
         lob.add_order(new_order, true);
     }
 }
-static void DeleteOrder_Queue(benchmark::State& state) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // Set the CPU affinity to CPU 0
+static void DeleteOrder_LinkedList_Allocations(benchmark::State& state) {
+    pin_benchmark_thread();
 
-    if (sched_setaffinity(0, sizeof(mask), &mask) == -1) {
-        perror("sched_setaffinity");
-        exit(1);
+    linked_list::LimitOrderBook lob(2, _LOB_DEPTH);
+    // Variables to increment for each order
+    int id = 1;
+    double price = 10.01;
+
+    // Initialize the LOB with orders
+    for (int i = 0; i < _LOB_DEPTH; ++i) {
+        linked_list::Order order(id, price, 100);
+        lob.add_order(order, true);
+        id++;
+        price += 0.01;
+    }
+
+    // Random number generator
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> distribution(1, _LOB_DEPTH);
+
+    size_t allocations = _ALLOCATIONS.load();
+    for (auto _ : state) {
+        // Delete a random level and add another one (node goes back to the freelist and is reused)
+        int random_id = distribution(generator);
+        linked_list::Order order(random_id, 10.01 + (random_id - 1) * 0.01, 100);
+        lob.delete_order(order, true);
+
+        int new_id = distribution(generator);
+        linked_list::Order new_order(new_id, 10.01 + (new_id - 1) * 0.01, 100);
+        lob.add_order(new_order, true);
     }
+    state.counters["allocs_per_op"] = benchmark::Counter(_ALLOCATIONS.load() - allocations, benchmark::Counter::kAvgIterations);
+}
+static void DeleteOrder_Queue(benchmark::State& state) {
+    pin_benchmark_thread();
 
     queue::LimitOrderBook lob(2, _LOB_DEPTH);
     // Variables to increment for each order
@@ -394,15 +550,44 @@ static void DeleteOrder_Queue(benchmark::State& state) {
         lob.add_order(new_order, true);
     }
 }
-static void DeleteOrder_BinaryTree(benchmark::State& state) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // Set the CPU affinity to CPU 0
+static void DeleteOrder_DaryHeap(benchmark::State& state) {
+    pin_benchmark_thread();
 
-    if (sched_setaffinity(0, sizeof(mask), &mask) == -1) {
-        perror("sched_setaffinity");
-        exit(1);
+    dary_heap::LimitOrderBook lob(2, _LOB_DEPTH);
+    // Variables to increment for each order
+    int id = 1;
+    double price = 10.01;
+
+    // Initialize the LOB with orders
+    for (int i = 0; i < _LOB_DEPTH; ++i) {
+        dary_heap::Order order(id, price, 100);
+        lob.add_order(order, true);
+        id++;
+        price += 0.01;
+    }
+
+    // Random number generator
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> distribution(1, _LOB_DEPTH);
+
+    for (auto _ : state) {
+        // Generate a random id
+        int random_id = distribution(generator);
+        // Create a new order with the random id
+        dary_heap::Order order(random_id, 10.01 + (random_id - 1) * 0.01, 100);
+        // Benchmark the delete_order method
+        lob.delete_order(order, true);
+
+        // Generate a new random id for the new order
+        int new_id = distribution(generator);
+        // Create a new order with the new random id
+        dary_heap::Order new_order(new_id, 10.01 + (new_id - 1) * 0.01, 100);
+        // Add the new order to the LOB
+        lob.add_order(new_order, true);
     }
+}
+static void DeleteOrder_BinaryTree(benchmark::State& state) {
+    pin_benchmark_thread();
 
     binary_tree::LimitOrderBook lob(2, _LOB_DEPTH);
     // Variables to increment for each order
@@ -438,16 +623,46 @@ static void DeleteOrder_BinaryTree(benchmark::State& state) {
     }
 }
 
+static void DeleteOrder_SkipList(benchmark::State& state) {
+    pin_benchmark_thread();
 
-static void GetBestPrice_CircularArray(benchmark::State& state) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // Set the CPU affinity to CPU 0
+    skip_list::LimitOrderBook lob(2, _LOB_DEPTH);
+    // Variables to increment for each order
+    int id = 1;
+    double price = 10.01;
 
-    if (sched_setaffinity(0, sizeof(mask), &mask) == -1) {
-        perror("sched_setaffinity");
-        exit(1);
+    // Initialize the LOB with orders
+    for (int i = 0; i < _LOB_DEPTH; ++i) {
+        skip_list::Order order(id, price, 100);
+        lob.add_order(order, true);
+        id++;
+        price += 0.01;
+    }
+
+    // Random number generator
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> distribution(1, _LOB_DEPTH);
+
+    for (auto _ : state) {
+        // Generate a random id
+        int random_id = distribution(generator);
+        // Create a new order with the random id
+        skip_list::Order order(random_id, 10.01 + (random_id - 1) * 0.01, 100);
+        // Benchmark the delete_order method
+        lob.delete_order(order, true);
+
+        // Generate a new random id for the new order
+        int new_id = distribution(generator);
+        // Create a new order with the new random id
+        skip_list::Order new_order(new_id, 10.01 + (new_id - 1) * 0.01, 100);
+        // Add the new order to the LOB
+        lob.add_order(new_order, true);
     }
+}
+
+
+static void GetBestPrice_CircularArray(benchmark::State& state) {
+    pin_benchmark_thread();
 
     circular_array::LimitOrderBook lob(2, _LOB_DEPTH);
     // Variables to increment for each order
@@ -468,14 +683,7 @@ static void GetBestPrice_CircularArray(benchmark::State& state) {
     }
 }
 static void GetBestPrice_HashTable(benchmark::State& state) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // Set the CPU affinity to CPU 0
-
-    if (sched_setaffinity(0, sizeof(mask), &mask) == -1) {
-        perror("sched_setaffinity");
-        exit(1);
-    }
+    pin_benchmark_thread();
 
     hash_table::LimitOrderBook lob(2, _LOB_DEPTH);
     // Variables to increment for each order
@@ -495,16 +703,30 @@ static void GetBestPrice_HashTable(benchmark::State& state) {
         lob.get_best_bid();
     }
 }
-static void GetBestPrice_LinkedList(benchmark::State& state) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // Set the CPU affinity to CPU 0
+static void GetBestPrice_FlatHashTable(benchmark::State& state) {
+    pin_benchmark_thread();
 
-    if (sched_setaffinity(0, sizeof(mask), &mask) == -1) {
-        perror("sched_setaffinity");
-        exit(1);
+    hash_table::FlatLimitOrderBook lob(2, _LOB_DEPTH);
+    // Variables to increment for each order
+    int id = 1;
+    double price = 10.01;
+
+    // Initialize the LOB with orders
+    for (int i = 0; i < _LOB_DEPTH; ++i) {
+        hash_table::Order order(id, price, 100);
+        lob.add_order(order, true);
+        id++;
+        price += 0.01;
     }
 
+
+    for (auto _ : state) {
+        lob.get_best_bid();
+    }
+}
+static void GetBestPrice_LinkedList(benchmark::State& state) {
+    pin_benchmark_thread();
+
     linked_list::LimitOrderBook lob(2, _LOB_DEPTH);
     // Variables to increment for each order
     int id = 1;
@@ -524,14 +746,7 @@ static void GetBestPrice_LinkedList(benchmark::State& state) {
     }
 }
 static void GetBestPrice_Queue(benchmark::State& state) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // Set the CPU affinity to CPU 0
-
-    if (sched_setaffinity(0, sizeof(mask), &mask) == -1) {
-        perror("sched_setaffinity");
-        exit(1);
-    }
+    pin_benchmark_thread();
 
     queue::LimitOrderBook lob(2, _LOB_DEPTH);
     // Variables to increment for each order
@@ -552,14 +767,7 @@ static void GetBestPrice_Queue(benchmark::State& state) {
     }
 }
 static void GetBestPrice_BinaryTree(benchmark::State& state) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // Set the CPU affinity to CPU 0
-
-    if (sched_setaffinity(0, sizeof(mask), &mask) == -1) {
-        perror("sched_setaffinity");
-        exit(1);
-    }
+    pin_benchmark_thread();
 
     binary_tree::LimitOrderBook lob(2, _LOB_DEPTH);
     // Variables to increment for each order
@@ -580,26 +788,1266 @@ static void GetBestPrice_BinaryTree(benchmark::State& state) {
     }
 }
 
+static void GetBestPrice_SkipList(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    skip_list::LimitOrderBook lob(2, _LOB_DEPTH);
+    // Variables to increment for each order
+    int id = 1;
+    double price = 10.01;
+
+    // Initialize the LOB with orders
+    for (int i = 0; i < _LOB_DEPTH; ++i) {
+        skip_list::Order order(id, price, 100);
+        lob.add_order(order, true);
+        id++;
+        price += 0.01;
+    }
+
+
+    for (auto _ : state) {
+        lob.get_best_bid();
+    }
+}
+
+// Top-N depth snapshot: ring walk from the best pointer into a caller-owned array
+template <int N>
+static void GetDepth_CircularArray(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    circular_array::LimitOrderBook lob(2, _LOB_DEPTH);
+    // Variables to increment for each order
+    int id = 1;
+    double price = 10.01;
+
+    // Initialize the LOB with orders
+    for (int i = 0; i < _LOB_DEPTH; ++i) {
+        circular_array::Order order(id, price, 100);
+        lob.add_order(order, true);
+        id++;
+        price += 0.01;
+    }
+
+    book_depth::DepthLevels<N> depth;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lob.get_depth(true, depth));
+        benchmark::ClobberMemory();
+    }
+}
+// Per tick: quantity update somewhere in the book, then top-N snapshot + cumulative volume + price to fill
+static void PriceToFill_CircularArray(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    circular_array::LimitOrderBook lob(2, _LOB_DEPTH, 10);
+    for (int i = 1; i <= _LOB_DEPTH; ++i) {
+        lob.add_order(circular_array::Order(i, 10.01 + (i - 1) * 0.01, 100), true);
+    }
+
+    // Random number generator
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> level(1, _LOB_DEPTH);
+    std::uniform_int_distribution<int> quantity(1, 500);
+
+    book_depth::DepthLevels<16> depth;
+    double vwap = 0;
+    for (auto _ : state) {
+        int l = level(generator);
+        lob.update_order(circular_array::Order(l, 10.01 + (l - 1) * 0.01, quantity(generator)), true);
+
+        lob.get_depth(true, depth);
+        book_depth::cumulative_sum(depth.quantity, depth.cumulative, depth.count);
+        benchmark::DoNotOptimize(book_depth::price_to_fill(depth, 2000, &vwap));
+        benchmark::DoNotOptimize(lob.get_top_volume(true));
+    }
+}
+
+// Order flow through the matching engine: passive limits around the mid, cancels/replaces of
+// recently placed orders, and aggressive IOCs that sweep 1-3 levels. Reports messages/sec (items_per_second).
+static void MatchingEngine_Throughput(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const int levels = 2000;
+    const int mid = levels / 2;
+    matching_engine::MatchingEngine engine(2, 10.00, levels, 1 << 16, _LOB_DEPTH);
+
+    // Initialize the book with 10 orders per level, 50 levels each side
+    int id = 1;
+    for (int l = 1; l <= 50; ++l) {
+        for (int k = 0; k < 10; ++k) {
+            engine.new_order(id++, 10.00 + (mid - l) * 0.01, 100, true);
+            engine.new_order(id++, 10.00 + (mid + l) * 0.01, 100, false);
+        }
+    }
+
+    // ids of the last passive orders, targets for cancel/replace
+    std::vector<int> recent(4096, 0);
+    size_t recent_pos = 0;
+
+    uint32_t seed = 2463534242u;
+    auto next = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    };
+    size_t reports = 0;
+    size_t messages = 0;
+    for (auto _ : state) {
+        messages++;
+        uint32_t r = next();
+        uint32_t op = r % 100;
+        bool is_bid = (r >> 8) & 1;
+        int offset = 1 + (r >> 9) % 50;
+        int target = recent[(r >> 9) & 4095];
+        if (op < 40) {
+            // the order placed 4096 passive orders ago is pulled, keeps the book at a steady size
+            int& slot = recent[recent_pos++ & 4095];
+            if (slot != 0) {
+                reports += engine.cancel_order(slot).size();
+                messages++;
+            }
+            int level = is_bid ? mid - offset : mid + offset;
+            slot = id;
+            reports += engine.new_order(id++, 10.00 + level * 0.01, 100, is_bid).size();
+        }
+        else if (op < 85) {
+            reports += engine.cancel_order(target).size();
+        }
+        else if (op < 90) {
+            int level = is_bid ? mid - offset : mid + offset;
+            reports += engine.replace_order(target, 10.00 + level * 0.01, 50).size();
+        }
+        else {
+            // cross 1-3 levels through the touch
+            double price = is_bid ? engine.best_offer_price() + (r >> 20) % 3 * 0.01
+                                  : engine.best_bid_price() - (r >> 20) % 3 * 0.01;
+            reports += engine.new_order(id++, price, 300, is_bid, matching_engine::OrderType::IOC).size();
+        }
+    }
+    state.SetItemsProcessed(messages);
+    state.counters["reports_per_order"] = benchmark::Counter(static_cast<double>(reports) / messages);
+    state.counters["resting"] = engine.resting_orders();
+}
+
+// OMS execution reports. Every iteration produces state.range(0) reports for random live orders
+// (ack -> partial fill -> fill, then the order is replaced by a new one) and the OMS consumes them.
+// Items processed = reports, so items_per_second is reports/sec including the producer side.
+const int _OMS_ORDERS = 1 << 18;   // live orders: the order records don't fit in L2
+const int _OMS_SYMBOLS = 64;
+
+struct OmsRiskSink {
+    int64_t position[_OMS_SYMBOLS] = {};
+    double notional[_OMS_SYMBOLS] = {};
+    void on_position_deltas(const oms_pipeline::PositionDelta* deltas, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            position[deltas[i].symbol] += deltas[i].quantity;
+            notional[deltas[i].symbol] += deltas[i].notional;
+        }
+    }
+};
+
+static void OmsExecutionReports_Batched(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const size_t batch = state.range(0);
+    oms_pipeline::ExecutionPipeline oms(4096, _OMS_ORDERS + 4096, _OMS_SYMBOLS, 4096);
+    std::vector<int32_t> ids(_OMS_ORDERS);
+    std::vector<uint8_t> phase(_OMS_ORDERS, 0);
+    int32_t next_id = 1;
+    for (int i = 0; i < _OMS_ORDERS; ++i) {
+        ids[i] = next_id++;
+        oms.add_order(ids[i], i % _OMS_SYMBOLS, 100, i & 1);
+    }
+
+    uint32_t seed = 2463534242u;
+    OmsRiskSink rms;
+    size_t reports = 0;
+    for (auto _ : state) {
+        for (size_t k = 0; k < batch; k++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            uint32_t i = seed & (_OMS_ORDERS - 1);
+            if (phase[i] == 0) {
+                oms.push(oms_pipeline::ExecReport{ids[i], oms_pipeline::ExecType::NEW, 0, 0});
+                phase[i] = 1;
+            }
+            else if (phase[i] == 1) {
+                oms.push(oms_pipeline::ExecReport{ids[i], oms_pipeline::ExecType::PARTIAL_FILL, 40, 10.01});
+                phase[i] = 2;
+            }
+            else {
+                oms.push(oms_pipeline::ExecReport{ids[i], oms_pipeline::ExecType::FILL, 60, 10.02});
+                ids[i] = next_id++;
+                oms.add_order(ids[i], i % _OMS_SYMBOLS, 100, i & 1);
+                phase[i] = 0;
+            }
+        }
+        reports += oms.process_batch(rms, batch);
+    }
+    state.SetItemsProcessed(reports);
+    benchmark::DoNotOptimize(rms.position[0]);
+}
+
+// Same flow through the original OMS design: Order copies with a status string pushed through
+// a mutex queue, popped one by one, unordered_map lookup and string compares.
+struct LegacyOmsOrder {
+    int id;
+    std::string status;
+};
+static void OmsExecutionReports_MutexQueue(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const size_t batch = state.range(0);
+    std::queue<LegacyOmsOrder> order_updates;
+    std::mutex mtx;
+    std::unordered_map<int, LegacyOmsOrder> active_orders;
+    std::unordered_map<int, LegacyOmsOrder> filled_orders;
+    std::vector<int32_t> ids(_OMS_ORDERS);
+    std::vector<uint8_t> phase(_OMS_ORDERS, 0);
+    int32_t next_id = 1;
+    for (int i = 0; i < _OMS_ORDERS; ++i) {
+        ids[i] = next_id++;
+        active_orders[ids[i]] = LegacyOmsOrder{ids[i], "pending"};
+    }
+
+    uint32_t seed = 2463534242u;
+    size_t reports = 0;
+    for (auto _ : state) {
+        for (size_t k = 0; k < batch; k++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            uint32_t i = seed & (_OMS_ORDERS - 1);
+            LegacyOmsOrder update{ids[i], phase[i] == 0 ? "new" : phase[i] == 1 ? "partially filled" : "filled"};
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                order_updates.push(update);
+            }
+            if (phase[i] == 2) {
+                ids[i] = next_id++;
+                active_orders[ids[i]] = LegacyOmsOrder{ids[i], "pending"};
+                phase[i] = 0;
+            }
+            else
+                phase[i]++;
+        }
+        while (true) {
+            LegacyOmsOrder order;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (order_updates.empty())
+                    break;
+                order = order_updates.front();
+                order_updates.pop();
+            }
+            reports++;
+            auto it = active_orders.find(order.id);
+            if (it != active_orders.end()) {
+                it->second.status = order.status;
+                if (order.status == "filled") {
+                    filled_orders[it->first] = it->second;
+                    active_orders.erase(it);
+                } else if (order.status == "cancelled") {
+                    active_orders.erase(it);
+                }
+            }
+        }
+        if (filled_orders.size() > (1 << 16))
+            filled_orders.clear();  // PersistToDB
+    }
+    state.SetItemsProcessed(reports);
+}
+
+// Position/PnL at 10k instruments. Per iteration: one fill, four BBO updates, and every 64 iterations
+// the RMS revalues. range(0)=0 revalues the dirty set only, range(1)=1 re-sums every instrument.
+// Items processed = fills.
+static void PositionEngine_Fills(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const int instruments = 10000;
+    const bool full_recompute = state.range(0) == 1;
+    position_engine::PositionEngine engine(instruments);
+    for (int i = 0; i < instruments; ++i)
+        engine.on_bbo(i, 99.99, 100.01);
+    engine.revalue();
+
+    uint32_t seed = 2463534242u;
+    auto next = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    };
+    size_t fills = 0;
+    for (auto _ : state) {
+        uint32_t r = next();
+        int64_t quantity = static_cast<int64_t>(r >> 24) - 128;
+        engine.on_fill(r % instruments, quantity, 100.00 + ((r >> 16) & 0xFF) * 0.01);
+        for (int k = 0; k < 4; ++k) {
+            uint32_t q = next();
+            double bid = 99.00 + (q >> 20) * 0.01;
+            engine.on_bbo(q % instruments, bid, bid + 0.02);
+        }
+        if ((++fills & 63) == 0) {
+            if (full_recompute)
+                engine.resync();
+            else
+                engine.revalue();
+        }
+    }
+    state.SetItemsProcessed(fills);
+    benchmark::DoNotOptimize(engine.portfolio().unrealized);
+}
+
+// Full portfolio scenario recompute, 10k instruments x 1000 scenarios (delta-gamma) + VaR/ES.
+// range(0): 1 = SIMD kernel, 0 = scalar; range(1): 1 = scenario blocks in parallel (TBB), 0 = one core
+static void RiskKernel_FullRecompute(benchmark::State& state) {
+    const int instruments = 10000;
+    const int scenarios = 1000;
+    risk_kernel::PortfolioRisk risk(instruments, scenarios);
+
+    std::default_random_engine generator;
+    std::normal_distribution<float> returns(0.0f, 0.02f);
+    std::uniform_real_distribution<double> exposure(-1e6, 1e6);
+    for (int i = 0; i < instruments; ++i)
+        risk.set_sensitivity(i, exposure(generator), exposure(generator) * 0.1);
+    for (int s = 0; s < scenarios; ++s) {
+        float* row = risk.scenario(s);
+        for (int i = 0; i < instruments; ++i)
+            row[i] = returns(generator);
+    }
+
+    const bool vectorised = state.range(0) == 1;
+    const bool parallel = state.range(1) == 1;
+    for (auto _ : state) {
+        risk.evaluate(vectorised, parallel);
+        benchmark::DoNotOptimize(risk.report(0.99));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(instruments) * scenarios);
+}
+
+// Risk limit monitoring at 10k instruments, 4 rules per instrument + 2 portfolio rules.
+// Per iteration: 64 fills/marks, revalue, one rule cycle. range(0)=1 puts every instrument over its
+// exposure limit (alert storm): the cycle cost must stay flat, alerts are rate limited and dropped/retried.
+static void RiskRules_Cycle(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const int instruments = 10000;
+    const bool storm = state.range(0) == 1;
+    std::vector<risk_rules::RuleSpec> rules = {
+        {1, risk_rules::RuleKind::EXPOSURE, risk_rules::ALL_INSTRUMENTS, storm ? 1.0 : 1e9},
+        {2, risk_rules::RuleKind::DRAWDOWN, risk_rules::ALL_INSTRUMENTS, 1e6},
+        {3, risk_rules::RuleKind::CONCENTRATION, risk_rules::ALL_INSTRUMENTS, 0.25},
+        {4, risk_rules::RuleKind::ORDER_RATE, risk_rules::ALL_INSTRUMENTS, 50},
+        {5, risk_rules::RuleKind::DRAWDOWN, risk_rules::PORTFOLIO, 1e7},
+        {6, risk_rules::RuleKind::EXPOSURE, risk_rules::PORTFOLIO, 1e10},
+    };
+    risk_rules::RuleEngine engine(instruments, rules, risk_rules::AlertLimits{1024, 1000000ull, 64, 10000, 1000000000ull});
+    position_engine::PositionEngine positions(instruments);
+
+    uint32_t seed = 2463534242u;
+    auto next = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    };
+    uint64_t now = 0;
+    risk_rules::Alert alert;
+    for (auto _ : state) {
+        for (int k = 0; k < 64; ++k) {
+            uint32_t r = next();
+            int32_t instrument = r % instruments;
+            positions.on_fill(instrument, static_cast<int64_t>(r >> 24) - 128, 100.00);
+            double bid = 99.00 + ((r >> 12) & 0xFF) * 0.01;
+            positions.on_bbo(instrument, bid, bid + 0.02);
+            engine.touch(instrument);
+        }
+        positions.revalue();
+        now += 100000;   // one cycle every 100us
+        engine.evaluate(positions, now);
+        while (engine.next_alert(alert))   // alert sender, same thread here
+            benchmark::DoNotOptimize(alert);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["suppressed"] = static_cast<double>(engine.suppressed_alerts());
+}
+
+// Full-day TCA replay: 500 instruments, 8 venues, one event every 20us of market time
+// (book updates, with an order + fill every 16th event). The x_realtime counter is market
+// seconds replayed per wall clock second, it has to stay above 1.
+static void Tca_Replay(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const int instruments = 500;
+    const int venues = 8;
+    const uint64_t step_ns = 20000;
+    struct Event {
+        int32_t instrument;
+        bool fill;
+        double bid;
+        uint32_t r;
+    };
+    std::vector<Event> events(1 << 20);
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int32_t> instrument(0, instruments - 1);
+    std::uniform_int_distribution<int> ticks(-2, 2);
+    std::vector<double> bids(instruments, 100.00);
+    for (size_t i = 0; i < events.size(); ++i) {
+        int32_t id = instrument(generator);
+        bids[id] += ticks(generator) * 0.01;
+        events[i] = Event{id, (i & 15) == 0, bids[id], static_cast<uint32_t>(generator())};
+    }
+
+    tca::TcaEngine engine(instruments, venues, 1 << 16);
+    uint64_t now = 0;
+    for (auto _ : state) {
+        for (const Event& e : events) {
+            now += step_ns;
+            if (e.fill) {
+                int32_t venue = e.r % venues;
+                bool is_buy = (e.r >> 8) & 1;
+                engine.on_order(venue, now, tca::OrderEvent::SENT);
+                engine.on_fill(tca::Fill{now, now - (e.r >> 12) % 2000000000ull, e.instrument, venue, 100,
+                                         is_buy, is_buy ? e.bid + 0.02 : e.bid});
+            }
+            else {
+                engine.on_book(e.instrument, now, e.bid, e.bid + 0.02);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * events.size());
+    state.counters["x_realtime"] = benchmark::Counter(state.iterations() * events.size() * step_ns * 1e-9, benchmark::Counter::kIsRate);
+    benchmark::DoNotOptimize(engine.venue(0));
+}
+
+// Venue metrics store, writer side: one execution report (decay, window, snapshot publish) per iteration
+static void VenueMetrics_Update(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const int venues = 16;
+    venue_metrics::VenueMetricsStore store(venues, 10000000000ull);
+    const venue_metrics::ReportType types[8] = {
+        venue_metrics::ReportType::SENT, venue_metrics::ReportType::ACK, venue_metrics::ReportType::PARTIAL_FILL,
+        venue_metrics::ReportType::FILL, venue_metrics::ReportType::SENT, venue_metrics::ReportType::ACK,
+        venue_metrics::ReportType::REJECTED, venue_metrics::ReportType::CANCELLED};
+    uint64_t now = 0;
+    uint32_t i = 0;
+    for (auto _ : state) {
+        now += 5000;
+        store.on_report(venue_metrics::VenueReport{now, static_cast<int32_t>(i % venues), types[(i >> 4) & 7], 100, 1.5, 40000});
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+    benchmark::DoNotOptimize(store.read(0));
+}
+
+// Router side: read one venue's snapshot while a writer thread keeps publishing reports.
+// range(0)=0 seqlock snapshot, range(1)=1 the same struct copied under a mutex
+static void VenueMetrics_Read(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const int venues = 16;
+    const bool use_mutex = state.range(0) == 1;
+    venue_metrics::VenueMetricsStore store(venues, 10000000000ull);
+    venue_metrics::VenueSnapshot locked_snapshot{};
+    std::mutex lock;
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        uint64_t now = 0;
+        for (uint32_t i = 0; !done.load(std::memory_order_relaxed); ++i) {
+            now += 5000;
+            venue_metrics::VenueReport report{now, static_cast<int32_t>(i % venues), venue_metrics::ReportType::SENT, 0, 0, 0};
+            if (use_mutex) {
+                std::lock_guard<std::mutex> guard(lock);
+                locked_snapshot.time_ns = now;
+                locked_snapshot.window_orders++;
+            }
+            else {
+                store.on_report(report);
+            }
+        }
+    });
+
+    uint32_t i = 0;
+    for (auto _ : state) {
+        if (use_mutex) {
+            std::lock_guard<std::mutex> guard(lock);
+            benchmark::DoNotOptimize(locked_snapshot);
+        }
+        else {
+            benchmark::DoNotOptimize(store.read(i % venues));
+        }
+        ++i;
+    }
+    done = true;
+    writer.join();
+    state.SetItemsProcessed(state.iterations());
+}
+
+// SOR agent states for a batch of 256 routing decisions (10k instruments, 16 venues).
+// range(0)=0: per decision a std::vector<double> with push_backs, then a float copy for the tensor
+// (what getStateRepresentation + tensorFromState do); range(0)=1: FeatureBuilder into one aligned matrix
+static void FeatureBuilder_Batch(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const int instruments = 10000;
+    const int venues = 16;
+    const int portfolios = 64;
+    const size_t batch_size = 256;
+    const bool batched = state.range(0) == 1;
+
+    std::default_random_engine generator;
+    std::uniform_real_distribution<float> value(0.0f, 1.0f);
+    auto random_column = [&](size_t n) {
+        std::vector<float> column(n);
+        for (float& v : column)
+            v = value(generator);
+        return column;
+    };
+    features::PortfolioArrays portfolio{random_column(portfolios), random_column(portfolios)};
+    features::MarketArrays market{random_column(instruments), random_column(instruments), random_column(instruments)};
+    features::VenueArrays venue_arrays{random_column(venues), random_column(venues), random_column(venues), random_column(venues)};
+    std::vector<features::Decision> decisions(batch_size);
+    for (auto& d : decisions)
+        d = features::Decision{static_cast<int32_t>(generator() % portfolios), static_cast<int32_t>(generator() % instruments),
+                               static_cast<int32_t>(generator() % venues)};
+
+    features::FeatureMatrix matrix(batch_size);
+    features::FeatureBuilder builder;
+    for (auto _ : state) {
+        if (batched) {
+            builder.build(decisions.data(), batch_size, portfolio, market, venue_arrays, matrix);
+            benchmark::DoNotOptimize(matrix.row(batch_size - 1)[0]);
+        }
+        else {
+            for (const auto& d : decisions) {
+                std::vector<double> representation;
+                representation.push_back(portfolio.cash[d.portfolio]);
+                representation.push_back(portfolio.asset_count[d.portfolio]);
+                representation.push_back(market.price[d.instrument]);
+                representation.push_back(market.spread[d.instrument]);
+                representation.push_back(market.vwap[d.instrument]);
+                representation.push_back(venue_arrays.slippage[d.venue]);
+                representation.push_back(venue_arrays.reject_rate[d.venue]);
+                representation.push_back(venue_arrays.cancel_rate[d.venue]);
+                representation.push_back(venue_arrays.fill_rate[d.venue]);
+                std::vector<float> tensor(representation.begin(), representation.end());
+                benchmark::DoNotOptimize(tensor.data());
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+// Q-network forward pass, 16 -> 128 -> 128 -> 3 (the agents' network shape).
+// range(0): states per call (1 = single decision latency, 256 = batch); range(1): 1 = int8 hidden layers
+static void Mlp_Inference(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const size_t batch = state.range(0);
+    const size_t sizes[4] = {16, 128, 128, 3};
+    std::default_random_engine generator;
+    std::normal_distribution<float> weight(0.0f, 0.1f);
+    mlp::Network network(256);
+    for (int l = 0; l < 3; ++l) {
+        std::vector<float> kernel(sizes[l] * sizes[l + 1]), bias(sizes[l + 1]);
+        for (float& w : kernel)
+            w = weight(generator);
+        for (float& b : bias)
+            b = weight(generator);
+        network.add_layer(sizes[l], sizes[l + 1], l < 2 ? mlp::Activation::RELU : mlp::Activation::NONE, kernel.data(), bias.data());
+    }
+    if (state.range(1) == 1)
+        network.quantize();
+
+    features::FeatureMatrix states(batch);
+    for (size_t r = 0; r < batch; ++r)
+        for (size_t i = 0; i < 16; ++i)
+            states.row(r)[i] = weight(generator) * 10;
+    states.set_rows(batch);
+    std::vector<float> q(batch * 3);
+    for (auto _ : state) {
+        network.forward(states.data(), states.stride(), batch, q.data());
+        benchmark::DoNotOptimize(q.data());
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+
+// Replay memory of 10000 experiences (16-feature states), one training batch of 64 per iteration.
+// range(0): 0 = deque of experiences copied out (the previous memory), 1 = ReplayBuffer prioritised sample
+struct DequeExperience {
+    std::vector<float> state;
+    int action;
+    float reward;
+    std::vector<float> next_state;
+    bool done;
+};
+static void Replay_Sample(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const size_t capacity = 10000, dim = 16, batch_size = 64;
+    std::mt19937_64 rng(1);
+    std::vector<float> s(dim), ns(dim);
+    if (state.range(0) == 0) {
+        std::deque<DequeExperience> memory;
+        for (size_t i = 0; i < capacity; ++i) {
+            for (size_t f = 0; f < dim; ++f)
+                s[f] = ns[f] = static_cast<float>(i + f);
+            memory.push_back(DequeExperience{s, static_cast<int>(i % 3), 1.0f, ns, false});
+        }
+        for (auto _ : state) {
+            std::vector<DequeExperience> batch;
+            std::sample(memory.begin(), memory.end(), std::back_inserter(batch), batch_size, rng);
+            benchmark::DoNotOptimize(batch.data());
+        }
+    }
+    else {
+        replay::ReplayBuffer buffer(capacity, dim);
+        for (size_t i = 0; i < capacity; ++i) {
+            for (size_t f = 0; f < dim; ++f)
+                s[f] = ns[f] = static_cast<float>(i + f);
+            buffer.add(s.data(), static_cast<int>(i % 3), 1.0f, ns.data(), false);
+        }
+        replay::SampleBatch batch;
+        for (auto _ : state) {
+            buffer.sample(batch_size, 0.4, rng, batch);
+            benchmark::DoNotOptimize(batch.states.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+// ReplayBuffer insertion (copy two rows, publish, sum-tree update)
+static void Replay_Add(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    replay::ReplayBuffer buffer(10000, 16);
+    std::vector<float> s(16, 1.0f), ns(16, 2.0f);
+    int i = 0;
+    for (auto _ : state) {
+        buffer.add(s.data(), i % 3, 1.0f, ns.data(), false);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 1024 SOR trading environments, one step of all of them per iteration.
+// range(0): 0 = one Environment object at a time (mt19937 + distribution per environment, branches),
+// 1 = VectorEnv scalar loop, 2 = VectorEnv AVX-512, both on one thread, 3 = AVX-512 on the TBB pool,
+// 4 = full RolloutRunner step: batched 9-128-128-3 inference, epsilon-greedy, step, replay insert
+struct ScalarTradingEnv {
+    double cash = 10000.0, assets = 0, price = 100.0;
+    uint32_t episode_step = 0;
+    std::mt19937 rng;
+    std::uniform_real_distribution<double> price_change{-0.5, 0.5};
+    double step(int action) {
+        double change = price_change(rng);
+        double new_price = price + change;
+        double reward = 0.0;
+        if (action == 0) {
+            if (cash >= new_price) { cash -= new_price; assets += 1; reward = change; }
+            else reward = -1;
+        } else if (action == 1) {
+            if (assets > 0) { cash += new_price; assets -= 1; reward = change; }
+            else reward = -1;
+        } else {
+            reward = change * assets;
+        }
+        price = new_price;
+        if (++episode_step >= 1000) { cash = 10000.0; assets = 0; price = 100.0; episode_step = 0; }
+        return reward;
+    }
+};
+static void Rollout_Step(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const size_t num_envs = 1024;
+    std::vector<int32_t> actions(num_envs);
+    std::vector<float> rewards(num_envs);
+    std::vector<uint8_t> dones(num_envs);
+    std::mt19937 generator(3);
+    for (auto& a : actions)
+        a = generator() % 3;
+    if (state.range(0) == 0) {
+        std::vector<ScalarTradingEnv> envs(num_envs);
+        for (size_t i = 0; i < num_envs; ++i)
+            envs[i].rng.seed(i);
+        for (auto _ : state) {
+            for (size_t i = 0; i < num_envs; ++i)
+                rewards[i] = static_cast<float>(envs[i].step(actions[i]));
+            benchmark::DoNotOptimize(rewards.data());
+        }
+    }
+    else if (state.range(0) < 4) {
+        rollout::VectorEnv envs(num_envs);
+        for (auto _ : state) {
+            envs.step(actions.data(), rewards.data(), dones.data(), state.range(0) >= 2, state.range(0) == 3);
+            benchmark::DoNotOptimize(rewards.data());
+        }
+    }
+    else {
+        rollout::VectorEnv envs(num_envs);
+        const size_t sizes[4] = {features::NUM_FEATURES, 128, 128, 3};
+        std::normal_distribution<float> weight(0.0f, 0.01f);
+        std::default_random_engine weights_generator;
+        mlp::Network policy(256);
+        for (int l = 0; l < 3; ++l) {
+            std::vector<float> kernel(sizes[l] * sizes[l + 1]), bias(sizes[l + 1], 0.0f);
+            for (float& w : kernel)
+                w = weight(weights_generator);
+            policy.add_layer(sizes[l], sizes[l + 1], l < 2 ? mlp::Activation::RELU : mlp::Activation::NONE, kernel.data(), bias.data());
+        }
+        replay::ReplayBuffer memory(1 << 17, features::NUM_FEATURES);
+        rollout::RolloutRunner runner(envs, &policy, &memory);
+        for (auto _ : state)
+            runner.run(1, 0.1);
+    }
+    state.SetItemsProcessed(state.iterations() * num_envs);
+}
+
+// Daily OHLCV history of a 2000 ticker x 5 year (1260 trading days) universe, generated once
+// into /tmp: one CSV per ticker plus the same universe saved as one column file (about 260MB,
+// removed at exit)
+const size_t OHLCV_TICKERS = 2000;
+const size_t OHLCV_DAYS = 1260;
+struct OhlcvBenchFiles {
+    std::string dir;
+    std::vector<std::string> paths;
+    std::string saved;
+    ~OhlcvBenchFiles() {
+        for (const std::string& p : paths)
+            std::remove(p.c_str());
+        if (!saved.empty())
+            std::remove(saved.c_str());
+        if (!dir.empty())
+            rmdir(dir.c_str());
+    }
+};
+static std::vector<std::string> ohlcv_bench_files(std::string& column_file) {
+    static OhlcvBenchFiles files;
+    std::vector<std::string>& paths = files.paths;
+    std::string& saved = files.saved;
+    if (paths.empty()) {
+        std::string dir = files.dir = "/tmp/ohlcv_bench_" + std::to_string(getpid());
+        mkdir(dir.c_str(), 0755);
+        std::mt19937 generator(11);
+        std::uniform_real_distribution<double> move(-0.02, 0.02);
+        for (size_t t = 0; t < OHLCV_TICKERS; ++t) {
+            paths.push_back(dir + "/T" + std::to_string(t) + ".csv");
+            FILE* f = std::fopen(paths.back().c_str(), "w");
+            std::fprintf(f, "Date,Open,High,Low,Close,Adj Close,Volume\n");
+            double price = 20 + t % 200;
+            for (size_t d = 0; d < OHLCV_DAYS; ++d) {
+                double open = price, close = price * (1 + move(generator));
+                std::fprintf(f, "%04zu-%02zu-%02zu,%.4f,%.4f,%.4f,%.4f,%.4f,%zu\n", 2019 + d / 252, 1 + d / 21 % 12,
+                             1 + d % 21, open, std::max(open, close) * 1.01, std::min(open, close) * 0.99, close, close * 0.98,
+                             1000 + generator() % 100000);
+                price = close;
+            }
+            std::fclose(f);
+        }
+        saved = dir + "/universe.ohlcv";
+        ohlcv::OhlcvStore::from_csv(paths).save(saved);
+    }
+    column_file = saved;
+    return paths;
+}
+
+// Market data startup, universe from state.range(0):
+// 0 = parse the CSVs (TBB pool), 1 = mmap the column file, 2 = mmap + read every close (page in)
+static void Ohlcv_Startup(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    std::string column_file;
+    std::vector<std::string> paths = ohlcv_bench_files(column_file);
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            ohlcv::OhlcvStore store = ohlcv::OhlcvStore::from_csv(paths);
+            benchmark::DoNotOptimize(store.column(0, ohlcv::CLOSE));
+        }
+        else {
+            ohlcv::OhlcvStore store = ohlcv::OhlcvStore::open(column_file);
+            double total = 0;
+            if (state.range(0) == 2)
+                for (size_t t = 0; t < store.tickers(); ++t)
+                    for (size_t d = 0; d < store.days(); ++d)
+                        total += store.column(static_cast<int32_t>(t), ohlcv::CLOSE)[d];
+            benchmark::DoNotOptimize(total);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * OHLCV_TICKERS);
+}
+
+// Per-step access for every ticker of the universe: current close + the last 10 days of closes.
+// range(0): 0 = std::map<string, vector<DataPoint>> lookup and history copy (RMS.cpp MarketData before),
+// 1 = OhlcvStore with ticker ids resolved once and a window view
+struct MapDataPoint {
+    double open, close, high, low, volume, adjusted_close;
+};
+static void Ohlcv_Access(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    std::string column_file;
+    ohlcv_bench_files(column_file);
+    ohlcv::OhlcvStore store = ohlcv::OhlcvStore::open(column_file);
+    size_t day = store.days() - 1;
+    if (state.range(0) == 0) {
+        std::map<std::string, std::vector<MapDataPoint>> data;
+        std::vector<std::string> tickers;
+        for (size_t t = 0; t < store.tickers(); ++t) {
+            int32_t id = static_cast<int32_t>(t);
+            tickers.push_back(store.name(id));
+            std::vector<MapDataPoint>& points = data[store.name(id)];
+            for (size_t d = 0; d < store.days(); ++d) {
+                ohlcv::Bar b = store.bar(id, d);
+                points.push_back(MapDataPoint{b.open, b.close, b.high, b.low, b.volume, b.adjusted_close});
+            }
+        }
+        for (auto _ : state) {
+            double total = 0;
+            for (const std::string& ticker : tickers) {
+                total += data.at(ticker)[day].close;
+                const std::vector<MapDataPoint>& points = data.at(ticker);
+                std::vector<MapDataPoint> history(points.end() - 10, points.end());
+                for (const MapDataPoint& p : history)
+                    total += p.close;
+            }
+            benchmark::DoNotOptimize(total);
+        }
+    }
+    else {
+        std::vector<int32_t> ids;
+        for (size_t t = 0; t < store.tickers(); ++t)
+            ids.push_back(store.id(store.name(static_cast<int32_t>(t))));
+        for (auto _ : state) {
+            double total = 0;
+            for (int32_t id : ids) {
+                total += store.column(id, ohlcv::CLOSE)[day];
+                ohlcv::Window history = store.window(id, store.days(), 10);
+                for (size_t i = 0; i < history.size; ++i)
+                    total += history(ohlcv::CLOSE, i);
+            }
+            benchmark::DoNotOptimize(total);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * OHLCV_TICKERS);
+}
+
+// One bar for 2000 tickers, 20 bar window: mean, stddev, EMA, VWAP, min, max, returns of every ticker.
+// range(0): 0 = recompute each window from the last 20 bars (what State::toTensor style code does),
+// 1 = IndicatorEngine scalar update, 2 = IndicatorEngine AVX-512 update
+static void Indicators_Update(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const size_t tickers = 2000, window = 20, bars = 256;
+    std::mt19937 generator(4);
+    std::uniform_real_distribution<double> move(-0.5, 0.5);
+    std::vector<double> prices(bars * tickers), volumes(bars * tickers);
+    for (size_t t = 0; t < tickers; ++t) {
+        double p = 50 + t % 100;
+        for (size_t b = 0; b < bars; ++b) {
+            p += move(generator);
+            prices[b * tickers + t] = p;
+            volumes[b * tickers + t] = 1000 + generator() % 1000;
+        }
+    }
+    size_t b = window;
+    if (state.range(0) == 0) {
+        std::vector<float> out(tickers * indicators::NUM_INDICATORS);
+        std::vector<double> ema(tickers, 100.0);
+        for (auto _ : state) {
+            for (size_t t = 0; t < tickers; ++t) {
+                double sum = 0, pv = 0, v = 0, lo = 1e300, hi = -1e300;
+                for (size_t k = b - window + 1; k <= b; ++k) {
+                    double p = prices[k * tickers + t];
+                    sum += p;
+                    pv += p * volumes[k * tickers + t];
+                    v += volumes[k * tickers + t];
+                    lo = std::min(lo, p);
+                    hi = std::max(hi, p);
+                }
+                double mean = sum / window, m2 = 0;
+                for (size_t k = b - window + 1; k <= b; ++k)
+                    m2 += (prices[k * tickers + t] - mean) * (prices[k * tickers + t] - mean);
+                double p = prices[b * tickers + t];
+                ema[t] += 2.0 / 21 * (p - ema[t]);
+                float* row = &out[t * indicators::NUM_INDICATORS];
+                row[indicators::MEAN] = static_cast<float>(mean);
+                row[indicators::STDDEV] = static_cast<float>(std::sqrt(m2 / (window - 1)));
+                row[indicators::EMA] = static_cast<float>(ema[t]);
+                row[indicators::VWAP] = static_cast<float>(pv / v);
+                row[indicators::MIN] = static_cast<float>(lo);
+                row[indicators::MAX] = static_cast<float>(hi);
+                row[indicators::BAR_RETURN] = static_cast<float>(p / prices[(b - 1) * tickers + t] - 1);
+                row[indicators::WINDOW_RETURN] = static_cast<float>(p / prices[(b - window + 1) * tickers + t] - 1);
+            }
+            benchmark::DoNotOptimize(out.data());
+            b = b + 1 < bars ? b + 1 : window;
+        }
+    }
+    else {
+        indicators::IndicatorEngine engine(tickers, window);
+        for (auto _ : state) {
+            engine.update(&prices[b * tickers], &volumes[b * tickers], state.range(0) == 2);
+            benchmark::DoNotOptimize(engine.rolling_mean(0));
+            b = b + 1 < bars ? b + 1 : 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * tickers);
+}
+
+// One RMS trading environment step over a universe of range(1) tickers with a year of history and
+// 20 held assets: trade one asset, move to the next day, value the portfolio, hand back the state.
+// range(0): 0 = std::map<string, double> positions, string lookups, State returned by value (copy of
+// the market data), 1 = PortfolioBook by ticker id, incremental total, state returned as a view
+struct MapTradingState {
+    std::map<std::string, double> assets;
+    double cash = 1e6;
+    std::map<std::string, std::vector<double>> closes;
+    size_t day = 0;
+};
+static void Portfolio_Step(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const size_t universe = state.range(1), days = 252, held = 20;
+    std::mt19937 generator(6);
+    std::vector<std::string> names;
+    std::vector<double> closes(universe * days);
+    for (size_t t = 0; t < universe; ++t) {
+        names.push_back("T" + std::to_string(t));
+        for (size_t d = 0; d < days; ++d)
+            closes[t * days + d] = 50 + (generator() % 1000) * 0.01;
+    }
+    size_t step = 0;
+    if (state.range(0) == 0) {
+        MapTradingState current;
+        for (size_t t = 0; t < universe; ++t)
+            current.closes[names[t]] = std::vector<double>(&closes[t * days], &closes[t * days] + days);
+        for (size_t h = 0; h < held; ++h)
+            current.assets[names[h]] = 10;
+        for (auto _ : state) {
+            const std::string& ticker = names[step % held];
+            double price = current.closes.at(ticker)[current.day];
+            current.assets[ticker] += 1;
+            current.cash -= price;
+            current.day = (current.day + 1) % days;
+            double total = current.cash;
+            for (const auto& [name, quantity] : current.assets)
+                total += quantity * current.closes.at(name)[current.day];
+            MapTradingState returned = current;
+            benchmark::DoNotOptimize(total);
+            benchmark::DoNotOptimize(returned.day);
+            ++step;
+        }
+    }
+    else {
+        portfolio_book::PortfolioBook book(universe, 1e6);
+        size_t day = 0;
+        for (size_t h = 0; h < held; ++h)
+            book.buy(static_cast<int32_t>(h), 10, closes[h * days]);
+        for (auto _ : state) {
+            int32_t asset = static_cast<int32_t>(step % held);
+            book.buy(asset, 1, closes[asset * days + day]);
+            day = (day + 1) % days;
+            for (int32_t a : book.held())
+                book.mark(a, closes[a * days + day]);
+            double total = book.total_value();
+            const portfolio_book::PortfolioBook& returned = book;
+            benchmark::DoNotOptimize(total);
+            benchmark::DoNotOptimize(&returned);
+            ++step;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// One day of synthetic MBP + trade history: events / instruments per instrument
+static std::vector<backtest::EventStream> synthetic_backtest_day(size_t instruments, size_t events) {
+    std::mt19937 generator(46);
+    std::vector<backtest::EventStream> streams(instruments);
+    for (size_t s = 0; s < instruments; ++s) {
+        int64_t t = s;
+        double mid = 150.0;
+        for (size_t i = 0; i < events / instruments; ++i) {
+            t += 1 + generator() % 20000;
+            if (generator() % 4 == 0) {
+                bool buyer = generator() % 2;
+                streams[s].push_back(backtest::MarketEvent{t, buyer ? mid + 0.05 : mid - 0.05, static_cast<int>(1 + generator() % 200), backtest::EventType::TRADE, buyer});
+            }
+            else {
+                mid += (static_cast<int>(generator() % 3) - 1) * 0.01;
+                bool bid = generator() % 2;
+                double price = bid ? mid - 0.05 - (generator() % 5) * 0.01 : mid + 0.05 + (generator() % 5) * 0.01;
+                int quantity = generator() % 8 == 0 ? 0 : static_cast<int>(100 + generator() % 500);
+                streams[s].push_back(backtest::MarketEvent{t, std::round(price * 100) / 100, quantity, backtest::EventType::BOOK, bid});
+            }
+        }
+    }
+    return streams;
+}
+
+// Backtest replay: a day of state.range(0) instruments merged and driven through book,
+// simulated venue, StrategyModule and position engine.
+// Items = market events; a year of ticks is 252 x the day's events.
+static void Backtest_Replay(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const size_t instruments = state.range(0);
+    std::vector<backtest::EventStream> streams = synthetic_backtest_day(instruments, 1000000);
+    std::vector<const backtest::EventStream*> day;
+    for (const backtest::EventStream& s : streams)
+        day.push_back(&s);
+    backtest::BacktestConfig config;
+    config.latency = 20000;
+    auto make = [](circular_array::LimitOrderBook& book, strategy::OrderGateway& gateway) { return strategy::StrategyModule(book, gateway); };
+    uint64_t replayed = 0;
+    for (auto _ : state) {
+        backtest::Backtester<strategy::StrategyModule> backtester(instruments, config, make);
+        backtest::BacktestResult result = backtester.run(day);
+        replayed += result.events;
+        benchmark::DoNotOptimize(result.pnl.data());
+    }
+    state.SetItemsProcessed(replayed);
+}
+
+// Parameter sweep of 32 StrategyModule settings over a mapped day of 64 instruments (200k events):
+// 0 = one fresh Backtester per run over the in-memory streams, 1 = sweep::run_sweep (per-thread
+// reused backtesters, work-stealing over runs). Items = backtest runs.
+static void Parameter_Sweep(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const size_t instruments = 64;
+    std::vector<backtest::EventStream> streams = synthetic_backtest_day(instruments, 200000);
+    std::vector<const backtest::EventStream*> day;
+    for (const backtest::EventStream& s : streams)
+        day.push_back(&s);
+    std::string path = "/tmp/parameter_sweep_bench_" + std::to_string(getpid()) + ".events";
+    sweep::EventFile::save(path, day);
+    sweep::EventFile file = sweep::EventFile::open(path);
+    std::remove(path.c_str());   // the mapping stays valid
+
+    std::vector<strategy::StrategyParams> grid;
+    for (int i = 0; i < 32; ++i) {
+        strategy::StrategyParams p;
+        p.edge = (i % 8) * 0.01;
+        p.quantity = 50 * (1 + i / 8);
+        grid.push_back(p);
+    }
+    backtest::BacktestConfig config;
+    config.latency = 20000;
+    double pnl = 0;
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            for (const strategy::StrategyParams& p : grid) {
+                backtest::Backtester<strategy::StrategyModule> backtester(instruments, config,
+                    [&](circular_array::LimitOrderBook& book, strategy::OrderGateway& gateway) { return strategy::StrategyModule(book, gateway, p); });
+                pnl += backtester.run(day).pnl.back().realized;
+            }
+        }
+        else {
+            sweep::SweepResults results = sweep::run_sweep(file.streams(), grid, config);
+            pnl += results.at(sweep::REALIZED, 0);
+        }
+    }
+    benchmark::DoNotOptimize(pnl);
+    state.SetItemsProcessed(state.iterations() * grid.size());
+}
+
+// Queue round trip between two pinned threads: 0 = two physical cores of one socket,
+// 1 = cores on different sockets. The rings are allocated on their reader's node.
+// Skipped when the machine has no such pair of cores.
+static void Queue_PingPong(benchmark::State& state) {
+    const bool cross_socket = state.range(0) == 1;
+    placement::Topology topology = placement::Topology::read();
+    std::vector<int> cores = topology.physical_cores();
+    int ping = -1, pong = -1;
+    for (size_t a = 0; a < cores.size() && pong < 0; ++a)
+        for (size_t b = a + 1; b < cores.size() && pong < 0; ++b)
+            if ((topology.find(cores[a])->package != topology.find(cores[b])->package) == cross_socket) {
+                ping = cores[a];
+                pong = cores[b];
+            }
+    if (pong < 0) {
+        state.SkipWithError(cross_socket ? "needs cores on two sockets" : "needs two physical cores on one socket");
+        return;
+    }
+    placement::PlacementConfig config;
+    config.cpu[placement::BOOK] = ping;
+    config.cpu[placement::STRATEGY] = pong;
+    placement::ThreadPlacement layout(topology, config);
+    auto to_strategy = layout.construct_on(placement::STRATEGY, [] { return std::make_unique<oms_pipeline::ReportQueue>(1024); });
+    auto to_book = layout.construct_on(placement::BOOK, [] { return std::make_unique<oms_pipeline::ReportQueue>(1024); });
+    std::atomic<bool> done{false};
+    std::thread echo([&]() {
+        layout.pin(placement::STRATEGY);
+        oms_pipeline::ExecReport report;
+        while (!done.load(std::memory_order_relaxed))
+            if (to_strategy->pop_batch(&report, 1) == 1)
+                while (!to_book->push(report)) {}
+    });
+    layout.pin(placement::BOOK);
+    oms_pipeline::ExecReport report{1, oms_pipeline::ExecType::NEW, 0, 0.0}, back;
+    for (auto _ : state) {
+        while (!to_strategy->push(report)) {}
+        while (to_book->pop_batch(&back, 1) == 0) {}
+        report.order_id++;
+    }
+    done = true;
+    echo.join();
+    state.SetItemsProcessed(state.iterations());
+}
+
+// First feed message after an idle gap, through parser, book, strategy, risk and encoder.
+// The gap is simulated by streaming 32MB (evicts the caches) and sorting random data (retrains
+// the branch predictors); 0 = no warm-up, 1 = warm-up passes during the gap. Manual time = the
+// message only.
+struct CountingSink : warmup::OrderSink {
+    uint64_t bytes = 0;
+    void send(const char*, size_t size) override { bytes += size; }
+};
+static void Warmup_FirstAfterIdle(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    circular_array::LimitOrderBook book(2, 2000);
+    CountingSink sink;
+    warmup::HotPath path(book, sink);
+    warmup::WarmupConfig config;
+    config.enabled = state.range(0) == 1;
+    config.warmup_interval = 0;
+    warmup::TradingLoop loop(path, config);
+    for (int i = 0; i < 10; ++i) {
+        book.update_order(circular_array::Order(0, 149.95 - i * 0.01, 100 + i), true);
+        book.update_order(circular_array::Order(0, 150.05 + i * 0.01, 100 + i), false);
+    }
+    std::vector<char> pollution(32 << 20, 1);
+    std::vector<int> shuffled(20000);
+    std::mt19937 generator(49);
+    warmup::FeedMessage message{0, 14995, 0, static_cast<uint8_t>(backtest::EventType::BOOK), 1, 0, 0};
+    char bytes[sizeof(message)];
+    int64_t now = 0;
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < pollution.size(); i += 64)
+            sum += ++pollution[i];
+        for (int& v : shuffled)
+            v = static_cast<int>(generator());
+        std::sort(shuffled.begin(), shuffled.end());
+        benchmark::DoNotOptimize(sum);
+        benchmark::DoNotOptimize(shuffled.data());
+        for (int i = 0; i < 4; ++i)
+            loop.on_idle(++now);
+        now += 1000000;
+        message.timestamp = now;
+        message.quantity = 100 + static_cast<int>(now % 50);
+        std::memcpy(bytes, &message, sizeof(message));
+        auto start = std::chrono::high_resolution_clock::now();
+        path.on_message(bytes, sizeof(bytes));
+        auto end = std::chrono::high_resolution_clock::now();
+        state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+    benchmark::DoNotOptimize(sink.bytes);
+    state.counters["warmup_passes"] = loop.warmup_passes();
+}
+
+// circular_array update_order at random prices: 0 = inside the ring (the common case),
+// 1 = every 16th update moves the touch by up to 3 ticks (grow / shift paths).
+// Branches and branch misses per update from perf_event when the machine exposes them.
+static void PriceToIndex_CircularArray(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const int levels = 50;
+    circular_array::LimitOrderBook lob(2, 2 * levels);
+    std::mt19937 generator(50);
+    std::vector<double> prices(4096);
+    std::vector<uint8_t> sides(prices.size());
+    double touch = 100.00;
+    for (size_t i = 0; i < prices.size(); ++i) {
+        if (state.range(0) == 1 && i % 16 == 0)
+            touch += (static_cast<int>(generator() % 7) - 3) * 0.01;
+        sides[i] = generator() % 2;
+        int ticks = static_cast<int>(generator() % levels);
+        prices[i] = std::round((sides[i] ? touch - ticks * 0.01 : touch + 0.01 + ticks * 0.01) * 100) / 100;
+    }
+    for (int i = 0; i < levels; ++i) {
+        lob.update_order(circular_array::Order(0, 100.00 - i * 0.01, 100), true);
+        lob.update_order(circular_array::Order(0, 100.01 + i * 0.01, 100), false);
+    }
+    perf::HardwareCounter branches(PERF_COUNT_HW_BRANCH_INSTRUCTIONS), misses(PERF_COUNT_HW_BRANCH_MISSES);
+    branches.start();
+    misses.start();
+    size_t i = 0;
+    for (auto _ : state) {
+        lob.update_order(circular_array::Order(0, prices[i], 100 + static_cast<int>(i & 63)), sides[i]);
+        i = (i + 1) & (prices.size() - 1);
+    }
+    misses.stop();
+    branches.stop();
+    if (misses.available()) {
+        state.counters["branches"] = benchmark::Counter(branches.read(), benchmark::Counter::kAvgIterations);
+        state.counters["branch_misses"] = benchmark::Counter(misses.read(), benchmark::Counter::kAvgIterations);
+    }
+    else {
+        state.SetLabel("perf_event unavailable");
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Deep books (state.range(0) levels): random delete + re-add somewhere in the book.
+// Templated over the book, so every variant runs exactly the same sequence.
+template <class Book, class BookOrder>
+static void DeleteOrder_DeepBook(benchmark::State& state) {
+    pin_benchmark_thread();
+
+    const int depth = state.range(0);
+    Book lob(2, depth);
+
+    // Initialize the LOB with orders
+    for (int i = 1; i <= depth; ++i) {
+        lob.add_order(BookOrder(i, 10.01 + (i - 1) * 0.01, 100), true);
+    }
+
+    // Random number generator
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> distribution(1, depth);
+
+    for (auto _ : state) {
+        int random_id = distribution(generator);
+        lob.delete_order(BookOrder(random_id, 10.01 + (random_id - 1) * 0.01, 100), true);
+
+        int new_id = distribution(generator);
+        lob.add_order(BookOrder(new_id, 10.01 + (new_id - 1) * 0.01, 100), true);
+    }
+}
+
 
 /*
 BENCHMARK(AddOrder_BinaryTree);
 BENCHMARK(AddOrder_HashtTable);
+BENCHMARK(AddOrder_FlatHashTable);
 BENCHMARK(AddOrder_Queue);
 BENCHMARK(AddOrder_LinkedList);
 BENCHMARK(AddOrder_CircularArray);
+BENCHMARK(AddOrder_SkipList);
 
 BENCHMARK(DeleteOrder_BinaryTree);
 BENCHMARK(DeleteOrder_HashTable);
+BENCHMARK(DeleteOrder_FlatHashTable);
 BENCHMARK(DeleteOrder_Queue);
 BENCHMARK(DeleteOrder_LinkedList);
 BENCHMARK(DeleteOrder_CircularArray);
+BENCHMARK(DeleteOrder_SkipList);
+BENCHMARK(DeleteOrder_DaryHeap);
 
 
 BENCHMARK(GetBestPrice_BinaryTree);
 BENCHMARK(GetBestPrice_HashTable);
+BENCHMARK(GetBestPrice_FlatHashTable);
 BENCHMARK(GetBestPrice_Queue);
 BENCHMARK(GetBestPrice_LinkedList);
 BENCHMARK(GetBestPrice_CircularArray);
+BENCHMARK(GetBestPrice_SkipList);
 */
 
 //BENCHMARK MULTI-THREADING for Circular Array
@@ -782,6 +2230,86 @@ BENCHMARK(BM_LockFreeAddOrderAndGetBestBid)
     ->Args({1000, 10})  // 1000 orders, 10 reader threads
     ->Args({1000, 20});  // 1000 orders, 20 reader threads
 
+// Linked list backed by the node arena: latency + allocations per operation (expected 0)
+BENCHMARK(AddOrder_LinkedList_Allocations);
+BENCHMARK(DeleteOrder_LinkedList_Allocations);
+
+// Deep books: O(depth) list walk vs red-black tree vs skip list
+BENCHMARK_TEMPLATE(DeleteOrder_DeepBook, linked_list::LimitOrderBook, linked_list::Order)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(DeleteOrder_DeepBook, skip_list::LimitOrderBook, skip_list::Order)->Arg(1000)->Arg(10000);
+
+// std::set (cancel scans by id) vs B+tree with the order id index
+BENCHMARK_TEMPLATE(DeleteOrder_DeepBook, binary_tree::LimitOrderBook, binary_tree::Order)->Arg(50)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK_TEMPLATE(DeleteOrder_DeepBook, bplus_tree::LimitOrderBook, bplus_tree::Order)->Arg(50)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// priority_queue rebuilt on every delete vs indexed 4-ary heap
+BENCHMARK_TEMPLATE(DeleteOrder_DeepBook, queue::LimitOrderBook, queue::Order)->Arg(50)->Arg(1000);
+BENCHMARK_TEMPLATE(DeleteOrder_DeepBook, dary_heap::LimitOrderBook, dary_heap::Order)->Arg(50)->Arg(1000);
+
+// Flat open-addressing table keyed by ticks, lowest/highest kept by indexed heaps
+BENCHMARK_TEMPLATE(DeleteOrder_DeepBook, hash_table::FlatLimitOrderBook, hash_table::Order)->Arg(50)->Arg(1000)->Arg(10000);
+
+// Market-by-price depth: top-5/top-10 snapshot, and the full per-tick depth pipeline
+BENCHMARK_TEMPLATE(GetDepth_CircularArray, 5);
+BENCHMARK_TEMPLATE(GetDepth_CircularArray, 10);
+BENCHMARK(PriceToFill_CircularArray);
+
+// Price-time matching (new/cancel/replace, limit/IOC) with the market-by-price view published
+BENCHMARK(MatchingEngine_Throughput);
+
+// OMS execution reports: batched pipeline vs mutex queue + string status, reports/sec per batch size
+BENCHMARK(OmsExecutionReports_Batched)->Arg(1)->Arg(8)->Arg(32)->Arg(128)->Arg(512);
+BENCHMARK(OmsExecutionReports_MutexQueue)->Arg(1)->Arg(32)->Arg(512);
+
+// Position/PnL: dirty-set revalue vs summing all 10k instruments, fills/sec
+BENCHMARK(PositionEngine_Fills)->Arg(0)->Arg(1);
+
+// Portfolio VaR: scalar vs SIMD, one core vs scenario blocks on all cores (target < 1 ms)
+BENCHMARK(RiskKernel_FullRecompute)->Args({0, 0})->Args({1, 0})->Args({1, 1})->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// Risk limit cycle: quiet day vs every instrument in breach (alert storm), cycles/sec
+BENCHMARK(RiskRules_Cycle)->Arg(0)->Arg(1);
+
+// Streaming TCA over a replayed day: events/sec and market time replayed per second
+BENCHMARK(Tca_Replay)->Unit(benchmark::kMillisecond);
+
+// Live venue metrics: report processing cost, and router reads (seqlock vs mutex) under a busy writer
+BENCHMARK(VenueMetrics_Update);
+BENCHMARK(VenueMetrics_Read)->Arg(0)->Arg(1);
+
+// SOR agent state vectors: vector per decision vs batched feature matrix, decisions/sec
+BENCHMARK(FeatureBuilder_Batch)->Arg(0)->Arg(1);
+
+// Native Q-network inference: single state latency and batched throughput, float vs int8
+BENCHMARK(Mlp_Inference)->Args({1, 0})->Args({1, 1})->Args({256, 0})->Args({256, 1});
+
+// Replay memory: batch sampling (deque copy vs prioritised ReplayBuffer) and insertion
+BENCHMARK(Replay_Sample)->Arg(0)->Arg(1);
+BENCHMARK(Replay_Add);
+
+// Environment steps per second: scalar objects vs SoA VectorEnv (scalar / AVX-512 / pool) vs full rollout step
+BENCHMARK(Rollout_Step)->Arg(0)->Arg(1)->Arg(2)->Arg(3)->Arg(4);
+
+// Market data: CSV ingest vs mmap startup (tickers/sec), per-step map + copy vs ids + window views
+BENCHMARK(Ohlcv_Startup)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+BENCHMARK(Ohlcv_Access)->Arg(0)->Arg(1);
+
+// Rolling indicators, ticker-bars/sec: recompute windows vs incremental engine (scalar / AVX-512)
+BENCHMARK(Indicators_Update)->Arg(0)->Arg(1)->Arg(2);
+
+// Environment step cost vs universe size: map portfolio + state copy vs dense book + view
+BENCHMARK(Portfolio_Step)->Args({0, 100})->Args({0, 1000})->Args({0, 5000})->Args({1, 100})->Args({1, 1000})->Args({1, 5000});
+// Backtest replay throughput (1M events over 1 / 16 / 256 instruments)
+BENCHMARK(Backtest_Replay)->Arg(1)->Arg(16)->Arg(256)->Unit(benchmark::kMillisecond);
+// Parameter sweep: fresh backtester per run vs run_sweep
+BENCHMARK(Parameter_Sweep)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+// Queue round trip: same socket vs cross socket
+BENCHMARK(Queue_PingPong)->Arg(0)->Arg(1);
+// First message after idle: without / with warm-up
+BENCHMARK(Warmup_FirstAfterIdle)->Arg(0)->Arg(1)->UseManualTime()->Iterations(2000)->Unit(benchmark::kNanosecond);
+// Ring indexing: prices inside the ring / touch moving
+BENCHMARK(PriceToIndex_CircularArray)->Arg(0)->Arg(1);
+
 
 
 BENCHMARK_MAIN();
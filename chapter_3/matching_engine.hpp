@@ -0,0 +1,307 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "exploring_circular_array.hpp"
+#include "flat_hash_map.hpp"
+
+namespace matching_engine
+{
+
+using circular_array::Order;
+
+enum class OrderType { LIMIT, IOC, FOK };
+enum class ReportType { NEW, FILL, CANCELED, REPLACED, REJECTED };
+
+struct ExecutionReport {
+    ReportType type;
+    int order_id;
+    int contra_id;      // resting order hit by the fill (fills only)
+    double price;       // fill price (the resting level), or the order price
+    int quantity;       // filled quantity, or the order quantity for the other report types
+    int leaves;         // what is left of order_id after this report
+    int contra_leaves;  // what is left of contra_id after the fill
+};
+
+// Reports of the last engine call, stored in a buffer allocated once.
+// One call can generate at most one fill per resting order plus a couple of
+// acks, so "max_orders + 2" slots can never overflow.
+class ExecutionReports {
+private:
+    std::vector<ExecutionReport> reports;
+    int count;
+
+public:
+    ExecutionReports(int capacity) : reports(capacity), count(0) {}
+
+    void clear() { count = 0; }
+    void push(ReportType type, int order_id, int contra_id, double price, int quantity, int leaves, int contra_leaves = 0) {
+        ExecutionReport& r = reports[count++];
+        r.type = type;
+        r.order_id = order_id;
+        r.contra_id = contra_id;
+        r.price = price;
+        r.quantity = quantity;
+        r.leaves = leaves;
+        r.contra_leaves = contra_leaves;
+    }
+
+    int size() const { return count; }
+    const ExecutionReport& operator[](int i) const { return reports[i]; }
+    const ExecutionReport* begin() const { return reports.data(); }
+    const ExecutionReport* end() const { return reports.data() + count; }
+};
+
+// Price-time matching for one instrument, single threaded.
+// - Price levels are FIFO lists of pooled orders, indexed by tick inside a fixed price band
+//   [min_price, min_price + price_levels ticks); orders outside the band are rejected.
+// - An aggressive order walks the opposite side from its best level (the same level the
+//   circular_array book exposes through ptr_offer_ini/ptr_bid_end) and fills in time priority.
+// - Every level change is published, aggregated, into a circular_array::LimitOrderBook so
+//   strategies keep reading the market-by-price view they already use.
+// Nothing allocates after construction: orders, levels, the id index and the report buffer are sized up front.
+class MatchingEngine {
+private:
+    struct RestingOrder {
+        int id;
+        int quantity;
+        int32_t level;
+        int32_t next;
+        int32_t prev;
+        bool is_bid;
+    };
+    struct Level {
+        int32_t head;
+        int32_t tail;
+        int64_t quantity;
+    };
+    static const int32_t NIL = -1;
+
+    circular_array::LimitOrderBook mbp;
+    std::vector<Level> levels[2];       // [0] offers, [1] bids, indexed by tick - base
+    std::vector<RestingOrder> pool;
+    flat_hash::FlatHashMap<int, int32_t> by_id;
+    int32_t free_list;
+    int32_t best[2];                    // best offer (num_levels when empty), best bid (-1 when empty)
+    int64_t base;
+    int num_levels;
+    double step_value;
+    ExecutionReports reports;
+
+    int32_t to_level(double price) const {
+        int64_t level = std::llround(price * step_value) - base;
+        return (level >= 0 && level < num_levels) ? static_cast<int32_t>(level) : NIL;
+    }
+    double to_price(int32_t level) const {
+        return (base + level) / step_value;
+    }
+    bool crosses(bool is_bid, int32_t level) const {
+        return is_bid ? best[0] <= level : best[1] >= level;
+    }
+
+    // Aggregated level -> circular array book (one Order per price, id of the first in queue)
+    void publish(bool is_bid, int32_t level) {
+        const Level& l = levels[is_bid][level];
+        if (l.quantity == 0)
+            mbp.delete_order(Order(0, to_price(level), 0), is_bid);
+        else
+            mbp.update_order(Order(pool[l.head].id, to_price(level), static_cast<int>(l.quantity)), is_bid);
+    }
+
+    // After the best level of a side empties, move to the next non-empty one
+    void advance_best(bool is_bid) {
+        int32_t level = best[is_bid];
+        if (is_bid) {
+            while (level >= 0 && levels[1][level].head == NIL)
+                level--;
+        } else {
+            while (level < num_levels && levels[0][level].head == NIL)
+                level++;
+        }
+        best[is_bid] = level;
+    }
+
+    void unlink(int32_t o) {
+        RestingOrder& order = pool[o];
+        Level& l = levels[order.is_bid][order.level];
+        if (order.prev != NIL) pool[order.prev].next = order.next; else l.head = order.next;
+        if (order.next != NIL) pool[order.next].prev = order.prev; else l.tail = order.prev;
+        l.quantity -= order.quantity;
+        by_id.erase(order.id);
+        order.next = free_list;
+        free_list = o;
+    }
+
+    void remove(int32_t o) {
+        bool is_bid = pool[o].is_bid;
+        int32_t level = pool[o].level;
+        unlink(o);
+        if (level == best[is_bid] && levels[is_bid][level].head == NIL)
+            advance_best(is_bid);
+        publish(is_bid, level);
+    }
+
+    // Visible quantity on the opposite side up to (and including) the limit level, stops once "needed" is reached
+    int64_t available(bool is_bid, int32_t limit, int64_t needed) const {
+        int64_t total = 0;
+        if (is_bid) {
+            for (int32_t level = best[0]; level <= limit && total < needed; level++)
+                total += levels[0][level].quantity;
+        } else {
+            for (int32_t level = best[1]; level >= limit && level >= 0 && total < needed; level--)
+                total += levels[1][level].quantity;
+        }
+        return total;
+    }
+
+    // Fills "quantity" against the opposite side while prices cross, returns the leaves
+    int match(int id, bool is_bid, int32_t limit, int quantity) {
+        bool resting_side = !is_bid;
+        while (quantity > 0 && crosses(is_bid, limit)) {
+            int32_t level = best[resting_side];
+            Level& l = levels[resting_side][level];
+            double price = to_price(level);
+            while (quantity > 0 && l.head != NIL) {
+                int32_t o = l.head;
+                RestingOrder& resting = pool[o];
+                int fill = std::min(quantity, resting.quantity);
+                quantity -= fill;
+                resting.quantity -= fill;
+                l.quantity -= fill;
+                reports.push(ReportType::FILL, id, resting.id, price, fill, quantity, resting.quantity);
+                if (resting.quantity == 0)
+                    unlink(o);
+            }
+            if (l.head == NIL)
+                advance_best(resting_side);
+            publish(resting_side, level);
+        }
+        return quantity;
+    }
+
+    bool rest(int id, bool is_bid, int32_t level, int quantity) {
+        if (free_list == NIL)
+            return false;
+        int32_t o = free_list;
+        free_list = pool[o].next;
+        if (by_id.insert(id, o) == nullptr) {
+            pool[o].next = free_list;
+            free_list = o;
+            return false;
+        }
+        Level& l = levels[is_bid][level];
+        RestingOrder& order = pool[o];
+        order.id = id;
+        order.quantity = quantity;
+        order.level = level;
+        order.is_bid = is_bid;
+        order.next = NIL;
+        order.prev = l.tail;
+        if (l.tail != NIL) pool[l.tail].next = o; else l.head = o;
+        l.tail = o;
+        l.quantity += quantity;
+        if (is_bid ? level > best[1] : level < best[0])
+            best[is_bid] = level;
+        publish(is_bid, level);
+        return true;
+    }
+
+    void enter(int id, bool is_bid, int32_t level, int quantity, OrderType type) {
+        if (type == OrderType::FOK && available(is_bid, level, quantity) < quantity) {
+            reports.push(ReportType::CANCELED, id, 0, to_price(level), quantity, 0);
+            return;
+        }
+        int leaves = match(id, is_bid, level, quantity);
+        if (leaves == 0)
+            return;
+        if (type == OrderType::LIMIT && rest(id, is_bid, level, leaves))
+            reports.push(ReportType::NEW, id, 0, to_price(level), quantity, leaves);
+        else
+            reports.push(ReportType::CANCELED, id, 0, to_price(level), quantity, 0);
+    }
+
+public:
+    // min_price/price_levels: the instrument price band; max_orders: resting orders capacity;
+    // book_depth: depth of the circular array market-by-price view
+    MatchingEngine(int precision, double min_price, int price_levels, int max_orders, int book_depth)
+        : mbp(precision, book_depth), pool(max_orders), by_id(max_orders), free_list(NIL),
+          num_levels(price_levels), reports(max_orders + 2) {
+        step_value = std::pow(10, precision);
+        base = std::llround(min_price * step_value);
+        for (auto& side : levels)
+            side.assign(price_levels, Level{NIL, NIL, 0});
+        for (int32_t i = max_orders - 1; i >= 0; i--) {
+            pool[i].next = free_list;
+            free_list = i;
+        }
+        best[0] = num_levels;
+        best[1] = NIL;
+    }
+
+    // The reports stay valid until the next call
+    const ExecutionReports& new_order(int id, double price, int quantity, bool is_bid, OrderType type = OrderType::LIMIT) {
+        reports.clear();
+        int32_t level = to_level(price);
+        if (level == NIL || quantity <= 0 || by_id.find(id) != nullptr) {
+            reports.push(ReportType::REJECTED, id, 0, price, quantity, 0);
+            return reports;
+        }
+        enter(id, is_bid, level, quantity, type);
+        return reports;
+    }
+
+    const ExecutionReports& cancel_order(int id) {
+        reports.clear();
+        int32_t* found = by_id.find(id);
+        if (found == nullptr) {
+            reports.push(ReportType::REJECTED, id, 0, 0, 0, 0);
+            return reports;
+        }
+        int32_t o = *found;
+        reports.push(ReportType::CANCELED, id, 0, to_price(pool[o].level), pool[o].quantity, 0);
+        remove(o);
+        return reports;
+    }
+
+    // Same price with a smaller quantity keeps time priority; anything else re-enters
+    // the order at the back of the queue and can trade immediately.
+    const ExecutionReports& replace_order(int id, double price, int quantity) {
+        reports.clear();
+        int32_t* found = by_id.find(id);
+        int32_t level = to_level(price);
+        if (found == nullptr || level == NIL || quantity <= 0) {
+            reports.push(ReportType::REJECTED, id, 0, price, quantity, 0);
+            return reports;
+        }
+        int32_t o = *found;
+        RestingOrder& order = pool[o];
+        bool is_bid = order.is_bid;
+        if (level == order.level && quantity <= order.quantity) {
+            levels[is_bid][level].quantity -= order.quantity - quantity;
+            order.quantity = quantity;
+            publish(is_bid, level);
+            reports.push(ReportType::REPLACED, id, 0, price, quantity, quantity);
+            return reports;
+        }
+        remove(o);
+        reports.push(ReportType::REPLACED, id, 0, price, quantity, quantity);
+        enter(id, is_bid, level, quantity, OrderType::LIMIT);
+        return reports;
+    }
+
+    // Market-by-price view of the resting orders
+    circular_array::LimitOrderBook& book() { return mbp; }
+
+    bool has_bids() const { return best[1] != NIL; }
+    bool has_offers() const { return best[0] != num_levels; }
+    double best_bid_price() const { return has_bids() ? to_price(best[1]) : 0; }
+    double best_offer_price() const { return has_offers() ? to_price(best[0]) : 0; }
+    int64_t quantity_at(double price, bool is_bid) const {
+        int32_t level = to_level(price);
+        return level == NIL ? 0 : levels[is_bid][level].quantity;
+    }
+    int resting_orders() const { return static_cast<int>(by_id.size()); }
+};
+
+} // namespace matching_engine
@@ -2,11 +2,7 @@
 #include <string>
 #include <iostream>
 #include "limit_order_book.hpp"
-
-// Include the necessary headers for CPU pinning
-#ifdef __linux__
-#include <sched.h>
-#endif
+#include "thread_placement.hpp"
 
 using namespace std;
 
@@ -21,12 +17,9 @@ public:
         publisher.bind("tcp://*:5556");
     }
 
-    void run() {
-        // Pin the thread to a specific CPU core for better performance
-        cpu_set_t cpuset;
-        CPU_ZERO(&cpuset);
-        CPU_SET(0, &cpuset);  // CPU 0
-        sched_setaffinity(0, sizeof(cpu_set_t), &cpuset);
+    // cpu: the hub's core, ThreadPlacement::cpu_of(placement::HUB); -1 isn't pinned
+    void run(int cpu = -1) {
+        placement::pin_current_thread(cpu);
 
         while (true) {
             if (lob.has_changed()) {
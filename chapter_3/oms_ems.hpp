@@ -5,6 +5,8 @@
 #include <thread>
 #include <mutex>
 #include <zmq.hpp>
+#include "oms_execution_pipeline.hpp"
+#include "thread_placement.hpp"
 
 using namespace std;
 class FIXEngine
@@ -17,6 +19,9 @@ class FIXEngine
 struct Order {
     int id;
     string status;
+    int symbol;
+    int quantity;
+    bool is_buy;
     // Add other order details
 };
 
@@ -49,6 +54,8 @@ private:
     unordered_map<int, Order> activeOrders;
     unordered_map<int, Order> filledOrders;
     UpdatesQueue<Order> orderUpdates;
+    oms_pipeline::ExecutionPipeline executions{65536, 1 << 20, 1024, 256};
+    RMS& rms;
     zmq::context_t context;
     zmq::socket_t subscriber;
     std::thread marketDataThread;
@@ -59,12 +66,12 @@ private:
         return true;
     }
 public:
-    OMS() : context(1), subscriber(context, ZMQ_SUB) {
+    OMS(RMS& rms) : rms(rms), context(1), subscriber(context, ZMQ_SUB) {
         subscriber.connect("tcp://localhost:5556");
         subscriber.setsockopt(ZMQ_SUBSCRIBE, "", 0);
         
     }
-    OMS() : context(1), subscriber(context, ZMQ_SUB) {
+    OMS(RMS& rms) : rms(rms), context(1), subscriber(context, ZMQ_SUB) {
         subscriber.connect("tcp://localhost:5556");
         subscriber.setsockopt(ZMQ_SUBSCRIBE, "", 0);
         
@@ -87,12 +94,9 @@ public:
         }
     }
 
-    void run(){
-        // Pin this thread to the first CPU core
-        cpu_set_t cpuset;
-        CPU_ZERO(&cpuset);
-        CPU_SET(0, &cpuset);
-        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    // cpu: the OMS core, ThreadPlacement::cpu_of(placement::OMS); -1 isn't pinned
+    void run(int cpu = -1){
+        placement::pin_current_thread(cpu);
         while (true){
             ProcessOrderUpdates()
         }
@@ -105,37 +109,22 @@ public:
         
         // If valid, add to active orders and send to EMS
         activeOrders.push_back(order);
+        executions.add_order(order.id, order.symbol, order.quantity, order.is_buy);
+        rms.on_order_sent(order.symbol);
         EMS::SendOrder(order);
 
         return true;
     }
-    void ExecutionReport(const Order& order, const string& status) {
-        // Add order update to queue
-        Order updated_order = order;
-        updated_order.status = status;
-        order_updates.push(updated_order);
+    void ExecutionReport(const oms_pipeline::ExecReport& report) {
+        // Called from the venue session thread: 24 bytes into the SPSC ring, no lock, no Order copy
+        executions.push(report);
     }
     void ProcessOrderUpdates() {
-        // Update order status
-        // If filled, move to filled orders
-        // If cancelled, remove from active orders
-        // Otherwise, leave in active orders
-        while (!order_updates.empty()) {
-            Order order = order_updates.front();
-            order_updates.pop();
-            // Update order status
-            auto it = active_orders.find(order.id);
-            if (it != active_orders.end()) {
-                it->second.status = order.status;
-                if (order.status == "filled") {
-                    // Move to filled orders
-                    filled_orders[it->first] = it->second;
-                    active_orders.erase(it);
-                } else if (order.status == "cancelled") {
-                    // Remove from active orders
-                    active_orders.erase(it);
-                }
-            }
+        // Drain up to 256 reports at once: ids resolved and order records prefetched for the
+        // whole batch, enum state transitions (new/partial/filled/cancelled/rejected) with
+        // cum qty / avg price, filled and cancelled orders released.
+        // The RMS receives the net position change per symbol once per batch.
+        while (executions.process_batch(rms, 256) > 0) {
         }
     }
 
@@ -0,0 +1,239 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include "flat_hash_map.hpp"
+
+namespace oms_pipeline
+{
+
+// INVALID only marks forbidden transitions in the state table, an order never holds it
+enum class OrderStatus : uint8_t { PENDING_NEW, NEW, PARTIALLY_FILLED, FILLED, CANCELLED, REJECTED, INVALID };
+enum class ExecType : uint8_t { NEW, PARTIAL_FILL, FILL, CANCELLED, REJECTED };
+
+// What the venue tells us, 24 bytes: no Order copy, no status string
+struct ExecReport {
+    int32_t order_id;
+    ExecType type;
+    int32_t last_qty;
+    double last_price;
+};
+
+struct OrderRecord {
+    int32_t id;
+    int32_t symbol;
+    int32_t quantity;
+    int32_t cum_qty;
+    double avg_price;
+    bool is_buy;
+    OrderStatus status;
+};
+
+// One leg of a symbol's fills over one batch, what the RMS consumes: consecutive fills of the
+// symbol in the same direction at the same price, so applying the legs in order through the
+// position engine gives the same average cost and realised PnL as applying every fill
+struct PositionDelta {
+    int32_t symbol;
+    int64_t quantity;   // signed, buys positive
+    double notional;    // signed traded value (price * signed qty)
+};
+
+// Single producer (venue session) / single consumer (OMS thread) ring of reports.
+// The consumer takes a whole batch with one acquire load and one release store,
+// instead of a lock + pop per report.
+class ReportQueue {
+private:
+    std::vector<ExecReport> ring;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{0};   // next slot to read
+    alignas(64) std::atomic<size_t> tail{0};   // next slot to write
+
+public:
+    // capacity is rounded up to a power of two
+    ReportQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        ring.resize(size);
+        mask = size - 1;
+    }
+
+    bool push(const ExecReport& report) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == ring.size())
+            return false;
+        ring[t & mask] = report;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Copies up to max reports into out, returns how many
+    size_t pop_batch(ExecReport* out, size_t max) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t available = tail.load(std::memory_order_acquire) - h;
+        size_t n = available < max ? available : max;
+        for (size_t i = 0; i < n; i++)
+            out[i] = ring[(h + i) & mask];
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+};
+
+// Drains the report queue in batches and applies the order state machine.
+// Per batch: 1) prefetch the id index slots, 2) resolve ids and prefetch the order records,
+// 3) apply the transitions and accumulate position deltas, 4) hand all deltas to the RMS in one call.
+// By the time a record is touched in step 3 its cache line is (usually) already on its way.
+class ExecutionPipeline {
+private:
+    ReportQueue queue;
+    std::vector<OrderRecord> records;
+    flat_hash::FlatHashMap<int32_t, int32_t> by_id;
+    std::vector<int32_t> free_records;
+
+    std::vector<ExecReport> batch;
+    std::vector<int32_t> batch_slots;
+    std::vector<PositionDelta> deltas;
+    std::vector<double> leg_price;         // fill price of each leg in deltas
+    std::vector<int32_t> delta_of_symbol;  // symbol -> index of its last leg in deltas for the current batch, -1 if none
+    size_t max_batch;
+
+    size_t rejected_transitions;
+    size_t unknown_orders;
+
+    static constexpr int32_t NONE = -1;
+
+    // Next status for (current status, exec type), INVALID if the report makes no sense in that state.
+    // PARTIAL_FILL/FILL are settled against cum_qty when applied (the venue's exec type is not trusted for that).
+    static OrderStatus next_status(OrderStatus status, ExecType type) {
+        const OrderStatus X = OrderStatus::INVALID;
+        static const OrderStatus table[6][5] = {
+            //                     NEW               PARTIAL_FILL                   FILL                  CANCELLED               REJECTED
+            /* PENDING_NEW */     {OrderStatus::NEW, OrderStatus::PARTIALLY_FILLED, OrderStatus::FILLED, OrderStatus::CANCELLED, OrderStatus::REJECTED},
+            /* NEW */             {OrderStatus::NEW, OrderStatus::PARTIALLY_FILLED, OrderStatus::FILLED, OrderStatus::CANCELLED, X},
+            /* PARTIALLY_FILLED */{X,                OrderStatus::PARTIALLY_FILLED, OrderStatus::FILLED, OrderStatus::CANCELLED, X},
+            /* FILLED */          {X,                X,                             X,                   X,                      X},
+            /* CANCELLED */       {X,                X,                             X,                   X,                      X},
+            /* REJECTED */        {X,                X,                             X,                   X,                      X},
+        };
+        return table[static_cast<int>(status)][static_cast<int>(type)];
+    }
+    static bool is_terminal(OrderStatus status) {
+        return status == OrderStatus::FILLED || status == OrderStatus::CANCELLED || status == OrderStatus::REJECTED;
+    }
+
+    // A fill extends the symbol's last leg if it has the same direction and price, otherwise it
+    // starts a new one (a buy and a sell netted together would lose the PnL realised in between)
+    void add_delta(const OrderRecord& order, int32_t qty, double price) {
+        int32_t& index = delta_of_symbol[order.symbol];
+        int64_t signed_qty = order.is_buy ? qty : -qty;
+        if (index == NONE || (deltas[index].quantity > 0) != order.is_buy || leg_price[index] != price) {
+            index = static_cast<int32_t>(deltas.size());
+            deltas.push_back(PositionDelta{order.symbol, 0, 0});
+            leg_price.push_back(price);
+        }
+        deltas[index].quantity += signed_qty;
+        deltas[index].notional += price * signed_qty;
+    }
+
+    void apply(int32_t slot, const ExecReport& report) {
+        OrderRecord& order = records[slot];
+        OrderStatus status = next_status(order.status, report.type);
+        bool is_fill = report.type == ExecType::PARTIAL_FILL || report.type == ExecType::FILL;
+        // a fill of nothing would make the first average price 0 / 0
+        if (status == OrderStatus::INVALID || (is_fill && report.last_qty <= 0)) {
+            rejected_transitions++;
+            return;
+        }
+        if (is_fill) {
+            int32_t qty = report.last_qty;
+            int32_t cum = order.cum_qty + qty;
+            order.avg_price = (order.avg_price * order.cum_qty + report.last_price * qty) / cum;
+            order.cum_qty = cum;
+            status = cum >= order.quantity ? OrderStatus::FILLED : OrderStatus::PARTIALLY_FILLED;
+            add_delta(order, qty, report.last_price);
+        }
+        order.status = status;
+        if (is_terminal(status)) {
+            by_id.erase(order.id);
+            free_records.push_back(slot);
+        }
+    }
+
+public:
+    // max_orders: live orders; num_symbols: symbols are dense ids [0, num_symbols)
+    ExecutionPipeline(size_t queue_capacity, int max_orders, int num_symbols, size_t max_batch)
+        : queue(queue_capacity), records(max_orders), by_id(max_orders), batch(max_batch), batch_slots(max_batch),
+          delta_of_symbol(num_symbols, NONE), max_batch(max_batch), rejected_transitions(0), unknown_orders(0) {
+        free_records.reserve(max_orders);
+        for (int32_t i = max_orders - 1; i >= 0; i--)
+            free_records.push_back(i);
+        deltas.reserve(max_batch);
+        leg_price.reserve(max_batch);
+    }
+
+    // OMS side: an order sent to the EMS is PENDING_NEW until the venue acks it
+    bool add_order(int32_t id, int32_t symbol, int32_t quantity, bool is_buy) {
+        if (free_records.empty() || by_id.find(id) != nullptr)
+            return false;
+        int32_t slot = free_records.back();
+        if (by_id.insert(id, slot) == nullptr)
+            return false;
+        free_records.pop_back();
+        records[slot] = OrderRecord{id, symbol, quantity, 0, 0, is_buy, OrderStatus::PENDING_NEW};
+        return true;
+    }
+
+    // Venue session thread
+    bool push(const ExecReport& report) {
+        return queue.push(report);
+    }
+
+    // OMS thread: one batch of at most "limit" (<= max_batch) reports.
+    // rms.on_position_deltas(const PositionDelta*, size_t) is called once if the batch traded, with
+    // the legs in fill order.
+    // Returns the number of reports consumed.
+    template <class RiskSink>
+    size_t process_batch(RiskSink& rms, size_t limit) {
+        size_t n = queue.pop_batch(batch.data(), limit < max_batch ? limit : max_batch);
+        if (n == 0)
+            return 0;
+
+        for (size_t i = 0; i < n; i++)
+            by_id.prefetch(batch[i].order_id);
+        for (size_t i = 0; i < n; i++) {
+            int32_t* slot = by_id.find(batch[i].order_id);
+            batch_slots[i] = slot != nullptr ? *slot : NONE;
+            if (slot != nullptr)
+                __builtin_prefetch(&records[*slot], 1, 3);
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            // the slot is re-checked: an earlier report of this batch may have closed the order
+            if (batch_slots[i] == NONE || records[batch_slots[i]].id != batch[i].order_id || is_terminal(records[batch_slots[i]].status)) {
+                unknown_orders++;
+                continue;
+            }
+            apply(batch_slots[i], batch[i]);
+        }
+
+        if (!deltas.empty()) {
+            rms.on_position_deltas(deltas.data(), deltas.size());
+            for (const PositionDelta& d : deltas)
+                delta_of_symbol[d.symbol] = NONE;
+            deltas.clear();
+            leg_price.clear();
+        }
+        return n;
+    }
+
+    const OrderRecord* find(int32_t id) {
+        int32_t* slot = by_id.find(id);
+        return slot != nullptr ? &records[*slot] : nullptr;
+    }
+    size_t live_orders() const { return by_id.size(); }
+    size_t invalid_transitions() const { return rejected_transitions; }
+    size_t reports_for_unknown_orders() const { return unknown_orders; }
+};
+
+} // namespace oms_pipeline
@@ -0,0 +1,233 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/partitioner.h>
+#include <tbb/enumerable_thread_specific.h>
+#include "backtester.hpp"
+
+namespace sweep
+{
+
+using backtest::MarketEvent;
+using backtest::EventStream;
+using backtest::StreamView;
+
+// Event file layout: header, one {first event, count} entry per stream, then every stream's
+// events back to back (64-byte aligned), so a mapped file hands out StreamViews with no copy
+struct EventFileHeader {
+    char magic[8];          // "BTEV01"
+    uint32_t streams;
+    uint32_t event_bytes;   // sizeof(MarketEvent) of the writer
+    uint64_t file_bytes;
+    uint64_t events_offset;
+};
+
+struct StreamEntry {
+    uint64_t first;
+    uint64_t count;
+};
+
+// Market event history mapped read only: every sweep worker reads the same pages
+class EventFile {
+private:
+    void* mapping = nullptr;
+    size_t mapping_bytes = 0;
+    std::vector<StreamView> stream_views;
+
+    EventFile() = default;
+
+public:
+    EventFile(const EventFile&) = delete;
+    EventFile& operator=(const EventFile&) = delete;
+    EventFile(EventFile&& other) noexcept
+        : mapping(other.mapping), mapping_bytes(other.mapping_bytes), stream_views(std::move(other.stream_views)) {
+        other.mapping = nullptr;
+        other.mapping_bytes = 0;
+    }
+    ~EventFile() {
+        if (mapping != nullptr)
+            munmap(mapping, mapping_bytes);
+    }
+
+    static void save(const std::string& path, const std::vector<const EventStream*>& streams) {
+        EventFileHeader h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, "BTEV01", 7);
+        h.streams = static_cast<uint32_t>(streams.size());
+        h.event_bytes = sizeof(MarketEvent);
+        std::vector<StreamEntry> index;
+        uint64_t total = 0;
+        for (const EventStream* s : streams) {
+            index.push_back(StreamEntry{total, s->size()});
+            total += s->size();
+        }
+        h.events_offset = (sizeof(h) + index.size() * sizeof(StreamEntry) + 63) / 64 * 64;
+        h.file_bytes = h.events_offset + total * sizeof(MarketEvent);
+
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (f == nullptr)
+            throw std::runtime_error("Cannot write event file " + path);
+        std::vector<char> padding(h.events_offset - sizeof(h) - index.size() * sizeof(StreamEntry), 0);
+        bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+                  std::fwrite(index.data(), sizeof(StreamEntry), index.size(), f) == index.size() &&
+                  std::fwrite(padding.data(), 1, padding.size(), f) == padding.size();
+        for (const EventStream* s : streams)
+            ok = ok && std::fwrite(s->data(), sizeof(MarketEvent), s->size(), f) == s->size();
+        if (std::fclose(f) != 0 || !ok)
+            throw std::runtime_error("Cannot write event file " + path);
+    }
+
+    static EventFile open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Cannot open event file " + path);
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(EventFileHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Invalid event file " + path);
+        }
+        size_t bytes = static_cast<size_t>(st.st_size);
+        void* map = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED)
+            throw std::runtime_error("Cannot map event file " + path);
+
+        EventFile file;
+        file.mapping = map;
+        file.mapping_bytes = bytes;
+        const char* base = static_cast<const char*>(map);
+        EventFileHeader h;
+        std::memcpy(&h, base, sizeof(h));
+        if (std::memcmp(h.magic, "BTEV01", 7) != 0 || h.event_bytes != sizeof(MarketEvent) || h.file_bytes != bytes ||
+            h.events_offset % 64 != 0 || sizeof(h) + h.streams * sizeof(StreamEntry) > h.events_offset)
+            throw std::runtime_error("Invalid event file " + path);   // file unmaps
+        const MarketEvent* events = reinterpret_cast<const MarketEvent*>(base + h.events_offset);
+        uint64_t total = (bytes - h.events_offset) / sizeof(MarketEvent);
+        for (uint32_t s = 0; s < h.streams; s++) {
+            StreamEntry e;
+            std::memcpy(&e, base + sizeof(h) + s * sizeof(StreamEntry), sizeof(e));
+            if (e.first + e.count > total)
+                throw std::runtime_error("Invalid event file " + path);
+            file.stream_views.push_back(StreamView{events + e.first, e.count});
+        }
+        return file;
+    }
+
+    const std::vector<StreamView>& streams() const { return stream_views; }
+};
+
+// Sweep output, one column per field, one row per parameter set (in grid order)
+enum Column {
+    BUY_BID_ABOVE, BUY_OFFER_BELOW, SELL_OFFER_ABOVE, SELL_BID_BELOW, EDGE, QUANTITY,
+    REALIZED, UNREALIZED, MAX_DRAWDOWN, FILLS, REJECTED, EVENTS,
+    NUM_COLUMNS
+};
+
+class SweepResults {
+private:
+    size_t num_runs;
+    std::vector<double> values;     // column major: values[column * runs + run]
+
+public:
+    SweepResults(size_t runs = 0) : num_runs(runs), values(runs * NUM_COLUMNS, 0.0) {}
+
+    size_t runs() const { return num_runs; }
+    double* column(Column c) { return &values[c * num_runs]; }
+    const double* column(Column c) const { return &values[c * num_runs]; }
+    double& at(Column c, size_t run) { return values[c * num_runs + run]; }
+    double at(Column c, size_t run) const { return values[c * num_runs + run]; }
+
+    // "SWEEP01", runs, columns, then the columns
+    void save(const std::string& path) const {
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (f == nullptr)
+            throw std::runtime_error("Cannot write sweep results " + path);
+        char magic[8] = "SWEEP01";
+        uint64_t shape[2] = {num_runs, NUM_COLUMNS};
+        bool ok = std::fwrite(magic, 8, 1, f) == 1 && std::fwrite(shape, sizeof(shape), 1, f) == 1 &&
+                  std::fwrite(values.data(), sizeof(double), values.size(), f) == values.size();
+        if (std::fclose(f) != 0 || !ok)
+            throw std::runtime_error("Cannot write sweep results " + path);
+    }
+
+    static SweepResults load(const std::string& path) {
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (f == nullptr)
+            throw std::runtime_error("Cannot open sweep results " + path);
+        char magic[8];
+        uint64_t shape[2];
+        bool ok = std::fread(magic, 8, 1, f) == 1 && std::fread(shape, sizeof(shape), 1, f) == 1 &&
+                  std::memcmp(magic, "SWEEP01", 8) == 0 && shape[1] == NUM_COLUMNS;
+        SweepResults results(ok ? shape[0] : 0);
+        ok = ok && std::fread(results.values.data(), sizeof(double), results.values.size(), f) == results.values.size();
+        std::fclose(f);
+        if (!ok)
+            throw std::runtime_error("Invalid sweep results " + path);
+        return results;
+    }
+};
+
+// Largest peak to trough fall of realised + unrealised PnL over the sampled series
+inline double max_drawdown(const std::vector<backtest::PnlPoint>& pnl) {
+    double peak = 0, drawdown = 0;
+    for (const backtest::PnlPoint& p : pnl) {
+        double total = p.realized + p.unrealized;
+        peak = std::max(peak, total);
+        drawdown = std::max(drawdown, peak - total);
+    }
+    return drawdown;
+}
+
+// One backtest per StrategyParams over the same streams (typically an EventFile's). TBB's
+// work-stealing scheduler hands out single runs (grain 1), so long and short runs balance
+// across threads. Every worker thread builds its own Backtester (books, venues, position
+// engine) on first use and resets it between runs, so after warm-up a run allocates nothing
+// but its result series, and workers share only the read-only event data.
+inline SweepResults run_sweep(const std::vector<StreamView>& streams, const std::vector<strategy::StrategyParams>& grid,
+                              const backtest::BacktestConfig& config) {
+    using Backtester = backtest::Backtester<strategy::StrategyModule>;
+    SweepResults results(grid.size());
+    tbb::enumerable_thread_specific<std::unique_ptr<Backtester>> workspaces;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, grid.size(), 1), [&](const tbb::blocked_range<size_t>& range) {
+        std::unique_ptr<Backtester>& backtester = workspaces.local();
+        if (!backtester)
+            backtester.reset(new Backtester(streams.size(), config, [](circular_array::LimitOrderBook& book, strategy::OrderGateway& gateway) {
+                return strategy::StrategyModule(book, gateway);
+            }));
+        for (size_t run = range.begin(); run != range.end(); ++run) {
+            const strategy::StrategyParams& p = grid[run];
+            backtester->reset();
+            for (size_t i = 0; i < backtester->size(); i++)
+                backtester->strategy(static_cast<int32_t>(i)).reset(p);
+            backtest::BacktestResult r = backtester->run(streams);
+            results.at(BUY_BID_ABOVE, run) = p.buy_bid_above;
+            results.at(BUY_OFFER_BELOW, run) = p.buy_offer_below;
+            results.at(SELL_OFFER_ABOVE, run) = p.sell_offer_above;
+            results.at(SELL_BID_BELOW, run) = p.sell_bid_below;
+            results.at(EDGE, run) = p.edge;
+            results.at(QUANTITY, run) = p.quantity;
+            results.at(REALIZED, run) = r.pnl.back().realized;
+            results.at(UNREALIZED, run) = r.pnl.back().unrealized;
+            results.at(MAX_DRAWDOWN, run) = max_drawdown(r.pnl);
+            results.at(FILLS, run) = static_cast<double>(r.fills);
+            results.at(REJECTED, run) = r.rejected_orders;
+            results.at(EVENTS, run) = static_cast<double>(r.events);
+        }
+    }, tbb::simple_partitioner());
+    return results;
+}
+
+} // namespace sweep
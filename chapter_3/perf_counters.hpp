@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace perf
+{
+
+// One hardware counter of the calling thread (user space only) through perf_event_open, e.g.
+// branch misses around a benchmark loop. Not available in most VMs / containers (no PMU, or
+// perf_event_paranoid): available() is false and read() returns 0.
+class HardwareCounter {
+private:
+    int fd;
+
+public:
+    explicit HardwareCounter(uint64_t event = PERF_COUNT_HW_BRANCH_MISSES) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = event;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    HardwareCounter(const HardwareCounter&) = delete;
+    HardwareCounter& operator=(const HardwareCounter&) = delete;
+    ~HardwareCounter() {
+        if (fd >= 0)
+            close(fd);
+    }
+
+    bool available() const { return fd >= 0; }
+    void start() {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    void stop() {
+        if (fd >= 0)
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+    uint64_t read() const {
+        uint64_t value = 0;
+        if (fd < 0 || ::read(fd, &value, sizeof(value)) != sizeof(value))
+            return 0;
+        return value;
+    }
+};
+
+} // namespace perf
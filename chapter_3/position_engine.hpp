@@ -0,0 +1,144 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <algorithm>
+#include "oms_execution_pipeline.hpp"
+
+namespace position_engine
+{
+
+// Everything a fill or a quote touches for one instrument sits in one cache line
+struct alignas(64) InstrumentPnl {
+    int64_t position;
+    double avg_cost;
+    double realized;
+    double unrealized;   // position * (mark - avg_cost), as of the last revalue()
+    double mark;         // mid of the last BBO (the first fill's price until there is one)
+    double exposure;     // |position| * mark, as of the last revalue()
+};
+
+struct PortfolioTotals {
+    double realized;
+    double unrealized;
+    double gross_exposure;
+};
+
+// Incremental position / PnL for a set of instruments (dense ids [0, num_instruments)).
+// - on_fill: O(1) update of position, average cost and realised PnL
+// - on_bbo: new mark; the instrument goes into a dirty set (deduplicated with a flag per instrument)
+// - revalue: recomputes unrealised PnL only for dirty instruments and moves the portfolio
+//   totals by the difference, so totals are never summed over the whole book
+class PositionEngine {
+private:
+    std::vector<InstrumentPnl> instruments;
+    std::vector<int32_t> dirty;
+    std::vector<uint8_t> is_dirty;
+    PortfolioTotals totals;
+
+    void mark_dirty(int32_t instrument) {
+        if (!is_dirty[instrument]) {
+            is_dirty[instrument] = 1;
+            dirty.push_back(instrument);
+        }
+    }
+
+public:
+    PositionEngine(int num_instruments)
+        : instruments(num_instruments, InstrumentPnl{0, 0, 0, 0, 0, 0}), is_dirty(num_instruments, 0), totals{0, 0, 0} {
+        dirty.reserve(num_instruments);
+    }
+
+    // quantity is signed: buys positive, sells negative
+    void on_fill(int32_t instrument, int64_t quantity, double price) {
+        if (quantity == 0)
+            return;
+        InstrumentPnl& p = instruments[instrument];
+        if (p.mark == 0)
+            p.mark = price;   // no BBO yet: an unmarked position would value at -position * avg_cost
+        int64_t position = p.position;
+        if (position == 0 || (position > 0) == (quantity > 0)) {
+            // opening or adding: average cost moves, nothing realised
+            int64_t new_position = position + quantity;
+            p.avg_cost = (p.avg_cost * std::llabs(position) + price * std::llabs(quantity)) / std::llabs(new_position);
+            p.position = new_position;
+        }
+        else {
+            // reducing, closing or flipping: the closed part realises against the average cost
+            int64_t closed = std::min(std::llabs(quantity), std::llabs(position));
+            double pnl = (price - p.avg_cost) * (position > 0 ? closed : -closed);
+            p.realized += pnl;
+            totals.realized += pnl;
+            p.position = position + quantity;
+            if (p.position == 0)
+                p.avg_cost = 0;
+            else if ((p.position > 0) != (position > 0))
+                p.avg_cost = price;   // flipped, the remainder is a new position opened at this price
+        }
+        mark_dirty(instrument);
+    }
+
+    // Book update stream: only a changed mark makes the instrument dirty
+    void on_bbo(int32_t instrument, double bid, double ask) {
+        double mid = (bid + ask) * 0.5;
+        InstrumentPnl& p = instruments[instrument];
+        if (mid != p.mark) {
+            p.mark = mid;
+            mark_dirty(instrument);
+        }
+    }
+
+    // OMS batches: legs of same-direction, same-price fills, applied in order as one fill each
+    void on_position_deltas(const oms_pipeline::PositionDelta* deltas, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            const oms_pipeline::PositionDelta& d = deltas[i];
+            if (d.quantity != 0)
+                on_fill(d.symbol, d.quantity, d.notional / static_cast<double>(d.quantity));
+        }
+    }
+
+    // Recomputes unrealised PnL / exposure of the dirty instruments, returns how many
+    size_t revalue() {
+        size_t n = dirty.size();
+        for (int32_t instrument : dirty) {
+            InstrumentPnl& p = instruments[instrument];
+            double unrealized = p.position == 0 ? 0 : p.position * (p.mark - p.avg_cost);
+            double exposure = std::llabs(p.position) * p.mark;
+            totals.unrealized += unrealized - p.unrealized;
+            totals.gross_exposure += exposure - p.exposure;
+            p.unrealized = unrealized;
+            p.exposure = exposure;
+            is_dirty[instrument] = 0;
+        }
+        dirty.clear();
+        return n;
+    }
+
+    // Incremental totals accumulate floating point error over a long session; this re-sums them
+    // from the instruments (O(instruments), meant for off the hot path, e.g. a timer or end of day)
+    void resync() {
+        revalue();
+        totals = PortfolioTotals{0, 0, 0};
+        for (const InstrumentPnl& p : instruments) {
+            totals.realized += p.realized;
+            totals.unrealized += p.unrealized;
+            totals.gross_exposure += p.exposure;
+        }
+    }
+
+    // Flat book, no PnL (e.g. between backtest runs)
+    void clear() {
+        std::fill(instruments.begin(), instruments.end(), InstrumentPnl{0, 0, 0, 0, 0, 0});
+        std::fill(is_dirty.begin(), is_dirty.end(), 0);
+        dirty.clear();
+        totals = PortfolioTotals{0, 0, 0};
+    }
+
+    const InstrumentPnl& instrument(int32_t id) const { return instruments[id]; }
+    const PortfolioTotals& portfolio() const { return totals; }
+    size_t pending_revalue() const { return dirty.size(); }
+    int size() const { return static_cast<int>(instruments.size()); }
+};
+
+} // namespace position_engine
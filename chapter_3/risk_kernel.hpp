@@ -0,0 +1,154 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+namespace risk_kernel
+{
+
+// Instruments are padded to a multiple of 16 floats (zero delta/gamma), so the SIMD loops
+// never need a remainder (the AVX2 kernel steps 8 at a time).
+const int PAD = 16;
+const int SCENARIO_BLOCK = 32;   // scenarios per parallel task
+
+// Delta-gamma PnL of scenarios [s_begin, s_end):
+//   pnl[s] = sum_i delta[i] * r[s][i] + 0.5 * gamma[i] * r[s][i]^2
+// Portable version, also the reference for the SIMD kernels.
+inline void scenario_pnl_scalar(const float* delta, const float* half_gamma, const float* shocks, size_t stride,
+                                int instruments, int s_begin, int s_end, double* pnl) {
+    for (int s = s_begin; s < s_end; s++) {
+        const float* r = shocks + s * stride;
+        double sum = 0;
+        for (int i = 0; i < instruments; i++)
+            sum += r[i] * (delta[i] + half_gamma[i] * r[i]);
+        pnl[s] = sum;
+    }
+}
+
+#if defined(__AVX2__)
+inline double horizontal_sum(__m256d v) {
+    __m128d x = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(x, _mm_unpackhi_pd(x, x)));
+}
+#endif
+
+// Same computation, 4 scenarios at a time: delta/gamma are loaded once per 4 scenario rows,
+// each row gets its own accumulators, so the chains are independent. Each instrument's term
+// is computed in float as in the scalar loop, then widened and summed in double: a row's PnL
+// has the reference's precision whatever the number of instruments, and a scenario gets the
+// same precision in a 4-row block as in the scalar tail.
+// AVX-512 builds use this kernel too: the double accumulators hold 4 lanes per 256-bit
+// register either way, and GCC 12 warns (-Wmaybe-uninitialized) on the 512-bit widening intrinsics.
+inline void scenario_pnl_simd(const float* delta, const float* half_gamma, const float* shocks, size_t stride,
+                              int instruments, int s_begin, int s_end, double* pnl) {
+#if defined(__AVX2__) && defined(__FMA__)
+    int s = s_begin;
+    for (; s + 4 <= s_end; s += 4) {
+        const float* r[4] = {shocks + s * stride, shocks + (s + 1) * stride, shocks + (s + 2) * stride, shocks + (s + 3) * stride};
+        __m256d lo[4], hi[4];
+        for (int k = 0; k < 4; k++)
+            lo[k] = hi[k] = _mm256_setzero_pd();
+        for (int i = 0; i < instruments; i += 8) {
+            __m256 d = _mm256_loadu_ps(delta + i);
+            __m256 g = _mm256_loadu_ps(half_gamma + i);
+            for (int k = 0; k < 4; k++) {
+                __m256 x = _mm256_loadu_ps(r[k] + i);
+                __m256 term = _mm256_mul_ps(x, _mm256_fmadd_ps(g, x, d));
+                lo[k] = _mm256_add_pd(lo[k], _mm256_cvtps_pd(_mm256_castps256_ps128(term)));
+                hi[k] = _mm256_add_pd(hi[k], _mm256_cvtps_pd(_mm256_extractf128_ps(term, 1)));
+            }
+        }
+        for (int k = 0; k < 4; k++)
+            pnl[s + k] = horizontal_sum(_mm256_add_pd(lo[k], hi[k]));
+    }
+    scenario_pnl_scalar(delta, half_gamma, shocks, stride, instruments, s, s_end, pnl);
+#else
+    scenario_pnl_scalar(delta, half_gamma, shocks, stride, instruments, s_begin, s_end, pnl);
+#endif
+}
+
+struct RiskReport {
+    double var;                 // loss not exceeded with the given confidence (positive = loss)
+    double expected_shortfall;  // average loss beyond the VaR
+    double worst_pnl;
+    int worst_scenario;
+    double total_delta;
+    double total_gamma;
+};
+
+// Portfolio sensitivities (SoA) and a matrix of scenario shocks (one row of returns per scenario).
+// evaluate() recomputes the PnL of every scenario; scenario blocks run in parallel on the TBB pool.
+class PortfolioRisk {
+private:
+    int instruments;
+    int scenarios;
+    size_t stride;
+    std::vector<float> delta;        // PnL per unit return (position value)
+    std::vector<float> half_gamma;   // 0.5 * second order sensitivity, pre-halved for the kernel
+    std::vector<float> shocks;       // scenarios x stride
+    std::vector<double> pnl;
+    std::vector<double> sorted;      // scratch for the quantile
+
+public:
+    PortfolioRisk(int instruments, int scenarios)
+        : instruments(instruments), scenarios(scenarios),
+          stride((instruments + PAD - 1) / PAD * PAD),
+          delta(stride, 0), half_gamma(stride, 0), shocks(stride * scenarios, 0),
+          pnl(scenarios, 0), sorted(scenarios, 0) {}
+
+    void set_sensitivity(int instrument, double d, double gamma) {
+        delta[instrument] = static_cast<float>(d);
+        half_gamma[instrument] = static_cast<float>(0.5 * gamma);
+    }
+    // Row of "instruments" returns for one scenario (historical day, stress shock...)
+    float* scenario(int s) { return shocks.data() + s * stride; }
+
+    void evaluate(bool vectorised = true, bool parallel = true) {
+        auto run = [&](int begin, int end) {
+            if (vectorised)
+                scenario_pnl_simd(delta.data(), half_gamma.data(), shocks.data(), stride, static_cast<int>(stride), begin, end, pnl.data());
+            else
+                scenario_pnl_scalar(delta.data(), half_gamma.data(), shocks.data(), stride, instruments, begin, end, pnl.data());
+        };
+        if (parallel)
+            tbb::parallel_for(tbb::blocked_range<int>(0, scenarios, SCENARIO_BLOCK),
+                              [&](const tbb::blocked_range<int>& block) { run(block.begin(), block.end()); });
+        else
+            run(0, scenarios);
+    }
+
+    // From the last evaluate(): historical-simulation VaR / ES at "confidence" (e.g. 0.99)
+    RiskReport report(double confidence) {
+        RiskReport r{0, 0, 0, 0, 0, 0};
+        std::copy(pnl.begin(), pnl.end(), sorted.begin());
+        int tail = std::max(1, static_cast<int>((1.0 - confidence) * scenarios));
+        std::nth_element(sorted.begin(), sorted.begin() + (tail - 1), sorted.end());
+        double threshold = sorted[tail - 1];
+        double tail_sum = 0;
+        for (int i = 0; i < tail; i++)
+            tail_sum += sorted[i];   // nth_element left the "tail" worst scenarios in front
+        r.var = -threshold;
+        r.expected_shortfall = -tail_sum / tail;
+
+        int worst = static_cast<int>(std::min_element(pnl.begin(), pnl.end()) - pnl.begin());
+        r.worst_pnl = pnl[worst];
+        r.worst_scenario = worst;
+        for (int i = 0; i < instruments; i++) {
+            r.total_delta += delta[i];
+            r.total_gamma += 2.0 * half_gamma[i];
+        }
+        return r;
+    }
+
+    double scenario_pnl(int s) const { return pnl[s]; }
+    int num_scenarios() const { return scenarios; }
+    int num_instruments() const { return instruments; }
+};
+
+} // namespace risk_kernel
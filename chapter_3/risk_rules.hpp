@@ -0,0 +1,271 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "position_engine.hpp"
+
+namespace risk_rules
+{
+
+enum class RuleKind : uint8_t { DRAWDOWN, EXPOSURE, CONCENTRATION, ORDER_RATE };
+
+// Scope of a rule: one instrument id, every instrument, or the portfolio totals
+const int32_t ALL_INSTRUMENTS = -1;
+const int32_t PORTFOLIO = -2;
+
+// What the risk desk configures. A rule is breached when its value goes above the threshold:
+//   DRAWDOWN       peak PnL - current PnL (realised + unrealised), peak since start of day
+//   EXPOSURE       |position| * mark (gross exposure for the portfolio)
+//   CONCENTRATION  instrument exposure / portfolio gross exposure (instrument scopes only)
+//   ORDER_RATE     orders sent in the current window
+struct RuleSpec {
+    int32_t id;
+    RuleKind kind;
+    int32_t instrument;
+    double threshold;
+};
+
+struct Alert {
+    uint64_t time_ns;
+    int32_t rule;
+    int32_t instrument;   // PORTFOLIO for portfolio rules
+    RuleKind kind;
+    double value;
+    double threshold;
+};
+
+// Single producer (risk monitor) / single consumer (alert sender) ring.
+// push never waits: a full ring drops the alert and the caller counts it.
+class AlertQueue {
+private:
+    std::vector<Alert> ring;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{0};   // next slot to read
+    alignas(64) std::atomic<size_t> tail{0};   // next slot to write
+
+public:
+    // capacity is rounded up to a power of two
+    AlertQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        ring.resize(size);
+        mask = size - 1;
+    }
+
+    bool push(const Alert& alert) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == ring.size())
+            return false;
+        ring[t & mask] = alert;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(Alert& alert) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        alert = ring[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+struct AlertLimits {
+    size_t queue_capacity;
+    uint64_t repeat_ns;      // a rule still in breach is re-sent after this long
+    double burst;            // token bucket: alerts that can go out back to back
+    double per_second;       // token bucket: sustained alerts per second
+    uint64_t order_window_ns;
+};
+
+// Limit rules compiled at load time into a flat array of checks, grouped per instrument
+// (CSR layout: the checks of instrument i are checks[first_check[i] .. first_check[i + 1])).
+// A cycle only evaluates the instruments touched since the previous cycle (fill, mark, order),
+// plus the few portfolio checks. Alerts are de-duplicated per check (sent when the breach starts,
+// then at most every repeat_ns while it lasts) and rate limited by a token bucket. An alert without
+// a token is counted as suppressed and handled like a sent one: nothing is retried, so a cycle costs
+// the same during an alert storm, and a breach that lasts comes back after repeat_ns.
+class RuleEngine {
+private:
+    struct Check {
+        RuleKind kind;
+        int32_t rule;
+        double threshold;
+    };
+    struct CheckState {
+        bool breached;
+        uint64_t last_sent;
+    };
+
+    std::vector<Check> checks;
+    std::vector<CheckState> check_state;
+    std::vector<int32_t> first_check;
+    std::vector<Check> portfolio_checks;
+    std::vector<CheckState> portfolio_state;
+
+    std::vector<int32_t> touched;
+    std::vector<uint8_t> is_touched;
+
+    std::vector<double> peak_pnl;
+    double portfolio_peak;
+    std::vector<uint32_t> orders;
+    std::vector<uint64_t> order_window;
+    uint32_t portfolio_orders;
+    uint64_t portfolio_window;
+
+    AlertQueue queue;
+    AlertLimits limits;
+    double tokens;
+    uint64_t last_refill;
+
+    size_t suppressed;
+    size_t dropped;
+
+    bool take_token(uint64_t now) {
+        tokens = std::min(limits.burst, tokens + (now - last_refill) * 1e-9 * limits.per_second);
+        last_refill = now;
+        if (tokens < 1.0)
+            return false;
+        tokens -= 1.0;
+        return true;
+    }
+
+    void check(const Check& c, CheckState& s, int32_t instrument, double value, uint64_t now) {
+        if (value <= c.threshold) {
+            s.breached = false;
+            return;
+        }
+        if (s.breached && now - s.last_sent < limits.repeat_ns)
+            return;
+        if (!take_token(now))
+            suppressed++;
+        else if (!queue.push(Alert{now, c.rule, instrument, c.kind, value, c.threshold}))
+            dropped++;
+        s.breached = true;
+        s.last_sent = now;
+    }
+
+    uint32_t orders_in_window(int32_t instrument, uint64_t now) const {
+        return order_window[instrument] == now / limits.order_window_ns ? orders[instrument] : 0;
+    }
+
+public:
+    RuleEngine(int num_instruments, const std::vector<RuleSpec>& rules, const AlertLimits& limits)
+        : first_check(num_instruments + 1, 0), is_touched(num_instruments, 0), peak_pnl(num_instruments, 0),
+          portfolio_peak(0), orders(num_instruments, 0), order_window(num_instruments, 0), portfolio_orders(0),
+          portfolio_window(0), queue(limits.queue_capacity), limits(limits), tokens(limits.burst), last_refill(0),
+          suppressed(0), dropped(0) {
+        // count the checks per instrument, then lay them out contiguously
+        for (const RuleSpec& r : rules) {
+            if (r.instrument == PORTFOLIO) {
+                if (r.kind == RuleKind::CONCENTRATION)
+                    throw "Concentration rules need an instrument scope";
+                portfolio_checks.push_back(Check{r.kind, r.id, r.threshold});
+            }
+            else if (r.instrument == ALL_INSTRUMENTS) {
+                for (int i = 0; i < num_instruments; i++)
+                    first_check[i + 1]++;
+            }
+            else if (r.instrument >= 0 && r.instrument < num_instruments) {
+                first_check[r.instrument + 1]++;
+            }
+            else {
+                throw "Rule instrument out of range";
+            }
+        }
+        for (int i = 0; i < num_instruments; i++)
+            first_check[i + 1] += first_check[i];
+        checks.resize(first_check[num_instruments]);
+        std::vector<int32_t> next(first_check.begin(), first_check.end() - 1);
+        for (const RuleSpec& r : rules) {
+            if (r.instrument == ALL_INSTRUMENTS) {
+                for (int i = 0; i < num_instruments; i++)
+                    checks[next[i]++] = Check{r.kind, r.id, r.threshold};
+            }
+            else if (r.instrument >= 0) {
+                checks[next[r.instrument]++] = Check{r.kind, r.id, r.threshold};
+            }
+        }
+        check_state.assign(checks.size(), CheckState{false, 0});
+        portfolio_state.assign(portfolio_checks.size(), CheckState{false, 0});
+        touched.reserve(num_instruments);
+    }
+
+    // Something changed for this instrument (fill, mark): its checks run next cycle
+    void touch(int32_t instrument) {
+        if (!is_touched[instrument]) {
+            is_touched[instrument] = 1;
+            touched.push_back(instrument);
+        }
+    }
+
+    // An order was sent, counts towards the order rate rules
+    void on_order(int32_t instrument, uint64_t now) {
+        uint64_t window = now / limits.order_window_ns;
+        if (order_window[instrument] != window) {
+            order_window[instrument] = window;
+            orders[instrument] = 0;
+        }
+        orders[instrument]++;
+        if (portfolio_window != window) {
+            portfolio_window = window;
+            portfolio_orders = 0;
+        }
+        portfolio_orders++;
+        touch(instrument);
+    }
+
+    // One monitoring cycle, after positions.revalue(). Returns the number of instruments checked.
+    size_t evaluate(const position_engine::PositionEngine& positions, uint64_t now) {
+        const position_engine::PortfolioTotals& totals = positions.portfolio();
+        double gross = totals.gross_exposure;
+
+        for (int32_t instrument : touched) {
+            is_touched[instrument] = 0;
+            const position_engine::InstrumentPnl& p = positions.instrument(instrument);
+            double pnl = p.realized + p.unrealized;
+            peak_pnl[instrument] = std::max(peak_pnl[instrument], pnl);
+            for (int32_t c = first_check[instrument]; c < first_check[instrument + 1]; c++) {
+                double value;
+                switch (checks[c].kind) {
+                case RuleKind::DRAWDOWN:      value = peak_pnl[instrument] - pnl; break;
+                case RuleKind::EXPOSURE:      value = p.exposure; break;
+                case RuleKind::CONCENTRATION: value = gross > 0 ? p.exposure / gross : 0; break;
+                case RuleKind::ORDER_RATE:    value = orders_in_window(instrument, now); break;
+                default:                      value = 0; break;
+                }
+                check(checks[c], check_state[c], instrument, value, now);
+            }
+        }
+        size_t n = touched.size();
+        touched.clear();
+
+        double pnl = totals.realized + totals.unrealized;
+        portfolio_peak = std::max(portfolio_peak, pnl);
+        for (size_t c = 0; c < portfolio_checks.size(); c++) {
+            double value;
+            switch (portfolio_checks[c].kind) {
+            case RuleKind::DRAWDOWN:   value = portfolio_peak - pnl; break;
+            case RuleKind::EXPOSURE:   value = gross; break;
+            case RuleKind::ORDER_RATE: value = portfolio_window == now / limits.order_window_ns ? portfolio_orders : 0; break;
+            default:                   value = 0; break;
+            }
+            check(portfolio_checks[c], portfolio_state[c], PORTFOLIO, value, now);
+        }
+        return n;
+    }
+
+    // Alert sender thread
+    bool next_alert(Alert& alert) { return queue.pop(alert); }
+
+    size_t pending_checks() const { return touched.size(); }
+    size_t num_checks() const { return checks.size() + portfolio_checks.size(); }
+    size_t suppressed_alerts() const { return suppressed; }   // rate limited
+    size_t dropped_alerts() const { return dropped; }         // queue full, sender not keeping up
+};
+
+} // namespace risk_rules
@@ -4,7 +4,13 @@
 #include <queue>
 #include <thread>
 #include <mutex>
+#include <chrono>
 #include <zmq.hpp>
+#include "oms_execution_pipeline.hpp"
+#include "position_engine.hpp"
+#include "risk_kernel.hpp"
+#include "risk_rules.hpp"
+#include "tca.hpp"
 
 using namespace std;
 
@@ -12,12 +18,15 @@ class MarketData {
     // Market data class
 };
 
-class Position {
-    // Position data class
-};
+// Per-instrument position / PnL lives in position_engine::InstrumentPnl
+using Position = position_engine::InstrumentPnl;
 
 class RiskMetrics {
-    // Risk metrics class
+public:
+    double realized_pnl = 0;
+    double unrealized_pnl = 0;
+    double gross_exposure = 0;
+    risk_kernel::RiskReport var99{};
 };
 
 class Order {
@@ -30,11 +39,21 @@ private:
     zmq::socket_t subscriber;
     std::thread marketDataThread;
     std::vector<MarketData> marketData;
-    std::vector<Position> positions;
+    position_engine::PositionEngine positions{10000};
+    risk_kernel::PortfolioRisk scenarioRisk{10000, 1000};   // 1000 historical scenarios, rows loaded at start of day
+    risk_rules::RuleEngine rules;
+    tca::TcaEngine tca{10000, 16, 1 << 16};   // 16 venues, up to 64k fills waiting for their 60s markout
     RiskMetrics riskMetrics;
 
+    static uint64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
 public:
-    RMS() : context(1), subscriber(context, ZMQ_SUB) {
+    // Limits are compiled once here; alerts: 16 back to back, 100/s sustained, a breach re-sent every 5s
+    RMS(const std::vector<risk_rules::RuleSpec>& limits = {})
+        : context(1), subscriber(context, ZMQ_SUB),
+          rules(10000, limits, risk_rules::AlertLimits{4096, 5000000000ull, 16, 100, 1000000000ull}) {
         subscriber.connect("tcp://localhost:5556");
         subscriber.setsockopt(ZMQ_SUBSCRIBE, "", 0);
         marketDataThread = std::thread(&RMS::ReceiveMarketData, this);
@@ -61,9 +80,43 @@ public:
         // ...
     }
 
+    void on_position_deltas(const oms_pipeline::PositionDelta* deltas, size_t count) {
+        // Net fills per symbol from one OMS execution batch
+        positions.on_position_deltas(deltas, count);
+        for (size_t i = 0; i < count; i++)
+            rules.touch(deltas[i].symbol);
+    }
+
+    void on_bbo(int instrument, double bid, double ask) {
+        // Book update stream: marks the instrument dirty if its mid moved
+        uint64_t now = now_ns();
+        positions.on_bbo(instrument, bid, ask);
+        rules.touch(instrument);
+        tca.on_book(instrument, now, bid, ask);
+    }
+
+    void on_order_sent(int instrument) {
+        // Order rate limits
+        rules.on_order(instrument, now_ns());
+    }
+
+    void on_venue_event(int venue, tca::OrderEvent event) {
+        // Order sent / rejected / cancelled at a venue, for the venue fill statistics
+        tca.on_order(venue, now_ns(), event);
+    }
+
+    void on_trade(const tca::Fill& fill) {
+        // Every execution with its venue, for the transaction cost analysis
+        tca.on_fill(fill);
+    }
+
     void CalculateRiskMetrics() {
-        // Calculate risk metrics
-        // ...
+        // Calculate risk metrics: revalue what moved since the last cycle, read the running totals
+        positions.revalue();
+        const position_engine::PortfolioTotals& totals = positions.portfolio();
+        riskMetrics.realized_pnl = totals.realized;
+        riskMetrics.unrealized_pnl = totals.unrealized;
+        riskMetrics.gross_exposure = totals.gross_exposure;
     }
 
     bool ValidateOrder(const Order& order) {
@@ -74,26 +127,55 @@ public:
 
     void AssessPortfolioRisk(const Order& order) {
         // Assess portfolio risk
-        // ...
+        // Current positions as delta sensitivities (position value; linear instruments have no gamma),
+        // then every scenario is re-priced: SIMD kernel, scenario blocks spread over the cores
+        for (int i = 0; i < positions.size(); i++) {
+            const Position& p = positions.instrument(i);
+            scenarioRisk.set_sensitivity(i, p.position * p.mark, 0);
+        }
+        scenarioRisk.evaluate();
+        riskMetrics.var99 = scenarioRisk.report(0.99);
     }
 
     void MonitorRisk() {
         // Monitor risk
-        // ...
+        CalculateRiskMetrics();
+        // Limit checks on the instruments touched since the last cycle; alerts are only queued here,
+        // so a burst of breaches never blocks monitoring
+        rules.evaluate(positions, now_ns());
     }
 
     void SendAlert() {
-        // Send alert
-        // ...
+        // Send alert: alert thread, drains what the monitor queued
+        risk_rules::Alert alert;
+        while (rules.next_alert(alert)) {
+            std::cout << "RISK ALERT rule=" << alert.rule << " instrument=" << alert.instrument
+                      << " value=" << alert.value << " limit=" << alert.threshold << std::endl;
+        }
     }
 
     void AnalyzeTrades() {
-        // Analyze trades
-        // ...
+        // Analyze trades: per venue costs over the last 5 minutes, what the router's venue metrics read
+        for (int venue = 0; venue < tca.venues(); venue++) {
+            tca::VenueTca v = tca.venue(venue);
+            if (v.orders == 0 && v.fills == 0)
+                continue;
+            std::cout << "venue " << venue << " fills=" << v.fills << " fill rate=" << v.fill_rate
+                      << " slippage=" << v.slippage_bps << "bps realized spread=" << v.realized_spread_bps
+                      << "bps markout 1s/5s/60s=" << v.markout_bps[0] << "/" << v.markout_bps[1] << "/"
+                      << v.markout_bps[2] << "bps" << std::endl;
+        }
+    }
+
+    tca::VenueTca VenueCosts(int venue) const {
+        return tca.venue(venue);
     }
 
     void GenerateRiskReport() {
         // Generate risk report
-        // ...
+        std::cout << "PnL realized/unrealized=" << riskMetrics.realized_pnl << "/" << riskMetrics.unrealized_pnl
+                  << " exposure=" << riskMetrics.gross_exposure
+                  << " VaR99=" << riskMetrics.var99.var << " ES99=" << riskMetrics.var99.expected_shortfall
+                  << " worst scenario=" << riskMetrics.var99.worst_scenario << std::endl;
     }
 };
\ No newline at end of file
@@ -1,4 +1,7 @@
+#pragma once
 #include "exploring_circular_array.hpp"
+#include "matching_engine.hpp"
+#include "thread_placement.hpp"
 #include <thread>
 #include <sched.h>
 
@@ -6,43 +9,93 @@ namespace strategy {
 
     using namespace circular_array;
 
+    // Somewhere else to send orders than the book or the matching engine, e.g. the
+    // backtester's simulated venue
+    class OrderGateway {
+    public:
+        virtual ~OrderGateway() = default;
+        virtual void submit(const Order& order, bool is_bid) = 0;
+    };
+
+    // Thresholds of the dummy strategy (the defaults are the original hard-coded ones)
+    struct StrategyParams {
+        double buy_bid_above = 100;     // buy when best bid > this ...
+        double buy_offer_below = 200;   // ... and best offer < this
+        double sell_offer_above = 300;  // sell when best offer > this ...
+        double sell_bid_below = 400;    // ... and best bid < this
+        double edge = 1;                // buy at offer - edge, sell at bid + edge
+        int quantity = 100;
+    };
+
     class StrategyModule {
     private:
         LimitOrderBook& orderBook;
+        matching_engine::MatchingEngine* engine;
+        OrderGateway* gateway;
+        int next_id;
+        StrategyParams params;
+
+        // With an engine the order goes through matching (crossing orders trade),
+        // otherwise it's written straight into the book as before
+        void place(const Order& order, bool is_bid) {
+            if (gateway != nullptr)
+                gateway->submit(Order(next_id++, order.price, order.quantity), is_bid);
+            else if (engine != nullptr)
+                engine->new_order(next_id++, order.price, order.quantity, is_bid);
+            else
+                orderBook.add_order(order, is_bid);
+        }
 
     public:
-        StrategyModule(LimitOrderBook& lob) : orderBook(lob) {}
+        StrategyModule(LimitOrderBook& lob) : orderBook(lob), engine(nullptr), gateway(nullptr), next_id(1) {}
+        StrategyModule(matching_engine::MatchingEngine& engine) : orderBook(engine.book()), engine(&engine), gateway(nullptr), next_id(1) {}
+        // Reads lob, sends its orders to the gateway
+        StrategyModule(LimitOrderBook& lob, OrderGateway& gateway, const StrategyParams& params = StrategyParams())
+            : orderBook(lob), engine(nullptr), gateway(&gateway), next_id(1), params(params) {}
 
-        void run() {
-            // Pin this thread to the first CPU core
-            cpu_set_t cpuset;
-            CPU_ZERO(&cpuset);
-            CPU_SET(0, &cpuset);
-            pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+        // New thresholds and order ids from 1, e.g. for the next run of a parameter sweep
+        void reset(const StrategyParams& new_params) {
+            params = new_params;
+            next_id = 1;
+        }
+        const StrategyParams& parameters() const { return params; }
 
-            // Busy waiting loop
-            while (true) {
-                Order best_bid = orderBook.get_best_bid();
-                Order best_offer = orderBook.get_best_offer();
-
-                // Dummy strategy logic
-                if (best_bid.price > 100 && best_offer.price < 200) {
-                    // Place a buy order
-                    Order buy_order;
-                    buy_order.price = best_offer.price - 1;
-                    buy_order.quantity = 100;
-                    orderBook.add_order(buy_order, true);
+        // One decision on the current book, the body of run()'s loop. Returns true if it placed an order.
+        bool on_book_update(bool verbose = false) {
+            Order best_bid = orderBook.get_best_bid();
+            Order best_offer = orderBook.get_best_offer();
+
+            // Dummy strategy logic
+            if (best_bid.price > params.buy_bid_above && best_offer.price < params.buy_offer_below) {
+                // Place a buy order
+                Order buy_order;
+                buy_order.price = best_offer.price - params.edge;
+                buy_order.quantity = params.quantity;
+                place(buy_order, true);
+                if (verbose)
                     std::cout << "Placed buy order at price: " << buy_order.price << "\n";
-                }
-                else if (best_offer.price > 300 && best_bid.price < 400) {
-                    // Place a sell order
-                    Order sell_order;
-                    sell_order.price = best_bid.price + 1;
-                    sell_order.quantity = 100;
-                    orderBook.add_order(sell_order, false);
+                return true;
+            }
+            else if (best_offer.price > params.sell_offer_above && best_bid.price < params.sell_bid_below) {
+                // Place a sell order
+                Order sell_order;
+                sell_order.price = best_bid.price + params.edge;
+                sell_order.quantity = params.quantity;
+                place(sell_order, false);
+                if (verbose)
                     std::cout << "Placed sell order at price: " << sell_order.price << "\n";
-                }
+                return true;
             }
+            return false;
+        }
+
+        // cpu: the strategy's core, ThreadPlacement::cpu_of(placement::STRATEGY); -1 isn't pinned
+        void run(int cpu = -1) {
+            placement::pin_current_thread(cpu);
+
+            // Busy waiting loop
+            while (true)
+                on_book_update(true);
         }
     };
 
@@ -0,0 +1,290 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace tca
+{
+
+// Markout horizons, 1s / 5s / 60s; the realised spread is measured at the 5s one
+const int HORIZONS = 3;
+const uint64_t HORIZON_NS[HORIZONS] = {1000000000ull, 5000000000ull, 60000000000ull};
+const int REALIZED_SPREAD_HORIZON = 1;
+
+// Mid history: 50ms buckets, 128 of them per instrument (6.4s look-back for arrival prices, 2KB per instrument)
+const uint64_t MID_BUCKET_NS = 50000000ull;
+const uint64_t MID_BUCKETS = 128;
+
+// Per-venue window: 60 buckets of 5s, the last 5 minutes
+const uint64_t VENUE_BUCKET_NS = 5000000000ull;
+const uint64_t VENUE_BUCKETS = 60;
+
+enum class OrderEvent : uint8_t { SENT, REJECTED, CANCELLED };
+
+struct Fill {
+    uint64_t time_ns;
+    uint64_t arrival_ns;   // when the parent decision was taken, the arrival price is the mid at that time:
+                           // looked up in the mid history, so only within its 6.4s look-back
+    int32_t instrument;
+    int32_t venue;
+    int32_t quantity;
+    bool is_buy;
+    double price;
+    double arrival_mid = 0;   // the arrival mid if the caller kept it (older parents), 0 = look it up
+};
+
+// What the router reads per venue, over the window. Costs in basis points, positive = cost to us
+// (slippage, spreads); markouts positive = the price moved our way after the fill.
+struct VenueTca {
+    uint64_t orders;
+    uint64_t fills;
+    uint64_t rejects;
+    uint64_t cancels;
+    int64_t quantity;
+    double fill_rate;
+    double reject_rate;
+    double cancel_rate;
+    double slippage_bps;
+    double effective_spread_bps;
+    double realized_spread_bps;
+    double markout_bps[HORIZONS];
+};
+
+// Last mid of every 50ms bucket, per instrument, in a fixed ring. Buckets without an update are
+// filled forward with the previous mid when the next update arrives, so a lookup is one load.
+// Book updates are expected in time order (live feed or replay).
+class MidHistory {
+private:
+    struct Entry {
+        uint64_t bucket;
+        double mid;
+    };
+    std::vector<Entry> ring;          // instruments x MID_BUCKETS
+    std::vector<uint64_t> last_bucket;
+    std::vector<double> last_mid;
+
+    static constexpr uint64_t NO_DATA = ~0ull;
+
+    Entry& slot(int32_t instrument, uint64_t bucket) {
+        return ring[instrument * MID_BUCKETS + (bucket % MID_BUCKETS)];
+    }
+
+public:
+    MidHistory(int num_instruments)
+        : ring(num_instruments * MID_BUCKETS, Entry{NO_DATA, 0}), last_bucket(num_instruments, NO_DATA), last_mid(num_instruments, 0) {}
+
+    void update(int32_t instrument, uint64_t time_ns, double mid) {
+        uint64_t b = time_ns / MID_BUCKET_NS;
+        uint64_t last = last_bucket[instrument];
+        if (last != NO_DATA && b < last)
+            return;
+        if (last != NO_DATA) {
+            uint64_t from = b - last > MID_BUCKETS ? b - MID_BUCKETS : last + 1;
+            for (uint64_t k = from; k < b; k++)
+                slot(instrument, k) = Entry{k, last_mid[instrument]};
+        }
+        slot(instrument, b) = Entry{b, mid};
+        last_bucket[instrument] = b;
+        last_mid[instrument] = mid;
+    }
+
+    // Mid as of time_ns, 0 if unknown (no quote yet, or older than the look-back)
+    double at(int32_t instrument, uint64_t time_ns) {
+        uint64_t b = time_ns / MID_BUCKET_NS;
+        uint64_t last = last_bucket[instrument];
+        if (last == NO_DATA)
+            return 0;
+        if (b >= last)
+            return last_mid[instrument];
+        Entry& e = slot(instrument, b);
+        return e.bucket == b ? e.mid : 0;
+    }
+};
+
+// Streaming transaction cost analysis. Consumes fills, order events and book updates, keeps:
+// - per fill: arrival slippage and effective spread at fill time; markouts and realised spread
+//   once each horizon has passed (pending fills wait in a fixed ring, one cursor per horizon)
+// - per venue: a ring of 5s buckets, so every statistic is over the last 5 minutes
+// Everything is sized at construction, nothing is allocated per trade.
+class TcaEngine {
+private:
+    struct Bucket {
+        uint64_t bucket;
+        uint64_t orders, fills, rejects, cancels;
+        int64_t quantity;
+        // quantity weighted sums, and the quantity behind each (a metric may be unavailable for a fill)
+        double slippage, slippage_qty;
+        double effective_spread, effective_spread_qty;
+        double realized_spread, realized_spread_qty;
+        double markout[HORIZONS], markout_qty[HORIZONS];
+    };
+    struct PendingFill {
+        Fill fill;
+        double side;       // +1 buy, -1 sell
+        double fill_mid;
+    };
+
+    MidHistory mids;
+    int num_venues;
+    std::vector<Bucket> venue_buckets;   // venues x VENUE_BUCKETS
+    std::vector<PendingFill> pending;
+    size_t pending_mask;
+    uint64_t pending_tail;               // next fill to write
+    uint64_t cursor[HORIZONS];           // next fill waiting for horizon h; cursor[HORIZONS - 1] is the head
+    uint64_t now;
+    size_t dropped;
+    size_t dropped_arrival;              // fills without an arrival mid: no slippage
+
+    Bucket& venue_bucket(int32_t venue) {
+        uint64_t b = now / VENUE_BUCKET_NS;
+        Bucket& bucket = venue_buckets[venue * VENUE_BUCKETS + (b % VENUE_BUCKETS)];
+        if (bucket.bucket != b) {
+            bucket = Bucket{};
+            bucket.bucket = b;
+        }
+        return bucket;
+    }
+
+    // Markouts land in the bucket of the time they are resolved, not of the fill
+    void resolve(const PendingFill& p, int h) {
+        double mid = mids.at(p.fill.instrument, p.fill.time_ns + HORIZON_NS[h]);
+        if (mid == 0 || p.fill_mid == 0)
+            return;
+        Bucket& bucket = venue_bucket(p.fill.venue);
+        double qty = p.fill.quantity;
+        bucket.markout[h] += p.side * (mid - p.fill.price) / p.fill_mid * 1e4 * qty;
+        bucket.markout_qty[h] += qty;
+        if (h == REALIZED_SPREAD_HORIZON) {
+            bucket.realized_spread += 2 * p.side * (p.fill.price - mid) / p.fill_mid * 1e4 * qty;
+            bucket.realized_spread_qty += qty;
+        }
+    }
+
+    void advance(uint64_t time_ns) {
+        if (time_ns > now)
+            now = time_ns;
+        for (int h = 0; h < HORIZONS; h++) {
+            while (cursor[h] < pending_tail && pending[cursor[h] & pending_mask].fill.time_ns + HORIZON_NS[h] <= now) {
+                resolve(pending[cursor[h] & pending_mask], h);
+                cursor[h]++;
+            }
+        }
+    }
+
+public:
+    // pending_capacity: fills in flight over the longest horizon (rounded up to a power of two);
+    // when it is exceeded the oldest fill loses its remaining markouts
+    TcaEngine(int num_instruments, int num_venues, size_t pending_capacity)
+        : mids(num_instruments), num_venues(num_venues), venue_buckets(num_venues * VENUE_BUCKETS), pending_tail(0),
+          now(0), dropped(0), dropped_arrival(0) {
+        size_t size = 2;
+        while (size < pending_capacity)
+            size <<= 1;
+        pending.resize(size);
+        pending_mask = size - 1;
+        for (int h = 0; h < HORIZONS; h++)
+            cursor[h] = 0;
+        for (Bucket& b : venue_buckets)
+            b.bucket = ~0ull;
+    }
+
+    void on_book(int32_t instrument, uint64_t time_ns, double bid, double ask) {
+        mids.update(instrument, time_ns, (bid + ask) * 0.5);
+        advance(time_ns);
+    }
+
+    void on_order(int32_t venue, uint64_t time_ns, OrderEvent event) {
+        advance(time_ns);
+        Bucket& bucket = venue_bucket(venue);
+        if (event == OrderEvent::SENT)
+            bucket.orders++;
+        else if (event == OrderEvent::REJECTED)
+            bucket.rejects++;
+        else
+            bucket.cancels++;
+    }
+
+    void on_fill(const Fill& fill) {
+        advance(fill.time_ns);
+        double side = fill.is_buy ? 1.0 : -1.0;
+        double qty = fill.quantity;
+        double arrival_mid = fill.arrival_mid != 0 ? fill.arrival_mid : mids.at(fill.instrument, fill.arrival_ns);
+        double fill_mid = mids.at(fill.instrument, fill.time_ns);
+
+        Bucket& bucket = venue_bucket(fill.venue);
+        bucket.fills++;
+        bucket.quantity += fill.quantity;
+        if (arrival_mid != 0) {
+            bucket.slippage += side * (fill.price - arrival_mid) / arrival_mid * 1e4 * qty;
+            bucket.slippage_qty += qty;
+        }
+        else {
+            dropped_arrival++;
+        }
+        if (fill_mid != 0) {
+            bucket.effective_spread += 2 * side * (fill.price - fill_mid) / fill_mid * 1e4 * qty;
+            bucket.effective_spread_qty += qty;
+        }
+
+        if (pending_tail - cursor[HORIZONS - 1] == pending.size()) {
+            // ring full: the oldest fill gives up the horizons it has not reached yet
+            for (int h = 0; h < HORIZONS; h++)
+                if (cursor[h] == pending_tail - pending.size())
+                    cursor[h]++;
+            dropped++;
+        }
+        pending[pending_tail & pending_mask] = PendingFill{fill, side, fill_mid};
+        pending_tail++;
+    }
+
+    // Statistics of the last VENUE_BUCKETS buckets
+    VenueTca venue(int32_t venue) const {
+        VenueTca out{};
+        Bucket sum{};
+        uint64_t current = now / VENUE_BUCKET_NS;
+        for (uint64_t i = 0; i < VENUE_BUCKETS; i++) {
+            const Bucket& b = venue_buckets[venue * VENUE_BUCKETS + i];
+            if (b.bucket > current || current - b.bucket >= VENUE_BUCKETS)
+                continue;
+            sum.orders += b.orders;
+            sum.fills += b.fills;
+            sum.rejects += b.rejects;
+            sum.cancels += b.cancels;
+            sum.quantity += b.quantity;
+            sum.slippage += b.slippage;
+            sum.slippage_qty += b.slippage_qty;
+            sum.effective_spread += b.effective_spread;
+            sum.effective_spread_qty += b.effective_spread_qty;
+            sum.realized_spread += b.realized_spread;
+            sum.realized_spread_qty += b.realized_spread_qty;
+            for (int h = 0; h < HORIZONS; h++) {
+                sum.markout[h] += b.markout[h];
+                sum.markout_qty[h] += b.markout_qty[h];
+            }
+        }
+        out.orders = sum.orders;
+        out.fills = sum.fills;
+        out.rejects = sum.rejects;
+        out.cancels = sum.cancels;
+        out.quantity = sum.quantity;
+        if (sum.orders > 0) {
+            out.fill_rate = static_cast<double>(sum.fills) / sum.orders;
+            out.reject_rate = static_cast<double>(sum.rejects) / sum.orders;
+            out.cancel_rate = static_cast<double>(sum.cancels) / sum.orders;
+        }
+        out.slippage_bps = sum.slippage_qty > 0 ? sum.slippage / sum.slippage_qty : 0;
+        out.effective_spread_bps = sum.effective_spread_qty > 0 ? sum.effective_spread / sum.effective_spread_qty : 0;
+        out.realized_spread_bps = sum.realized_spread_qty > 0 ? sum.realized_spread / sum.realized_spread_qty : 0;
+        for (int h = 0; h < HORIZONS; h++)
+            out.markout_bps[h] = sum.markout_qty[h] > 0 ? sum.markout[h] / sum.markout_qty[h] : 0;
+        return out;
+    }
+
+    int venues() const { return num_venues; }
+    size_t pending_fills() const { return pending_tail - cursor[HORIZONS - 1]; }
+    size_t dropped_markouts() const { return dropped; }
+    size_t dropped_arrivals() const { return dropped_arrival; }
+    uint64_t time() const { return now; }
+};
+
+} // namespace tca
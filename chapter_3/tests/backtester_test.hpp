@@ -0,0 +1,150 @@
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include "../backtester.hpp"
+
+    // Bids 100 @ 100.00 once the book has both sides
+    struct QueueTestStrategy {
+        circular_array::LimitOrderBook& book;
+        strategy::OrderGateway& gateway;
+        bool placed = false;
+
+        void on_book_update() {
+            if (!placed && book.get_best_offer().quantity > 0) {
+                gateway.submit(circular_array::Order(1, 100.0, 100), true);
+                placed = true;
+            }
+        }
+    };
+
+    backtest::EventStream synthetic_stream(unsigned seed, int64_t start, size_t events)
+    {
+        std::mt19937 generator(seed);
+        backtest::EventStream stream;
+        int64_t t = start;
+        double mid = 150.0;
+        for (size_t i = 0; i < events; i++) {
+            t += 1 + generator() % 1000;
+            if (generator() % 4 == 0) {
+                bool buyer = generator() % 2;
+                stream.push_back(backtest::MarketEvent{t, buyer ? mid + 0.05 : mid - 0.05, static_cast<int>(1 + generator() % 200), backtest::EventType::TRADE, buyer});
+            }
+            else {
+                mid += ((int)(generator() % 3) - 1) * 0.05;
+                bool bid = generator() % 2;
+                int level = generator() % 5;
+                double price = bid ? mid - 0.05 - level * 0.01 : mid + 0.05 + level * 0.01;
+                int quantity = generator() % 8 == 0 ? 0 : static_cast<int>(100 + generator() % 500);
+                stream.push_back(backtest::MarketEvent{t, std::round(price * 100) / 100, quantity, backtest::EventType::BOOK, bid});
+            }
+        }
+        return stream;
+    }
+
+    void test_backtester_queue_position()
+    {
+        using backtest::MarketEvent;
+        using backtest::EventType;
+        //Our bid joins behind the visible 300, cancels shrink the queue ahead, trades eat it, then us
+        backtest::BacktestConfig config;
+        circular_array::LimitOrderBook book(config.precision, config.book_depth);
+        int64_t clock = 0;
+        backtest::SimulatedVenue venue(book, config, 0, &clock);
+        auto apply = [&](const MarketEvent& e) {
+            clock = e.timestamp;
+            venue.advance(clock);
+            if (e.type == EventType::BOOK)
+                book.update_order(circular_array::Order(0, e.price, e.quantity), e.is_bid);
+            venue.on_event(e);
+        };
+        apply(MarketEvent{1, 100.0, 300, EventType::BOOK, true});
+        apply(MarketEvent{2, 101.0, 200, EventType::BOOK, false});
+        venue.submit(circular_array::Order(1, 100.0, 100), true);
+        assert(venue.resting() == 1 && venue.queue_ahead(1) == 300);
+        apply(MarketEvent{3, 100.0, 200, EventType::BOOK, true});
+        assert(venue.queue_ahead(1) == 200);
+        apply(MarketEvent{4, 100.0, 400, EventType::BOOK, true});        // joined behind us: no change
+        apply(MarketEvent{5, 100.0, 150, EventType::TRADE, false});
+        assert(venue.queue_ahead(1) == 50 && venue.fills().empty());
+        apply(MarketEvent{6, 100.0, 100, EventType::TRADE, false});
+        assert(venue.fills().size() == 1 && venue.fills()[0].quantity == 50 && venue.fills()[0].price == 100.0);
+        apply(MarketEvent{7, 99.5, 10, EventType::TRADE, false});         // traded through: all of us
+        assert(venue.fills().size() == 2 && venue.fills()[1].quantity == 50 && venue.resting() == 0);
+
+        //A crossing order takes the touch (after the latency), the rest rests
+        config.latency = 10;
+        venue.fills().clear();
+        venue.submit(circular_array::Order(2, 101.0, 300), true);
+        assert(venue.fills().empty());
+        apply(MarketEvent{20, 100.0, 400, EventType::BOOK, true});
+        assert(venue.fills().size() == 1 && venue.fills()[0].quantity == 200 && venue.fills()[0].price == 101.0);
+        assert(venue.resting() == 1 && venue.queue_ahead(2) == 0);
+
+        //Through the backtester: the same history gives position 100 @ 100 marked at the new mid
+        backtest::BacktestConfig serial;
+        backtest::EventStream stream = {
+            {1, 100.0, 300, EventType::BOOK, true}, {2, 101.0, 200, EventType::BOOK, false},
+            {3, 100.0, 200, EventType::BOOK, true}, {5, 100.0, 150, EventType::TRADE, false},
+            {6, 100.0, 100, EventType::TRADE, false}, {7, 99.5, 10, EventType::TRADE, false},
+            {8, 101.0, 0, EventType::BOOK, false}, {9, 102.0, 10, EventType::BOOK, false},
+            {10, 101.0, 10, EventType::BOOK, true}};
+        backtest::Backtester<QueueTestStrategy> backtester(1, serial,
+            [](circular_array::LimitOrderBook& b, strategy::OrderGateway& g) { return QueueTestStrategy{b, g}; });
+        backtest::BacktestResult result = backtester.run({&stream});
+        assert(result.events == stream.size() && result.fills == 2 && result.positions[0] == 100);
+        assert(result.pnl.back().realized == 0 && std::abs(result.pnl.back().unrealized - 150) < 1e-9);
+        std::cout << "######BACKTESTER TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+    void test_backtester_merge_and_parallel()
+    {
+        //Streams come out merged in timestamp order, every event once
+        std::vector<backtest::EventStream> streams;
+        for (unsigned s = 0; s < 6; s++)
+            streams.push_back(synthetic_stream(s, s * 7, 3000 + s * 100));
+        std::vector<const backtest::EventStream*> day = {&streams[0], &streams[1], &streams[2]};
+        backtest::EventMerger merger(day);
+        int32_t stream;
+        const backtest::MarketEvent* event;
+        int64_t last = -1;
+        size_t count = 0, from_second = 0;
+        while (merger.next(stream, event)) {
+            assert(event->timestamp >= last);
+            last = event->timestamp;
+            from_second += stream == 1;
+            count++;
+        }
+        assert(count == streams[0].size() + streams[1].size() + streams[2].size() && from_second == streams[1].size());
+
+        //Independent days in parallel give the results of running them one by one
+        backtest::BacktestConfig config;
+        config.sample_interval = 100000;
+        config.latency = 500;
+        auto make = [](circular_array::LimitOrderBook& b, strategy::OrderGateway& g) { return strategy::StrategyModule(b, g); };
+        std::vector<std::vector<const backtest::EventStream*>> jobs = {day, {&streams[3], &streams[4]}, {&streams[5]}};
+        std::vector<backtest::BacktestResult> parallel = backtest::run_parallel(jobs, config, make);
+        uint64_t fills = 0;
+        for (size_t j = 0; j < jobs.size(); j++) {
+            backtest::Backtester<strategy::StrategyModule> backtester(jobs[j].size(), config, make);
+            backtest::BacktestResult serial = backtester.run(jobs[j]);
+            assert(serial.events == parallel[j].events && serial.fills == parallel[j].fills);
+            assert(serial.positions == parallel[j].positions && serial.pnl.size() == parallel[j].pnl.size());
+            for (size_t i = 0; i < serial.pnl.size(); i++)
+                assert(serial.pnl[i].realized == parallel[j].pnl[i].realized && serial.pnl[i].unrealized == parallel[j].pnl[i].unrealized);
+            fills += serial.fills;
+        }
+        assert(fills > 0 && parallel[0].pnl.size() > 10);
+        std::cout << "######BACKTESTER TEST CASE 2 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_backtester_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_backtester_queue_position();
+        test_backtester_merge_and_parallel();
+    }
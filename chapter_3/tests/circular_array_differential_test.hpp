@@ -0,0 +1,82 @@
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <iomanip>
+#include <iostream>
+#include "../exploring_circular_array.hpp"
+#include "circular_array_reference.hpp"
+
+    // price_to_index is protected: both books expose it for the lookups of the test
+    struct CircularArrayUnderTest : circular_array::LimitOrderBook {
+        using circular_array::LimitOrderBook::LimitOrderBook;
+        int index(double price, bool is_bid, bool update_pointers) { return price_to_index(price, is_bid, update_pointers); }
+    };
+    struct CircularArrayReference : circular_array_reference::LimitOrderBook {
+        using circular_array_reference::LimitOrderBook::LimitOrderBook;
+        int index(double price, bool is_bid, bool update_pointers) { return price_to_index(price, is_bid, update_pointers); }
+    };
+
+    template <class Book>
+    bool same_side(Book& book, const circular_array::Order& best, const circular_array::Order& worst, int64_t volume, bool is_bid)
+    {
+        circular_array::Order b = is_bid ? book.get_best_bid() : book.get_best_offer();
+        circular_array::Order w = is_bid ? book.get_lowest_bid() : book.get_highest_offer();
+        return b.id == best.id && b.price == best.price && b.quantity == best.quantity
+            && w.id == worst.id && w.price == worst.price && w.quantity == worst.quantity && book.get_top_volume(is_bid) == volume;
+    }
+
+    void test_circular_array_matches_reference()
+    {
+        //Random updates, deletes and lookups around a drifting price on small rings, so the cold
+        //paths (grow, discard, gap shifts, full resets) run often: slot and book state must match
+        //the reference after every step, and a lookup without update_pointers must not move anything
+        std::mt19937 random(1);
+        for (int trial = 0; trial < 2000; trial++) {
+            int depth = 2 + random() % 30;
+            CircularArrayUnderTest book(2, depth);
+            CircularArrayReference reference(2, depth);
+            double base = 100 + (random() % 1000) * 0.01;
+            int spread = 1 + random() % (depth * 3);
+            for (int step = 0; step < 200; step++) {
+                bool is_bid = random() % 2;
+                double price = std::round((base + (static_cast<int>(random() % (2 * spread + 1)) - spread) * 0.01) * 100) / 100;
+                if (random() % 50 == 0)
+                    base += (static_cast<int>(random() % 200) - 100) * 0.01;
+                int op = random() % 10;
+                if (op == 0) {
+                    bool update_pointers = random() % 2;
+                    circular_array::Order best = is_bid ? book.get_best_bid() : book.get_best_offer();
+                    circular_array::Order worst = is_bid ? book.get_lowest_bid() : book.get_highest_offer();
+                    int64_t volume = book.get_top_volume(is_bid);
+                    assert(book.index(price, is_bid, update_pointers) == reference.index(price, is_bid, update_pointers));
+                    assert(update_pointers || same_side(book, best, worst, volume, is_bid));
+                }
+                else if (op < 3) {
+                    book.delete_order(circular_array::Order(0, price, 0), is_bid);
+                    reference.delete_order(circular_array_reference::Order(0, price, 0), is_bid);
+                }
+                else {
+                    int quantity = 1 + random() % 100;
+                    int id = random() % 1000;
+                    book.update_order(circular_array::Order(id, price, quantity), is_bid);
+                    reference.update_order(circular_array_reference::Order(id, price, quantity), is_bid);
+                }
+                for (int side = 0; side < 2; side++) {
+                    circular_array_reference::Order best = side ? reference.get_best_bid() : reference.get_best_offer();
+                    circular_array_reference::Order worst = side ? reference.get_lowest_bid() : reference.get_highest_offer();
+                    assert(same_side(book, circular_array::Order(best.id, best.price, best.quantity), circular_array::Order(worst.id, worst.price, worst.quantity),
+                                     reference.get_top_volume(side), side));
+                }
+            }
+        }
+        std::cout << "######CIRCULAR ARRAY DIFFERENTIAL TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_circular_array_differential_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_circular_array_matches_reference();
+    }
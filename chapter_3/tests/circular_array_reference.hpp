@@ -0,0 +1,438 @@
+ #pragma once
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <cstdint>
+#include "../book_depth.hpp"
+
+// The circular array book as it was before price_to_index became one template with a cold
+// path (exploring_circular_array.hpp): the reference of the differential test. The only change
+// is the same update_pointers guard on the offer full reset and the gap resets.
+namespace circular_array_reference
+{
+    
+
+class Order {
+public:
+    int id;
+    double price;
+    int quantity;
+
+    Order() : id(0), price(0), quantity(0) {}
+    Order(int id, double price, int quantity) : id(id), price(price), quantity(quantity) {}
+    void reset()
+    {
+        id=0;
+        price=0.0;
+        quantity=0.0;
+    }
+};
+
+class LimitOrderBook {
+private:
+    std::vector<Order> bids;
+    std::vector<Order> offers;
+    int precision;
+    int depth;
+    double step_value;
+    int top_levels;         // window (in ticks from the touch) whose volume is kept up to date
+    int64_t top_volume[2];  // [0] offers, [1] bids
+
+    // Ticks between the slot and the best price of its side (ring order), -1 if the slot is outside ini..end
+    int distance_from_best(int index, bool is_bid) const {
+        int ini = is_bid ? ptr_bid_ini - &bids[0] : ptr_offer_ini - &offers[0];
+        int end = is_bid ? ptr_bid_end - &bids[0] : ptr_offer_end - &offers[0];
+        int span = (end - ini + depth) % depth;
+        int distance = is_bid ? (end - index + depth) % depth : (index - ini + depth) % depth;
+        return distance <= span ? distance : -1;
+    }
+
+    int64_t volume_near_touch(bool is_bid) const {
+        int64_t volume = 0;
+        for_each_slot(is_bid, [&](const Order& o, int ticks) {
+            if (ticks >= top_levels)
+                return false;
+            volume += o.quantity;
+            return true;
+        });
+        return volume;
+    }
+
+    // Writes a slot (index -1: price discarded, nothing written) and keeps top_volume in sync:
+    // O(1) when the ring didn't move, O(top_levels) re-scan when price_to_index shifted the
+    // ini/end pointers (which can happen even when the price itself ends up discarded).
+    void set_level(int index, const Order& order, bool is_bid, const Order* ini_before, const Order* end_before) {
+        std::vector<Order>& side = is_bid ? bids : offers;
+        int previous = 0;
+        if (index > -1) {
+            previous = side[index].quantity;
+            side[index] = order;
+        }
+        bool moved = is_bid ? (ptr_bid_ini != ini_before || ptr_bid_end != end_before)
+                            : (ptr_offer_ini != ini_before || ptr_offer_end != end_before);
+        if (moved)
+            top_volume[is_bid] = volume_near_touch(is_bid);
+        else if (index > -1) {
+            int distance = distance_from_best(index, is_bid);
+            if (distance > -1 && distance < top_levels)
+                top_volume[is_bid] += order.quantity - previous;
+        }
+    }
+
+    // Visits the ring from the best price outwards: f(slot, ticks from best) returns false to stop.
+    // No modulo in the loop, the index just wraps at the end of the array.
+    template <class F>
+    void for_each_slot(bool is_bid, F f) const {
+        const Order* ini = is_bid ? ptr_bid_ini : ptr_offer_ini;
+        const Order* end = is_bid ? ptr_bid_end : ptr_offer_end;
+        if (ini == nullptr)
+            return;
+        const std::vector<Order>& side = is_bid ? bids : offers;
+        int first = ini - &side[0];
+        int last = end - &side[0];
+        int slots = (last - first + depth) % depth + 1;
+        int i = is_bid ? last : first;
+        for (int ticks = 0; ticks < slots; ticks++) {
+            if (!f(side[i], ticks))
+                return;
+            if (is_bid)
+                i = (i == 0) ? depth - 1 : i - 1;
+            else
+                i = (i == depth - 1) ? 0 : i + 1;
+        }
+    }
+
+    // Deleting the best (or the worst) level shrinks the ring to the next slot that still has quantity,
+    // so the pointers never rest on an emptied slot. A side left with nothing goes back to nullptr (fresh book).
+    // Returns true if a pointer moved.
+    bool trim(bool is_bid) {
+        Order*& ini = is_bid ? ptr_bid_ini : ptr_offer_ini;
+        Order*& end = is_bid ? ptr_bid_end : ptr_offer_end;
+        if (ini == nullptr)
+            return false;
+        std::vector<Order>& side = is_bid ? bids : offers;
+        Order* first = &side[0];
+        Order* last = first + depth - 1;
+        Order* ini_before = ini;
+        Order* end_before = end;
+        while (ini->quantity == 0 && ini != end)
+            ini = (ini == last) ? first : ini + 1;
+        while (end->quantity == 0 && end != ini)
+            end = (end == first) ? last : end - 1;
+        if (ini->quantity == 0)
+            ini = end = nullptr;
+        return ini != ini_before || end != end_before;
+    }
+
+protected:
+    Order* ptr_bid_ini;
+    Order* ptr_bid_end;
+    Order* ptr_offer_ini;
+    Order* ptr_offer_end;
+
+int price_to_index(double price, bool is_bid, bool update_pointers=true)
+{
+    // the goal of this method is to update the ini/end pointers based on the incoming price
+    // (in case the price is not valid or out of range, do nothing)
+    if (is_bid)
+    {
+        double diff = 0;
+        if (ptr_bid_ini == nullptr)
+        {
+            if (update_pointers)
+                ptr_bid_ini = ptr_bid_end = &bids[0];
+            return 0;
+        }
+        else if (price >= ptr_bid_ini->price && price <= ptr_bid_end->price)
+        {
+            // in this case, ini/end pointer stay the same
+            int qty_steps = std::lround((price - ptr_bid_ini->price) * step_value);
+            return ((ptr_bid_ini - &bids[0]) + qty_steps) % depth;
+        }
+        else if ( std::abs( std::max(ptr_bid_end->price, price) - std::min(ptr_bid_ini->price, price)) * step_value < depth){
+            //In this scenario, we have available array items
+            // Here we need to update ini/end pointer to their new postion.
+            // Due to this condition, the end pointer will be at the new price
+            // We must count if advancing the pointers, how many times we cycle. If we cycle more than once, all existing element values should be invalidated.
+            int qty_steps = round((price - ptr_bid_end->price) * step_value);
+            int cycles = abs(qty_steps) / depth;
+            if (price > ptr_bid_end->price && cycles >= 1) //means that all the existing values are invalidated. It is like having a buffer from scratch
+            {
+                if (update_pointers)
+                    ptr_bid_ini = ptr_bid_end = &bids[0];
+                return 0;
+            }
+            else{
+                int current_ini_position = ptr_bid_ini - &bids[0];
+                int current_end_position = ptr_bid_end - &bids[0];
+                int new_ini_position = (( (qty_steps>=0 ? current_ini_position: current_end_position) + qty_steps) % depth + depth) % depth;
+                int new_end_position = (( (qty_steps>=0 ? current_end_position: current_ini_position) + qty_steps) % depth + depth) % depth;
+                
+                
+                if (price < ptr_bid_ini->price)
+                {
+                    if (update_pointers)
+                        ptr_bid_ini = &bids[0] + new_ini_position; // update to the new ini ptr
+                    return new_ini_position;
+                }
+                if (price > ptr_bid_end->price)
+                {
+                    if (update_pointers)
+                        ptr_bid_end = &bids[0] + new_end_position; // update end ptr
+                    return new_end_position;
+                }
+            }
+        }
+        else if (price < ptr_bid_ini->price) //all array's item are used, hence discard
+            return -1; //discard the incoming price
+        else if ( std::abs( std::max(ptr_bid_end->price, price) - std::min(ptr_bid_ini->price, price)) * step_value > depth)
+        {
+            //In this scenario, we want to shift the circular buffer
+            //here we need to update ini/end pointer to their new postion.
+            // Due to this condition, the end pointer will be at the new price
+            // We must count if advancing the pointers, how many times we cycle. If we cycle more than once, all existing element values should be invalidated.
+            int qty_steps = round((price - ptr_bid_end->price) * step_value);
+            int cycles = abs(qty_steps) / depth;
+            if (price > ptr_bid_end->price && cycles >= 1) //means that all the existing values are invalidated. It is like having a buffer from scratch
+            {
+                if (update_pointers)
+                    ptr_bid_ini = ptr_bid_end = &bids[0];
+                return 0;
+            }
+            else{
+                int current_ini_position = ptr_bid_ini - &bids[0];
+                int current_end_position = ptr_bid_end - &bids[0];
+                int new_ini_position = (( (qty_steps>=0 ? current_ini_position: current_end_position) + qty_steps) % depth + depth) % depth;
+                int new_end_position = (( (qty_steps>=0 ? current_end_position: current_ini_position) + qty_steps) % depth + depth) % depth;
+                if (qty_steps>1 && update_pointers)
+                {
+                    //since we are skipping, clean/reset intermediate elements 
+                    //this scenario happens when there is a gap up/down in the market
+                    for(int i=0; i<new_end_position; i++)
+                        bids[i].reset();
+                }
+                if (update_pointers)
+                {
+                    ptr_bid_ini = &bids[0] + new_ini_position; // update to the new ini ptr
+                    ptr_bid_end = &bids[0] + new_end_position; // update end ptr
+                }
+                if (price < ptr_bid_ini->price)                   
+                    return new_ini_position;
+                if (price > ptr_bid_end->price)
+                    return new_end_position;
+            }            
+        }        
+    }
+        else  /*HANDLE OFFER*/
+        {
+            double diff = 0;
+            if (ptr_offer_ini == nullptr)
+            {
+                if (update_pointers)
+                    ptr_offer_ini = ptr_offer_end = &offers[0];
+                return 0;
+            }
+            else if (price >= ptr_offer_ini->price && price <= ptr_offer_end->price)
+            {
+                // In this scenario, we are adding in the middle of the buffer's range.
+                // in this case, ini/end pointer stay the same
+                int qty_steps = std::lround((price - ptr_offer_ini->price) * step_value);
+                return ((ptr_offer_ini - &offers[0]) + qty_steps) % depth;
+            }
+            else if ( std::abs( std::max(ptr_offer_end->price, price) - std::min(ptr_offer_ini->price, price)) * step_value < depth){
+                //In this scenario, we have available array items
+                //here we need to update ini/end pointer to their new postion.
+                // Due to this condition, the end pointer will be at the new price
+                // We must count if advancing the pointers, how many times we cycle. If we cycle more than once, all existing element values should be invalidated.
+                int qty_steps = round((price - ptr_offer_end->price) * step_value);
+                int cycles = abs(qty_steps) / depth;
+                if (price > ptr_offer_end->price && cycles >= 1) //means that all the existing values are invalidated. It is like having a buffer from scratch
+                {
+                    if (update_pointers)
+                        ptr_offer_ini = ptr_offer_end = &offers[0];
+                    return 0;
+                }
+                else{
+                    int current_ini_position = ptr_offer_ini - &offers[0];
+                    int current_end_position = ptr_offer_end - &offers[0];
+                    int new_ini_position = (( (qty_steps>=0 ? current_ini_position: current_end_position) + qty_steps) % depth + depth) % depth;
+                    int new_end_position = (( (qty_steps>=0 ? current_end_position: current_ini_position) + qty_steps) % depth + depth) % depth;
+                    
+                    
+                    if (price < ptr_offer_ini->price)
+                    {
+                        if (update_pointers)
+                            ptr_offer_ini = &offers[0] + new_ini_position; // update to the new ini ptr
+                        return new_ini_position;
+                    }
+                    if (price > ptr_offer_end->price)
+                    {
+                        if (update_pointers)
+                            ptr_offer_end = &offers[0] + new_end_position; // update end ptr
+                        return new_end_position;
+                    }
+                }
+            }
+            else if (price > ptr_offer_end->price) //all array's item are used, hence discard
+                return -1; //discard the incoming price
+            else if ( std::abs( std::max(ptr_offer_end->price, price) - std::min(ptr_offer_ini->price, price)) * step_value > depth)
+            {
+                //In this scenario, we want to shift the circular buffer
+                //here we need to update ini/end pointer to their new postion.
+                // Due to this condition, the end pointer will be at the new price
+                // We must count if advancing the pointers, how many times we cycle. If we cycle more than once, all existing element values should be invalidated.
+
+                int qty_steps_ini = static_cast<int>(std::round((price - ptr_offer_ini->price) * step_value));
+                int qty_steps_end = static_cast<int>(std::round((ptr_offer_end->price - price) * step_value));
+
+                int cycles = abs(qty_steps_ini) / depth;
+                if (price < ptr_offer_ini->price && cycles >= 1) //means that all the existing values are invalidated. It is like having a buffer from scratch
+                {
+                    if (update_pointers)
+                        ptr_offer_ini = ptr_offer_end = &offers[0];
+                    return 0;
+                }
+                else{
+                    int current_ini_position = ptr_offer_ini - &offers[0];
+                    int current_end_position = ptr_offer_end - &offers[0];                    
+                    int new_ini_position = (( current_ini_position + qty_steps_ini ) % depth + depth) % depth;
+                    int new_end_position = (( current_end_position + qty_steps_end-1 ) % depth + depth) % depth;
+
+                    if (qty_steps_ini>1 && update_pointers)
+                    {
+                        //since we are skipping, clean/reset intermediate elements 
+                        //this scenario happens when there is a gap up/down in the market
+                        for(int i=0; i<new_end_position; i++)
+                            offers[i].reset();
+                    }
+                    if (update_pointers)
+                    {
+                        ptr_offer_ini = &offers[0] + new_ini_position; // update to the new ini ptr
+                        ptr_offer_end = &offers[0] + new_end_position; // update end ptr
+                    }
+                    if (price < ptr_offer_ini->price)                   
+                        return new_ini_position;
+                    if (price > ptr_offer_end->price)
+                        return new_end_position;
+
+                }            
+            }
+        }
+    return -1;
+}
+
+
+
+
+public:
+    LimitOrderBook(int precision, int depth, int top_levels = 5) : precision(precision), depth(depth), top_levels(top_levels) {
+        top_volume[0] = top_volume[1] = 0;
+        bids.resize(depth);
+        offers.resize(depth);
+        ptr_bid_ini = ptr_offer_ini = nullptr;
+        ptr_bid_end = ptr_offer_end = nullptr;
+        step_value = std::pow(10, precision);
+    }
+
+    virtual void add_order(const Order& order, bool is_bid) {        
+        if (is_bid) {
+            Order* ini = ptr_bid_ini;
+            Order* end = ptr_bid_end;
+            int index = price_to_index(order.price, true);
+            set_level(index, order, true, ini, end);
+        } else {
+            Order* ini = ptr_offer_ini;
+            Order* end = ptr_offer_end;
+            int index = price_to_index(order.price, false);
+            set_level(index, order, false, ini, end);
+        }
+    }
+
+
+    void update_order(const Order& order, bool is_bid) {
+        Order* ini = is_bid ? ptr_bid_ini : ptr_offer_ini;
+        Order* end = is_bid ? ptr_bid_end : ptr_offer_end;
+        int index = price_to_index(order.price, is_bid);
+        set_level(index, order, is_bid, ini, end);
+    }
+
+    void delete_order(const Order& order, bool is_bid) {
+        Order* ini = is_bid ? ptr_bid_ini : ptr_offer_ini;
+        Order* end = is_bid ? ptr_bid_end : ptr_offer_end;
+        int index = price_to_index(order.price, is_bid);
+        set_level(index, Order(), is_bid, ini, end);
+        if (index > -1 && trim(is_bid))
+            top_volume[is_bid] = volume_near_touch(is_bid);
+    }
+
+    // Top-N market-by-price depth into a caller-owned snapshot, best level first, empty ticks skipped.
+    // Returns the number of levels written; never allocates.
+    template <int N>
+    int get_depth(bool is_bid, book_depth::DepthLevels<N>& out) const {
+        int n = 0;
+        for_each_slot(is_bid, [&](const Order& o, int) {
+            if (o.quantity > 0) {
+                out.price[n] = o.price;
+                out.quantity[n] = o.quantity;
+                n++;
+            }
+            return n < N;
+        });
+        out.count = n;
+        return n;
+    }
+
+    // Aggregated volume resting within "top_levels" ticks of the touch, maintained on every update
+    int64_t get_top_volume(bool is_bid) const {
+        return top_volume[is_bid];
+    }
+
+    // Empty book, storage kept (e.g. between backtest runs)
+    void clear() {
+        for (int i = 0; i < depth; i++) {
+            bids[i].reset();
+            offers[i].reset();
+        }
+        ptr_bid_ini = ptr_offer_ini = nullptr;
+        ptr_bid_end = ptr_offer_end = nullptr;
+        top_volume[0] = top_volume[1] = 0;
+    }
+
+    // An empty side returns Order() (quantity 0)
+    virtual Order get_best_bid() {
+        return ptr_bid_end != nullptr ? *ptr_bid_end : Order();
+    }
+    Order get_lowest_bid() {
+        return ptr_bid_ini != nullptr ? *ptr_bid_ini : Order();
+    }
+
+
+    Order get_best_offer() {
+        return ptr_offer_ini != nullptr ? *ptr_offer_ini : Order();
+    }
+    Order get_highest_offer() {
+        return ptr_offer_end != nullptr ? *ptr_offer_end : Order();
+    }
+
+    void print_bids()
+    {
+        for (int i=0; i<bids.size(); i++)
+        {
+            std::cout << i << "_" << bids[i].price << " * ";
+        }
+        std::cout << std::endl;
+        std::cout << "Bid ini/end=" << get_lowest_bid().price << "/" << get_best_bid().price << std::endl;
+    }
+    void print_offers()
+    {
+        for (int i=0; i<offers.size(); i++)
+        {
+            std::cout << i << "_" << offers[i].price << " * ";
+        }
+        std::cout << std::endl;
+        std::cout << "Offer ini/end=" << get_best_offer().price << "/" << get_highest_offer().price << std::endl;
+    }
+
+};
+} // namespace circular_array_reference
@@ -160,6 +160,37 @@ using namespace lockfree;
         }
         std::cout << "######TEST CASE 7 PASSED" << std::endl<< std::endl;
     }
+    void test_depth_and_price_to_fill(bool is_bid)
+    {
+        //Top-N depth skips empty ticks, top volume follows deletes, price to fill sweeps the snapshot
+        LimitOrderBook lob(2, 10);
+        lob.add_order(Order(1, 29500.21, 100), is_bid);
+        lob.add_order(Order(2, 29500.22, 200), is_bid);
+        lob.add_order(Order(4, 29500.24, 400), is_bid);
+        lob.add_order(Order(3, 29500.23, 300), is_bid);
+        lob.delete_order(Order(3, 29500.23, 300), is_bid);
+        assert(lob.get_top_volume(is_bid) == 700);
+
+        book_depth::DepthLevels<8> depth;
+        assert(lob.get_depth(is_bid, depth) == 3);
+        book_depth::cumulative_sum(depth.quantity, depth.cumulative, depth.count);
+        assert(depth.cumulative[2] == 700);
+
+        double vwap = 0;
+        double limit = book_depth::price_to_fill(depth, 500, &vwap);
+        if (is_bid){
+            assert(depth.quantity[0] == 400 && depth.quantity[2] == 100);
+            assert(std::abs(limit - 29500.22) < 1e-9);
+            assert(std::abs(vwap - (29500.24 * 400 + 29500.22 * 100) / 500) < 1e-6);
+        }
+        else{
+            assert(depth.quantity[0] == 100 && depth.quantity[2] == 400);
+            assert(std::abs(limit - 29500.24) < 1e-9);
+            assert(std::abs(vwap - (29500.21 * 100 + 29500.22 * 200 + 29500.24 * 200) / 500) < 1e-6);
+        }
+        assert(book_depth::price_to_fill(depth, 701, &vwap) == 0);
+        std::cout << "######TEST CASE 8 PASSED" << std::endl<< std::endl;
+    }
 
 
 
@@ -177,6 +208,7 @@ using namespace lockfree;
         test_order_arrives_with_gapdown(is_bid);
         test_order_arrives_with_gapup_cycle(is_bid);
         test_order_arrives_with_gapdown_cycle(is_bid);
+        test_depth_and_price_to_fill(is_bid);
 
         is_bid = false;
         test_lower_order_arrives(is_bid);
@@ -186,6 +218,7 @@ using namespace lockfree;
         test_order_arrives_with_gapdown(is_bid);
         test_order_arrives_with_gapup_cycle(is_bid);
         test_order_arrives_with_gapdown_cycle(is_bid);
+        test_depth_and_price_to_fill(is_bid);
 
     }
 
@@ -0,0 +1,41 @@
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include "../../chapter_4/feature_builder.hpp"
+
+    void test_feature_builder_batch()
+    {
+        //Rows gathered from the SoA inputs, normalised, aligned, padding left at zero
+        features::PortfolioArrays portfolio{{1000.0f, 2000.0f}, {3.0f, 4.0f}};
+        features::MarketArrays market{{10.0f, 20.0f, 30.0f}, {0.01f, 0.02f, 0.03f}, {10.1f, 20.1f, 30.1f}};
+        features::VenueArrays venues{{1.5f, 2.5f}, {0.1f, 0.2f}, {0.3f, 0.4f}, {0.9f, 0.8f}};
+        features::Decision decisions[3] = {{0, 2, 1}, {1, 0, 0}, {1, 1, 1}};
+
+        features::FeatureMatrix batch(2);
+        features::FeatureBuilder builder;
+        builder.set_normalization(features::PRICE, 20.0f, 0.1f);
+        assert(builder.build(decisions, 3, portfolio, market, venues, batch) == 2);   // capped at capacity
+        assert(reinterpret_cast<uintptr_t>(batch.data()) % 64 == 0 && batch.rows() == 2);
+
+        const float* r0 = batch.row(0);
+        assert(r0[features::CASH] == 1000.0f && r0[features::ASSET_COUNT] == 3.0f);
+        assert(std::abs(r0[features::PRICE] - 1.0f) < 1e-6f && r0[features::VWAP] == 30.1f);
+        assert(r0[features::SLIPPAGE] == 2.5f && r0[features::FILL_RATE] == 0.8f);
+        const float* r1 = batch.row(1);
+        assert(r1[features::CASH] == 2000.0f && std::abs(r1[features::PRICE] - (-1.0f)) < 1e-6f);
+        assert(r1[features::REJECT_RATE] == 0.1f && r1[features::CANCEL_RATE] == 0.3f);
+        for (size_t f = features::NUM_FEATURES; f < batch.stride(); f++)
+            assert(r0[f] == 0.0f && r1[f] == 0.0f);
+        std::cout << "######FEATURE BUILDER TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_feature_builder_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_feature_builder_batch();
+    }
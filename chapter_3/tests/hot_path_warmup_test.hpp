@@ -0,0 +1,90 @@
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include "../hot_path_warmup.hpp"
+
+    struct RecordingSink : warmup::OrderSink {
+        std::vector<warmup::OrderMessage> orders;
+        void send(const char* bytes, size_t size) override {
+            assert(size == sizeof(warmup::OrderMessage));
+            warmup::OrderMessage m;
+            std::memcpy(&m, bytes, sizeof(m));
+            orders.push_back(m);
+        }
+    };
+
+    std::vector<char> feed_message(int64_t timestamp, double price, int quantity, bool is_bid, backtest::EventType type = backtest::EventType::BOOK)
+    {
+        warmup::FeedMessage m{timestamp, std::llround(price * 100), quantity, static_cast<uint8_t>(type), static_cast<uint8_t>(is_bid), 0, 0};
+        std::vector<char> bytes(sizeof(m));
+        std::memcpy(bytes.data(), &m, sizeof(m));
+        return bytes;
+    }
+
+    void test_hot_path_warmup_suppresses_send()
+    {
+        //Real messages go parser -> book -> strategy -> risk -> encoder -> sink
+        circular_array::LimitOrderBook book(2, 1000);
+        RecordingSink sink;
+        warmup::HotPath path(book, sink);
+        warmup::WarmupConfig config;
+        config.idle_threshold = 1000;
+        config.warmup_interval = 100;
+        warmup::TradingLoop loop(path, config);
+        std::vector<char> bid = feed_message(1, 150.00, 300, true), offer = feed_message(2, 150.10, 200, false);
+        loop.on_message(bid.data(), bid.size(), 1);
+        assert(sink.orders.empty() && path.orders_rejected() == 1);     // bid only: the strategy buys at (offer 0) - 1, risk rejects it
+        loop.on_message(offer.data(), offer.size(), 2);
+        assert(sink.orders.size() == 1 && sink.orders[0].msg_type == 'D' && sink.orders[0].side == 1);
+        assert(sink.orders[0].price_ticks == 14910 && sink.orders[0].quantity == 100 && sink.orders[0].flags == 0);
+        assert(!path.on_message(bid.data(), bid.size() - 1));                    // truncated
+
+        //Idle: warm-up passes run the whole path on the live book, which stays as it was, and send nothing
+        uint64_t sent = path.orders_sent();
+        assert(!loop.on_idle(50) && loop.on_idle(102) && !loop.on_idle(150) && loop.on_idle(202));
+        assert(loop.warmup_passes() == 2 && path.warmup_orders() == 4 && path.orders_sent() == sent && sink.orders.size() == 1);
+        assert(book.get_best_bid().price == 150.00 && book.get_best_bid().quantity == 300 && book.get_best_offer().quantity == 200);
+        assert(book.get_top_volume(true) == 300);
+
+        //Latency telemetry keeps the first message after an idle gap apart
+        std::vector<char> update = feed_message(5000, 150.00, 250, true);
+        loop.on_message(update.data(), update.size(), 5000);
+        loop.on_message(update.data(), update.size(), 5100);
+        assert(loop.first_after_idle_latency().count == 1 && loop.steady_latency().count == 3);
+        assert(loop.first_after_idle_latency().mean() > 0 && loop.first_after_idle_latency().max_ns >= loop.first_after_idle_latency().mean());
+
+        //Risk rejects orders outside the band; an empty book has nothing to warm
+        warmup::PreTradeLimits tight;
+        tight.price_band = 0.001;
+        circular_array::LimitOrderBook other(2, 1000);
+        warmup::HotPath strict(other, sink, strategy::StrategyParams(), tight);
+        assert(!strict.warm(1));
+        size_t before = sink.orders.size();
+        strict.on_message(bid.data(), bid.size());
+        strict.on_message(offer.data(), offer.size());
+        assert(strict.orders_rejected() == 2 && sink.orders.size() == before);
+
+        //A one-sided book has no mid: orders are checked against the last print, and rejected before there is one
+        circular_array::LimitOrderBook quiet_book(2, 1000);
+        warmup::HotPath quiet(quiet_book, sink);
+        quiet.submit(circular_array::Order(1, 150.00, 10), true);
+        std::vector<char> print = feed_message(3, 150.00, 5, true, backtest::EventType::TRADE);
+        quiet.on_message(print.data(), print.size());
+        quiet.submit(circular_array::Order(2, 150.00, 10), true);
+        quiet.submit(circular_array::Order(3, 170.00, 10), true);
+        quiet.submit(circular_array::Order(4, -1.00, 10), true);
+        assert(quiet.orders_rejected() == 3 && quiet.orders_sent() == 1 && sink.orders.size() == before + 1 && sink.orders.back().id == 2);
+        std::cout << "######HOT PATH WARMUP TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_hot_path_warmup_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_hot_path_warmup_suppresses_send();
+    }
@@ -0,0 +1,84 @@
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include "../matching_engine.hpp"
+
+using matching_engine::MatchingEngine;
+using matching_engine::OrderType;
+using matching_engine::ReportType;
+
+    void test_matching_price_time_priority()
+    {
+        //Aggressive buy sweeps the best offer in time priority, then the next level, rest goes on the book
+        MatchingEngine engine(2, 100.00, 1000, 64, 10);
+        engine.new_order(1, 101.00, 100, false);
+        engine.new_order(2, 101.00, 200, false);
+        engine.new_order(3, 101.01, 300, false);
+
+        const auto& reports = engine.new_order(10, 101.01, 450, true);
+        assert(reports.size() == 3);
+        assert(reports[0].type == ReportType::FILL && reports[0].contra_id == 1 && reports[0].quantity == 100);
+        assert(reports[1].type == ReportType::FILL && reports[1].contra_id == 2 && reports[1].quantity == 200);
+        assert(reports[2].type == ReportType::FILL && reports[2].contra_id == 3 && reports[2].quantity == 150);
+        assert(reports[2].leaves == 0 && reports[2].contra_leaves == 150);
+        assert(engine.best_offer_price() == 101.01 && engine.quantity_at(101.01, false) == 150);
+        assert(engine.book().get_best_offer().quantity == 150);
+
+        const auto& rested = engine.new_order(11, 101.02, 200, true);
+        assert(rested.size() == 2 && rested[1].type == ReportType::NEW && rested[1].leaves == 50);
+        assert(engine.best_bid_price() == 101.02 && !engine.has_offers());
+        std::cout << "######MATCHING ENGINE TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+    void test_matching_ioc_fok()
+    {
+        //IOC cancels what it can't fill, FOK trades all or nothing
+        MatchingEngine engine(2, 100.00, 1000, 64, 10);
+        engine.new_order(1, 100.50, 100, true);
+        engine.new_order(2, 100.49, 100, true);
+
+        const auto& fok = engine.new_order(10, 100.49, 300, false, OrderType::FOK);
+        assert(fok.size() == 1 && fok[0].type == ReportType::CANCELED);
+        assert(engine.quantity_at(100.50, true) == 100);
+
+        const auto& ioc = engine.new_order(11, 100.50, 300, false, OrderType::IOC);
+        assert(ioc.size() == 2 && ioc[0].type == ReportType::FILL && ioc[0].quantity == 100);
+        assert(ioc[1].type == ReportType::CANCELED && ioc[1].leaves == 0);
+        assert(engine.best_bid_price() == 100.49 && !engine.has_offers());
+
+        const auto& filled = engine.new_order(12, 100.49, 100, false, OrderType::FOK);
+        assert(filled.size() == 1 && filled[0].type == ReportType::FILL && filled[0].leaves == 0);
+        assert(!engine.has_bids() && engine.resting_orders() == 0);
+        std::cout << "######MATCHING ENGINE TEST CASE 2 PASSED" << std::endl<< std::endl;
+    }
+    void test_matching_cancel_replace()
+    {
+        //Reducing quantity keeps priority, changing price loses it; cancel frees the id
+        MatchingEngine engine(2, 100.00, 1000, 64, 10);
+        engine.new_order(1, 100.10, 100, true);
+        engine.new_order(2, 100.10, 100, true);
+        engine.replace_order(1, 100.10, 50);
+
+        const auto& first = engine.new_order(10, 100.10, 10, false);
+        assert(first[0].contra_id == 1 && first[0].contra_leaves == 40);
+
+        engine.replace_order(1, 100.10, 200);   // quantity up: back of the queue
+        const auto& second = engine.new_order(11, 100.10, 10, false);
+        assert(second[0].contra_id == 2);
+
+        assert(engine.cancel_order(2)[0].type == ReportType::CANCELED);
+        assert(engine.cancel_order(2)[0].type == ReportType::REJECTED);
+        assert(engine.new_order(1, 100.11, 10, true)[0].type == ReportType::REJECTED);  // id still live
+        assert(engine.quantity_at(100.10, true) == 200 && engine.resting_orders() == 1);
+        std::cout << "######MATCHING ENGINE TEST CASE 3 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_matching_engine_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_matching_price_time_priority();
+        test_matching_ioc_fok();
+        test_matching_cancel_replace();
+    }
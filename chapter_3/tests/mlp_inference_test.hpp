@@ -0,0 +1,130 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include "../../chapter_4/mlp_inference.hpp"
+
+    // Plain double-precision forward pass over TensorFlow-layout kernels, the reference
+    static std::vector<double> mlp_reference(const std::vector<std::vector<float>>& kernels, const std::vector<std::vector<float>>& biases,
+                                             const std::vector<size_t>& sizes, const float* x)
+    {
+        std::vector<double> in(x, x + sizes[0]);
+        for (size_t l = 0; l + 1 < sizes.size(); l++) {
+            std::vector<double> out(sizes[l + 1]);
+            for (size_t o = 0; o < sizes[l + 1]; o++) {
+                double v = biases[l][o];
+                for (size_t i = 0; i < sizes[l]; i++)
+                    v += in[i] * kernels[l][i * sizes[l + 1] + o];
+                out[o] = (l + 2 < sizes.size() && v < 0) ? 0 : v;
+            }
+            in = out;
+        }
+        return in;
+    }
+
+    void test_mlp_matches_reference()
+    {
+        //Blocked SIMD kernels vs the reference; a state gives the same bits alone or inside a batch
+        std::vector<size_t> sizes = {9, 50, 37, 3};
+        std::vector<std::vector<float>> kernels, biases;
+        std::default_random_engine generator(7);
+        std::normal_distribution<float> weight(0.0f, 0.3f);
+        mlp::Network network(4);
+        for (size_t l = 0; l + 1 < sizes.size(); l++) {
+            kernels.emplace_back(sizes[l] * sizes[l + 1]);
+            biases.emplace_back(sizes[l + 1]);
+            for (float& w : kernels.back())
+                w = weight(generator);
+            for (float& b : biases.back())
+                b = weight(generator);
+            network.add_layer(sizes[l], sizes[l + 1], l + 2 < sizes.size() ? mlp::Activation::RELU : mlp::Activation::NONE,
+                              kernels.back().data(), biases.back().data());
+        }
+
+        const size_t rows = 7;   // two batches of 4 states: one full register tile, one partial
+        std::vector<float> states(rows * network.input_stride(), 0.0f);
+        for (size_t r = 0; r < rows; r++)
+            for (size_t i = 0; i < sizes[0]; i++)
+                states[r * network.input_stride() + i] = weight(generator) * 10;
+        std::vector<float> q(rows * 3);
+        network.forward(states.data(), network.input_stride(), rows, q.data());
+
+        for (size_t r = 0; r < rows; r++) {
+            std::vector<double> expected = mlp_reference(kernels, biases, sizes, &states[r * network.input_stride()]);
+            std::vector<float> single(3);
+            network.forward(&states[r * network.input_stride()], network.input_stride(), 1, single.data());
+            for (size_t o = 0; o < 3; o++) {
+                assert(std::abs(q[r * 3 + o] - expected[o]) < 1e-4 * (1 + std::abs(expected[o])));
+                assert(single[o] == q[r * 3 + o]);
+            }
+            int best = network.best_action(&states[r * network.input_stride()]);
+            assert(q[r * 3 + best] >= q[r * 3 + 0] && q[r * 3 + best] >= q[r * 3 + 1] && q[r * 3 + best] >= q[r * 3 + 2]);
+        }
+        std::cout << "######MLP INFERENCE TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+    void test_mlp_file_and_int8()
+    {
+        //Exported weights load back to the same network; int8 hidden layers stay close to float
+        std::default_random_engine generator(11);
+        std::normal_distribution<float> weight(0.0f, 0.2f);
+        std::vector<float> k1(16 * 64), b1(64), k2(64 * 3), b2(3);
+        for (float& w : k1) w = weight(generator);
+        for (float& w : b1) w = weight(generator);
+        for (float& w : k2) w = weight(generator);
+        for (float& w : b2) w = weight(generator);
+        mlp::Network network(8);
+        network.add_layer(16, 64, mlp::Activation::RELU, k1.data(), b1.data());
+        network.add_layer(64, 3, mlp::Activation::NONE, k2.data(), b2.data());
+
+        const char* path = "mlp_inference_test.bin";
+        network.save(path);
+        mlp::Network loaded(8);
+        loaded.load(path);
+        std::remove(path);
+        assert(loaded.num_layers() == 2 && loaded.inputs() == 16 && loaded.outputs() == 3);
+
+        std::vector<float> states(8 * 16);
+        for (float& x : states)
+            x = weight(generator) * 5;
+        std::vector<float> q(8 * 3), q_loaded(8 * 3), q_int8(8 * 3);
+        network.forward(states.data(), 16, 8, q.data());
+        loaded.forward(states.data(), 16, 8, q_loaded.data());
+        assert(q == q_loaded);
+
+        loaded.quantize();
+        loaded.forward(states.data(), 16, 8, q_int8.data());
+        for (size_t i = 0; i < q.size(); i++)
+            assert(std::abs(q_int8[i] - q[i]) < 0.05f * (1 + std::abs(q[i])));
+
+        bool thrown = false;
+        try {
+            loaded.load("does_not_exist.bin");
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown && loaded.num_layers() == 2);
+
+        //Nothing loaded yet: every use of the network throws instead of reading layers that don't exist
+        mlp::Network empty(8);
+        thrown = false;
+        try {
+            empty.best_action(states.data());
+        } catch (const std::logic_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        std::cout << "######MLP INFERENCE TEST CASE 2 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_mlp_inference_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_mlp_matches_reference();
+        test_mlp_file_and_int8();
+    }
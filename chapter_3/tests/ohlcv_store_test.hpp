@@ -0,0 +1,94 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <unistd.h>
+#include "../../chapter_4/ohlcv_store.hpp"
+
+    void test_ohlcv_store_mapped_round_trip()
+    {
+        //Columns in memory, saved, mapped back: same values, same ids, views point into the mapping
+        ohlcv::OhlcvStore store({"AAPL", "MSFT", "IBM"}, {20240102, 20240103, 20240104, 20240105, 20240108});
+        for (int32_t t = 0; t < 3; t++)
+            for (int f = 0; f < ohlcv::NUM_FIELDS; f++)
+                for (size_t d = 0; d < 5; d++)
+                    if (!(t == 2 && d == 1))                                   // IBM has no bar on the 3rd
+                        store.mutable_column(t, static_cast<ohlcv::Field>(f))[d] = 100 * t + 10 * f + d;
+        std::string path = "/tmp/ohlcv_store_test_" + std::to_string(getpid()) + ".ohlcv";
+        store.save(path);
+
+        ohlcv::OhlcvStore mapped = ohlcv::OhlcvStore::open(path);
+        assert(mapped.mapped() && mapped.tickers() == 3 && mapped.days() == 5);
+        assert(mapped.id("MSFT") == 1 && mapped.id("GOOG") == -1 && mapped.name(2) == "IBM");
+        assert(mapped.date(4) == 20240108 && mapped.day_index(20240106) == 4 && mapped.day_index(20250101) == 5);
+        assert(reinterpret_cast<uintptr_t>(mapped.column(0, ohlcv::OPEN)) % 64 == 0);
+        ohlcv::Bar bar = mapped.bar(1, 3);
+        assert(bar.open == 103 && bar.high == 113 && bar.close == 133 && bar.adjusted_close == 153);
+        assert(std::isnan(mapped.column(2, ohlcv::CLOSE)[1]) && mapped.column(2, ohlcv::CLOSE)[2] == 232);
+
+        ohlcv::Window last3 = mapped.window(1, mapped.days(), 3);
+        assert(last3.size == 3 && last3(ohlcv::OPEN, 0) == 102 && last3(ohlcv::VOLUME, 2) == 144);
+        assert(last3.field[ohlcv::LOW] == mapped.column(1, ohlcv::LOW) + 2);         // a view, not a copy
+        assert(mapped.window(0, 2, 10).size == 2 && mapped.window(0, 0, 10).size == 0);
+
+        ohlcv::OhlcvStore moved = std::move(mapped);
+        assert(moved.mapped() && moved.bar(0, 4).volume == 44);
+        bool threw = false;
+        try {
+            moved.mutable_column(0, ohlcv::OPEN);
+        } catch (const std::logic_error&) {
+            threw = true;
+        }
+        assert(threw);
+        std::remove(path.c_str());
+        threw = false;
+        try {
+            ohlcv::OhlcvStore::open(path);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+        std::cout << "######OHLCV STORE TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+    void test_ohlcv_store_csv_ingest()
+    {
+        //One CSV per ticker, any column order, unsorted rows: calendar is the union, gaps are NaN
+        std::string dir = "/tmp/ohlcv_csv_test_" + std::to_string(getpid());
+        std::string a = dir + "_AAA.csv", b = dir + "_BBB.csv";
+        FILE* f = std::fopen(a.c_str(), "w");
+        std::fprintf(f, "Date,Open,High,Low,Close,Adj Close,Volume\n"
+                        "2024-01-03,11,12,10,11.5,11.4,2000\n"
+                        "2024-01-02,10,11,9,10.5,10.4,1000\n");
+        std::fclose(f);
+        f = std::fopen(b.c_str(), "w");
+        std::fprintf(f, "Date,Volume,Close,Open,High,Low,Adj Close\r\n"
+                        "2024-01-02,500,20.5,20,21,19,20.4\r\n"
+                        "2024-01-04,700,22.5,22,23,21,22.4\r\n");
+        std::fclose(f);
+
+        ohlcv::OhlcvStore store = ohlcv::OhlcvStore::from_csv({a, b});
+        std::remove(a.c_str());
+        std::remove(b.c_str());
+        assert(!store.mapped() && store.tickers() == 2 && store.days() == 3);
+        assert(store.date(0) == 20240102 && store.date(1) == 20240103 && store.date(2) == 20240104);
+        int32_t aaa = store.id(ohlcv::detail::ticker_of(a)), bbb = store.id(ohlcv::detail::ticker_of(b));
+        assert(aaa == 0 && bbb == 1);
+        assert(store.bar(aaa, 0).open == 10 && store.bar(aaa, 1).adjusted_close == 11.4 && store.bar(aaa, 1).volume == 2000);
+        assert(std::isnan(store.bar(aaa, 2).close));
+        assert(store.bar(bbb, 0).volume == 500 && store.bar(bbb, 2).close == 22.5 && store.bar(bbb, 2).low == 21);
+        assert(std::isnan(store.bar(bbb, 1).open));
+        std::cout << "######OHLCV STORE TEST CASE 2 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_ohlcv_store_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_ohlcv_store_mapped_round_trip();
+        test_ohlcv_store_csv_ingest();
+    }
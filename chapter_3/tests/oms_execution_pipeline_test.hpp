@@ -0,0 +1,83 @@
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include "../oms_execution_pipeline.hpp"
+
+using oms_pipeline::ExecReport;
+using oms_pipeline::ExecType;
+using oms_pipeline::OrderStatus;
+
+    struct TestRiskSink {
+        int calls = 0;
+        int64_t position[4] = {};
+        double notional[4] = {};
+        void on_position_deltas(const oms_pipeline::PositionDelta* deltas, size_t count) {
+            calls++;
+            for (size_t i = 0; i < count; i++) {
+                position[deltas[i].symbol] += deltas[i].quantity;
+                notional[deltas[i].symbol] += deltas[i].notional;
+            }
+        }
+    };
+
+    void test_oms_pipeline_fills_and_deltas()
+    {
+        //Partial + full fill accumulate cum qty / avg price; one batch => one RMS call with net deltas
+        oms_pipeline::ExecutionPipeline oms(64, 16, 4, 32);
+        TestRiskSink rms;
+        oms.add_order(1, 0, 100, true);
+        oms.add_order(2, 0, 50, false);
+        oms.add_order(3, 1, 10, true);
+
+        oms.push(ExecReport{1, ExecType::NEW, 0, 0});
+        oms.push(ExecReport{1, ExecType::PARTIAL_FILL, 40, 10.00});
+        oms.push(ExecReport{2, ExecType::FILL, 50, 10.10});
+        oms.push(ExecReport{3, ExecType::REJECTED, 0, 0});
+        assert(oms.process_batch(rms, 32) == 4);
+
+        assert(rms.calls == 1);
+        assert(rms.position[0] == -10 && rms.position[1] == 0);
+        assert(oms.find(1)->status == OrderStatus::PARTIALLY_FILLED && oms.find(1)->cum_qty == 40);
+        assert(oms.find(2) == nullptr && oms.find(3) == nullptr);   // terminal orders are released
+
+        oms.push(ExecReport{1, ExecType::PARTIAL_FILL, 60, 10.05});
+        assert(oms.process_batch(rms, 32) == 1);
+        assert(oms.find(1) == nullptr && oms.live_orders() == 0);
+        assert(rms.position[0] == 50);
+        std::cout << "######OMS PIPELINE TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+    void test_oms_pipeline_invalid_transitions()
+    {
+        //Reports after a terminal state or for unknown ids are counted and ignored
+        oms_pipeline::ExecutionPipeline oms(64, 16, 4, 32);
+        TestRiskSink rms;
+        oms.add_order(1, 2, 100, true);
+        oms.push(ExecReport{1, ExecType::NEW, 0, 0});
+        oms.push(ExecReport{1, ExecType::REJECTED, 0, 0});      // rejected after the ack
+        oms.push(ExecReport{1, ExecType::CANCELLED, 0, 0});
+        oms.push(ExecReport{1, ExecType::FILL, 100, 9.99});     // after the cancel
+        oms.push(ExecReport{7, ExecType::FILL, 100, 9.99});
+        assert(oms.process_batch(rms, 2) == 2);
+        assert(oms.process_batch(rms, 32) == 3);
+        assert(oms.invalid_transitions() == 1);
+        assert(oms.reports_for_unknown_orders() == 2);
+        assert(rms.calls == 0 && oms.live_orders() == 0);
+
+        //A fill report of no quantity is rejected and leaves the order as it was
+        oms.add_order(2, 2, 100, true);
+        oms.push(ExecReport{2, ExecType::PARTIAL_FILL, 0, 9.99});
+        oms.push(ExecReport{2, ExecType::PARTIAL_FILL, 10, 9.99});
+        assert(oms.process_batch(rms, 32) == 2);
+        assert(oms.invalid_transitions() == 2 && oms.find(2)->cum_qty == 10 && oms.find(2)->avg_price == 9.99);
+        std::cout << "######OMS PIPELINE TEST CASE 2 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_oms_execution_pipeline_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_oms_pipeline_fills_and_deltas();
+        test_oms_pipeline_invalid_transitions();
+    }
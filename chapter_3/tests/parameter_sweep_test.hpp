@@ -0,0 +1,78 @@
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <unistd.h>
+#include "../parameter_sweep.hpp"
+
+    void test_parameter_sweep_matches_single_runs()
+    {
+        //Event file round trip: the mapped views hold the streams' events
+        std::vector<backtest::EventStream> streams;
+        for (unsigned s = 0; s < 3; s++)
+            streams.push_back(synthetic_stream(10 + s, s, 2000 + s * 300));    // backtester_test.hpp
+        std::vector<const backtest::EventStream*> day = {&streams[0], &streams[1], &streams[2]};
+        std::string path = "/tmp/parameter_sweep_test_" + std::to_string(getpid());
+        sweep::EventFile::save(path + ".events", day);
+        sweep::EventFile file = sweep::EventFile::open(path + ".events");
+        assert(file.streams().size() == 3);
+        for (size_t s = 0; s < 3; s++) {
+            assert(file.streams()[s].count == streams[s].size());
+            assert(std::memcmp(file.streams()[s].events, streams[s].data(), streams[s].size() * sizeof(backtest::MarketEvent)) == 0);
+        }
+
+        //Every run of the sweep equals a fresh backtest with the same parameters
+        std::vector<strategy::StrategyParams> grid;
+        for (double edge : {0.0, 0.05, 0.5, 1.0})
+            for (int quantity : {50, 100}) {
+                strategy::StrategyParams p;
+                p.edge = edge;
+                p.quantity = quantity;
+                grid.push_back(p);
+            }
+        strategy::StrategyParams seller;
+        seller.buy_bid_above = 1e9;
+        seller.sell_offer_above = 100;
+        seller.sell_bid_below = 200;
+        seller.edge = 0.1;
+        grid.push_back(seller);
+        backtest::BacktestConfig config;
+        config.latency = 300;
+        config.sample_interval = 50000;
+        sweep::SweepResults results = sweep::run_sweep(file.streams(), grid, config);
+        assert(results.runs() == grid.size());
+        double fills = 0;
+        for (size_t run = 0; run < grid.size(); run++) {
+            const strategy::StrategyParams p = grid[run];
+            backtest::Backtester<strategy::StrategyModule> backtester(3, config,
+                [&](circular_array::LimitOrderBook& b, strategy::OrderGateway& g) { return strategy::StrategyModule(b, g, p); });
+            backtest::BacktestResult r = backtester.run(day);
+            assert(results.at(sweep::EDGE, run) == p.edge && results.at(sweep::QUANTITY, run) == p.quantity);
+            assert(results.at(sweep::REALIZED, run) == r.pnl.back().realized && results.at(sweep::UNREALIZED, run) == r.pnl.back().unrealized);
+            assert(results.at(sweep::FILLS, run) == r.fills && results.at(sweep::EVENTS, run) == r.events);
+            assert(results.at(sweep::MAX_DRAWDOWN, run) == sweep::max_drawdown(r.pnl) && results.at(sweep::MAX_DRAWDOWN, run) >= 0);
+            fills += r.fills;
+        }
+        assert(fills > 0 && results.at(sweep::FILLS, 0) != results.at(sweep::FILLS, 6));
+
+        //Columnar results file round trip
+        results.save(path + ".sweep");
+        sweep::SweepResults loaded = sweep::SweepResults::load(path + ".sweep");
+        assert(loaded.runs() == results.runs());
+        for (int c = 0; c < sweep::NUM_COLUMNS; c++)
+            assert(std::equal(results.column(sweep::Column(c)), results.column(sweep::Column(c)) + results.runs(), loaded.column(sweep::Column(c))));
+        std::remove((path + ".events").c_str());
+        std::remove((path + ".sweep").c_str());
+        std::cout << "######PARAMETER SWEEP TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_parameter_sweep_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_parameter_sweep_matches_single_runs();
+    }
@@ -0,0 +1,56 @@
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include "../../chapter_4/portfolio_book.hpp"
+
+    void test_portfolio_book_incremental_value()
+    {
+        //Trades and marks move the cached total; it always equals cash + sum of quantity x mark
+        portfolio_book::PortfolioBook book(1000, 10000.0);
+        assert(book.buy(7, 10, 50.0) && book.cash_balance() == 9500 && book.total_value() == 10000);
+        assert(!book.buy(8, 1000, 50.0) && book.cash_balance() == 9500);                 // not enough cash
+        assert(!book.sell(9, 1, 10.0) && !book.sell(7, 11, 50.0));                      // not enough assets
+        book.mark(7, 55.0);
+        book.mark(500, 1.0);                                                             // not held: nothing to revalue
+        assert(book.revalue() == 1 && book.total_value() == 10050);
+        assert(book.sell(7, 10, 60.0) && book.held().empty() && book.total_value() == 10100);
+        assert(book.add(3, 2.5) && !book.add(3, -3) && book.quantity_of(3) == 2.5 && book.held().size() == 1);
+        book.mark(3, 4.0);
+        assert(book.total_value() == 10110);
+        assert(book.buy(2000, 1, 10.0) && book.universe() == 2001 && book.quantity_of(2000) == 1);   // grows
+
+        //Random trades and price moves over a universe: the running total never drifts from a full sum
+        std::mt19937 generator(8);
+        std::vector<double> price(1000, 20.0);
+        for (int i = 0; i < 20000; i++) {
+            int32_t asset = static_cast<int32_t>(generator() % 1000);
+            price[asset] *= 1 + (static_cast<int>(generator() % 201) - 100) * 0.0005;
+            if (generator() % 3 == 0)
+                book.buy(asset, 1 + generator() % 5, price[asset]);
+            else if (generator() % 3 == 0)
+                book.sell(asset, book.quantity_of(asset) / 2, price[asset]);
+            else
+                book.mark(asset, price[asset]);
+            if (i % 97 == 0) {
+                double expected = book.cash_balance();
+                for (int32_t a = 0; a < static_cast<int32_t>(book.universe()); a++)
+                    expected += book.quantity_of(a) * book.mark_of(a);
+                assert(std::abs(book.total_value() - expected) < 1e-6 * std::abs(expected));
+            }
+        }
+        for (int32_t a : book.held())
+            assert(book.quantity_of(a) != 0);
+        std::cout << "######PORTFOLIO BOOK TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_portfolio_book_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_portfolio_book_incremental_value();
+    }
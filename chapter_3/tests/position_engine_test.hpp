@@ -0,0 +1,81 @@
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include "../position_engine.hpp"
+
+    void test_position_engine_avg_cost_and_realized()
+    {
+        //Adding moves the average cost, reducing realises, flipping re-opens at the fill price
+        position_engine::PositionEngine engine(4);
+        engine.on_fill(1, 100, 10.00);
+        engine.on_fill(1, 100, 11.00);
+        assert(engine.instrument(1).position == 200 && std::abs(engine.instrument(1).avg_cost - 10.50) < 1e-9);
+
+        engine.on_fill(1, -50, 12.00);
+        assert(std::abs(engine.instrument(1).realized - 75.0) < 1e-9);
+        assert(std::abs(engine.instrument(1).avg_cost - 10.50) < 1e-9);
+
+        engine.on_fill(1, -200, 10.00);
+        assert(engine.instrument(1).position == -50);
+        assert(std::abs(engine.instrument(1).realized - (75.0 - 75.0)) < 1e-9);
+        assert(std::abs(engine.instrument(1).avg_cost - 10.00) < 1e-9);
+        assert(std::abs(engine.portfolio().realized) < 1e-9);
+        std::cout << "######POSITION ENGINE TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+    void test_position_engine_dirty_revalue()
+    {
+        //Only instruments with a new fill or a moved mid are revalued; totals follow incrementally
+        position_engine::PositionEngine engine(4);
+        engine.on_fill(0, 10, 100.00);
+        engine.on_fill(2, -20, 50.00);
+        engine.on_bbo(0, 100.90, 101.10);
+        engine.on_bbo(2, 49.90, 50.10);
+        assert(engine.revalue() == 2);
+        assert(std::abs(engine.portfolio().unrealized - 10.0) < 1e-9);
+        assert(std::abs(engine.portfolio().gross_exposure - (10 * 101.0 + 20 * 50.0)) < 1e-9);
+
+        engine.on_bbo(2, 49.90, 50.10);             // same mid: not dirty
+        engine.on_bbo(2, 48.90, 49.10);
+        assert(engine.pending_revalue() == 1);
+        engine.revalue();
+        assert(std::abs(engine.portfolio().unrealized - (10.0 + 20.0)) < 1e-9);
+
+        double unrealized = engine.portfolio().unrealized;
+        engine.resync();
+        assert(std::abs(engine.portfolio().unrealized - unrealized) < 1e-9);
+
+        //A fill before the instrument's first BBO is marked at its own price, not at 0
+        engine.on_fill(3, 100, 10.00);
+        engine.revalue();
+        assert(std::abs(engine.instrument(3).unrealized) < 1e-9 && std::abs(engine.instrument(3).exposure - 1000.0) < 1e-9);
+        std::cout << "######POSITION ENGINE TEST CASE 2 PASSED" << std::endl<< std::endl;
+    }
+    void test_position_engine_mixed_oms_batch()
+    {
+        //A buy and a sell of the same symbol in one OMS batch: the sell realises against the buy's cost
+        oms_pipeline::ExecutionPipeline oms(16, 8, 2, 16);
+        position_engine::PositionEngine engine(2);
+        oms.add_order(1, 0, 100, true);
+        oms.add_order(2, 0, 50, false);
+        oms.push(oms_pipeline::ExecReport{1, oms_pipeline::ExecType::PARTIAL_FILL, 60, 10.00});
+        oms.push(oms_pipeline::ExecReport{1, oms_pipeline::ExecType::FILL, 40, 10.00});
+        oms.push(oms_pipeline::ExecReport{2, oms_pipeline::ExecType::FILL, 50, 11.00});
+        assert(oms.process_batch(engine, 16) == 3);
+        engine.on_bbo(0, 9.90, 10.10);
+        engine.revalue();
+        assert(engine.instrument(0).position == 50 && std::abs(engine.instrument(0).avg_cost - 10.00) < 1e-9);
+        assert(std::abs(engine.instrument(0).realized - 50.0) < 1e-9 && std::abs(engine.instrument(0).unrealized) < 1e-9);
+        std::cout << "######POSITION ENGINE TEST CASE 3 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_position_engine_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_position_engine_avg_cost_and_realized();
+        test_position_engine_dirty_revalue();
+        test_position_engine_mixed_oms_batch();
+    }
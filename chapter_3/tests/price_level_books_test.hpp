@@ -0,0 +1,208 @@
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <type_traits>
+#include "../exploring_skip_list.hpp"
+#include "../exploring_bplus_tree.hpp"
+#include "../exploring_dary_heap.hpp"
+#include "../exploring_hash_table.hpp"
+
+    void test_skip_list_best_and_worst(bool is_bid)
+    {
+        skip_list::LimitOrderBook lob(2, 10);
+
+        lob.add_order(skip_list::Order(1, 29500.22, 100), is_bid);
+        lob.add_order(skip_list::Order(2, 29500.24, 200), is_bid);
+        lob.add_order(skip_list::Order(3, 29500.21, 300), is_bid);
+        lob.add_order(skip_list::Order(4, 29500.23, 400), is_bid);
+        if (is_bid){
+            lob.print_bids();
+            assert(lob.get_best_bid().id == 2);
+            assert(lob.get_lowest_bid().id == 3);
+        }
+        else{
+            lob.print_offers();
+            assert(lob.get_best_offer().id == 3);
+            assert(lob.get_highest_offer().id == 2);
+        }
+        std::cout << "######SKIP LIST TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+    void test_skip_list_full_book(bool is_bid)
+    {
+        //Full book: a worse price is discarded, a better one evicts the worst level
+        skip_list::LimitOrderBook lob(2, 3);
+
+        lob.add_order(skip_list::Order(1, 29500.21, 100), is_bid);
+        lob.add_order(skip_list::Order(2, 29500.22, 200), is_bid);
+        lob.add_order(skip_list::Order(3, 29500.23, 300), is_bid);
+        if (is_bid){
+            lob.add_order(skip_list::Order(4, 29500.20, 400), is_bid);
+            assert(lob.get_lowest_bid().id == 1);
+            lob.add_order(skip_list::Order(5, 29500.24, 500), is_bid);
+            lob.print_bids();
+            assert(lob.get_lowest_bid().id == 2);
+            assert(lob.get_best_bid().id == 5);
+        }
+        else{
+            lob.add_order(skip_list::Order(4, 29500.24, 400), is_bid);
+            assert(lob.get_highest_offer().id == 3);
+            lob.add_order(skip_list::Order(5, 29500.20, 500), is_bid);
+            lob.print_offers();
+            assert(lob.get_highest_offer().id == 2);
+            assert(lob.get_best_offer().id == 5);
+        }
+        std::cout << "######SKIP LIST TEST CASE 2 PASSED" << std::endl<< std::endl;
+    }
+    void test_skip_list_delete_best(bool is_bid)
+    {
+        //Deleting the best level must expose the next one
+        skip_list::LimitOrderBook lob(2, 5);
+
+        lob.add_order(skip_list::Order(1, 29500.21, 100), is_bid);
+        lob.add_order(skip_list::Order(2, 29500.22, 200), is_bid);
+        lob.add_order(skip_list::Order(3, 29500.23, 300), is_bid);
+        if (is_bid){
+            lob.delete_order(skip_list::Order(3, 29500.23, 300), is_bid);
+            assert(lob.get_best_bid().id == 2);
+            lob.delete_order(skip_list::Order(1, 29500.21, 100), is_bid);
+            assert(lob.get_lowest_bid().id == 2);
+        }
+        else{
+            lob.delete_order(skip_list::Order(1, 29500.21, 100), is_bid);
+            assert(lob.get_best_offer().id == 2);
+            lob.delete_order(skip_list::Order(3, 29500.23, 300), is_bid);
+            assert(lob.get_highest_offer().id == 2);
+        }
+        std::cout << "######SKIP LIST TEST CASE 3 PASSED" << std::endl<< std::endl;
+    }
+    void test_bplus_tree_levels_and_cancel(bool is_bid)
+    {
+        //Several orders per level: quantities aggregate, cancel by id only removes the level once empty
+        bplus_tree::LimitOrderBook lob(2, 10);
+
+        lob.add_order(bplus_tree::Order(1, 29500.21, 100), is_bid);
+        lob.add_order(bplus_tree::Order(2, 29500.22, 200), is_bid);
+        lob.add_order(bplus_tree::Order(3, 29500.22, 300), is_bid);
+        lob.add_order(bplus_tree::Order(4, 29500.20, 400), is_bid);
+        bplus_tree::Order best = is_bid ? lob.get_best_bid() : lob.get_best_offer();
+        if (is_bid){
+            lob.print_bids();
+            assert(best.id == 2 && best.quantity == 500);
+        }
+        else{
+            lob.print_offers();
+            assert(best.id == 4 && best.quantity == 400);
+        }
+        lob.delete_order(bplus_tree::Order(2, 0, 0), is_bid);
+        if (is_bid){
+            assert(lob.get_best_bid().id == 3 && lob.get_best_bid().quantity == 300);
+            lob.delete_order(bplus_tree::Order(3, 0, 0), is_bid);
+            assert(lob.get_best_bid().id == 1);
+        }
+        else{
+            lob.delete_order(bplus_tree::Order(4, 0, 0), is_bid);
+            assert(lob.get_best_offer().id == 1);
+        }
+        std::cout << "######B+TREE TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+    void test_bplus_tree_deep_book(bool is_bid)
+    {
+        //Enough levels to split leaves and inner nodes; depth walk must stay sorted
+        const int depth = 500;
+        bplus_tree::LimitOrderBook lob(2, depth);
+        for (int i = 0; i < depth; i++)
+            lob.add_order(bplus_tree::Order(i + 1, 100.00 + ((i * 37) % depth) * 0.01, 100), is_bid);
+        for (int i = 0; i < depth; i += 2)
+            lob.delete_order(bplus_tree::Order(i + 1, 0, 0), is_bid);
+
+        int levels = 0;
+        double last = is_bid ? 1e9 : 0;
+        lob.for_each_level(is_bid, depth, [&](const bplus_tree::Order& o) {
+            assert(is_bid ? o.price < last : o.price > last);
+            last = o.price;
+            levels++;
+        });
+        assert(levels == depth / 2);
+
+        //Churn on the sparse leaves: the fixed node pools absorb it without growing
+        int id = depth + 1;
+        for (int round = 0; round < 20; round++) {
+            int first = id;
+            for (int i = 0; i < depth / 2; i++)
+                lob.add_order(bplus_tree::Order(id++, 200.00 + round * 10 + i * 0.02, 100), is_bid);
+            for (int i = first; i < id; i++)
+                lob.delete_order(bplus_tree::Order(i, 0, 0), is_bid);
+        }
+        levels = 0;
+        lob.for_each_level(is_bid, depth, [&](const bplus_tree::Order&) { levels++; });
+        assert(levels == depth / 2);
+        std::cout << "######B+TREE TEST CASE 2 PASSED" << std::endl<< std::endl;
+    }
+    void test_dary_heap_delete_and_update(bool is_bid)
+    {
+        //Arbitrary delete re-positions the heap in place; updates keep the level
+        dary_heap::LimitOrderBook lob(2, 4);
+        static_assert(!std::is_copy_constructible<dary_heap::LimitOrderBook>::value && !std::is_move_constructible<dary_heap::LimitOrderBook>::value,
+                      "the heaps point into the book's own level vector");
+
+        lob.add_order(dary_heap::Order(1, 29500.21, 100), is_bid);
+        lob.add_order(dary_heap::Order(2, 29500.22, 200), is_bid);
+        lob.add_order(dary_heap::Order(3, 29500.23, 300), is_bid);
+        lob.add_order(dary_heap::Order(4, 29500.24, 400), is_bid);
+        lob.update_order(dary_heap::Order(5, 29500.22, 250), is_bid);
+        lob.delete_order(dary_heap::Order(3, 29500.23, 300), is_bid);
+        if (is_bid){
+            lob.print_bids();
+            assert(lob.get_best_bid().id == 4);
+            lob.delete_order(dary_heap::Order(4, 29500.24, 400), is_bid);
+            assert(lob.get_best_bid().id == 5 && lob.get_best_bid().quantity == 250);
+            assert(lob.get_lowest_bid().id == 1);
+        }
+        else{
+            lob.print_offers();
+            assert(lob.get_best_offer().id == 1);
+            lob.delete_order(dary_heap::Order(1, 29500.21, 100), is_bid);
+            assert(lob.get_best_offer().id == 5 && lob.get_best_offer().quantity == 250);
+            assert(lob.get_highest_offer().id == 4);
+        }
+        std::cout << "######D-ARY HEAP TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+    void test_flat_hash_table_best_after_delete(bool is_bid)
+    {
+        //Deleting the best (or the worst) level must move the tracked prices, no stale pointers
+        hash_table::FlatLimitOrderBook lob(2, 4);
+
+        lob.add_order(hash_table::Order(1, 29500.21, 100), is_bid);
+        lob.add_order(hash_table::Order(2, 29500.22, 200), is_bid);
+        lob.add_order(hash_table::Order(3, 29500.23, 300), is_bid);
+        if (is_bid){
+            lob.delete_order(hash_table::Order(3, 29500.23, 300), is_bid);
+            assert(lob.get_best_bid().id == 2);
+            lob.delete_order(hash_table::Order(1, 29500.21, 100), is_bid);
+            assert(lob.get_lowest_bid().id == 2);
+        }
+        else{
+            lob.delete_order(hash_table::Order(1, 29500.21, 100), is_bid);
+            assert(lob.get_best_offer().id == 2);
+            lob.delete_order(hash_table::Order(3, 29500.23, 300), is_bid);
+            assert(lob.get_highest_offer().id == 2);
+        }
+        std::cout << "######FLAT HASH TABLE TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_price_level_books_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        for (bool is_bid : {true, false}) {
+            test_skip_list_best_and_worst(is_bid);
+            test_skip_list_full_book(is_bid);
+            test_skip_list_delete_best(is_bid);
+            test_bplus_tree_levels_and_cancel(is_bid);
+            test_bplus_tree_deep_book(is_bid);
+            test_dary_heap_delete_and_update(is_bid);
+            test_flat_hash_table_best_after_delete(is_bid);
+        }
+    }
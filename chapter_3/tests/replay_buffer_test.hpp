@@ -0,0 +1,100 @@
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include "../../chapter_4/replay_buffer.hpp"
+
+    void test_replay_ring_and_priorities()
+    {
+        //Capacity 8, 10 experiences: the 2 oldest are overwritten; a high TD error dominates sampling
+        replay::ReplayBuffer buffer(8, 3, 1.0);
+        for (int i = 0; i < 10; i++) {
+            float state[3] = {static_cast<float>(i), 0, 0};
+            float next_state[3] = {static_cast<float>(i + 1), 0, 0};
+            buffer.add(state, i % 3, static_cast<float>(i), next_state, i == 9);
+        }
+        assert(buffer.size() == 8 && buffer.stride() == 16 && buffer.dropped_adds() == 0);
+        assert(buffer.total_priority() == 8 * replay::to_fixed(1.0));
+
+        std::mt19937_64 rng(3);
+        replay::SampleBatch batch;
+        assert(buffer.sample(8, 0.5, rng, batch) == 8);
+        for (size_t k = 0; k < batch.rows; k++) {
+            const float* s = &batch.states[k * batch.stride];
+            assert(s[0] >= 2 && s[0] == batch.rewards[k] && batch.next_states[k * batch.stride] == s[0] + 1);
+            assert(batch.actions[k] == static_cast<int>(s[0]) % 3 && batch.dones[k] == (s[0] == 9));
+            assert(s[3] == 0 && s[15] == 0);
+            assert(std::abs(batch.weights[k] - 1.0f) < 1e-6);   // equal priorities
+        }
+
+        //TD error 99 on the experience with reward 5, ~0 on the others: priority 99 vs 0.001
+        std::vector<float> td(batch.rows, 0.0f);
+        for (size_t k = 0; k < batch.rows; k++)
+            if (batch.rewards[k] == 5)
+                td[k] = 99;
+        buffer.update_priorities(batch, td.data());
+        size_t hits = 0, rows = 0;
+        for (int n = 0; n < 100; n++) {
+            rows += buffer.sample(4, 1.0, rng, batch);
+            for (size_t k = 0; k < batch.rows; k++)
+                hits += batch.rewards[k] == 5;
+        }
+        assert(rows == 400 && hits > 390);
+        std::cout << "######REPLAY BUFFER TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+    void test_replay_concurrent_actors()
+    {
+        //Two actors insert while a learner samples and updates priorities: every sampled row is consistent
+        replay::ReplayBuffer buffer(1024, 4);
+        const int per_actor = 20000;
+        auto actor = [&](int id) {
+            for (int i = 0; i < per_actor; i++) {
+                float value = static_cast<float>(id * per_actor + i);
+                float state[4] = {value, value, value, value};
+                float next_state[4] = {value + 1, value + 1, value + 1, value + 1};
+                buffer.add(state, id, value, next_state, false);
+            }
+        };
+        std::thread a(actor, 0), b(actor, 1);
+        std::mt19937_64 rng(5);
+        replay::SampleBatch batch;
+        size_t checked = 0;
+        while (buffer.size() < 64)
+            std::this_thread::yield();
+        for (int n = 0; n < 400; n++) {
+            buffer.sample(64, 0.4, rng, batch);
+            std::vector<float> td(batch.rows);
+            for (size_t k = 0; k < batch.rows; k++) {
+                const float* s = &batch.states[k * batch.stride];
+                const float* ns = &batch.next_states[k * batch.stride];
+                assert(s[0] == batch.rewards[k] && s[3] == s[0] && ns[0] == s[0] + 1 && ns[3] == ns[0]);
+                assert(batch.actions[k] == (s[0] >= per_actor ? 1 : 0));
+                td[k] = static_cast<float>(k % 7);
+                checked++;
+            }
+            buffer.update_priorities(batch, td.data());
+        }
+        a.join();
+        b.join();
+        assert(buffer.size() == 1024 && checked > 0);
+
+        //The tree root is still exactly the sum of the leaves
+        uint64_t sum = 0;
+        for (size_t slot = 0; slot < buffer.capacity(); slot++)
+            sum += buffer.leaf_priority(slot);
+        assert(sum == buffer.total_priority());
+        std::cout << "######REPLAY BUFFER TEST CASE 2 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_replay_buffer_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_replay_ring_and_priorities();
+        test_replay_concurrent_actors();
+    }
@@ -0,0 +1,124 @@
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "../risk_rules.hpp"
+
+using risk_rules::RuleEngine;
+using risk_rules::RuleSpec;
+using risk_rules::RuleKind;
+using risk_rules::Alert;
+
+    void test_risk_rules_touched_and_dedup()
+    {
+        //Only touched instruments are checked; a breach alerts once, again only after clearing
+        std::vector<RuleSpec> rules = {
+            {1, RuleKind::EXPOSURE, risk_rules::ALL_INSTRUMENTS, 5000.0},
+            {2, RuleKind::EXPOSURE, 3, 1000.0},
+        };
+        RuleEngine engine(4, rules, risk_rules::AlertLimits{64, 1000000000ull, 10, 10, 1000000000ull});
+        assert(engine.num_checks() == 5);
+
+        position_engine::PositionEngine positions(4);
+        positions.on_fill(0, 100, 100.00);
+        positions.on_fill(3, 20, 100.00);
+        positions.on_bbo(0, 99.99, 100.01);
+        positions.on_bbo(3, 99.99, 100.01);
+        positions.revalue();
+        engine.touch(3);
+
+        Alert alert;
+        assert(engine.evaluate(positions, 1000) == 1);
+        assert(engine.next_alert(alert) && alert.rule == 2 && alert.instrument == 3 && std::abs(alert.value - 2000.0) < 1e-6);
+        assert(!engine.next_alert(alert));   // instrument 0 is over its limit but was not touched
+
+        engine.touch(3);
+        engine.evaluate(positions, 2000);
+        assert(!engine.next_alert(alert));   // still in breach: no repeat before repeat_ns
+
+        positions.on_fill(3, -15, 100.00);
+        positions.revalue();
+        engine.touch(3);
+        engine.evaluate(positions, 3000);
+        positions.on_fill(3, 15, 100.00);
+        positions.revalue();
+        engine.touch(3);
+        engine.evaluate(positions, 4000);
+        assert(engine.next_alert(alert) && alert.rule == 2);   // cleared, then breached again
+        std::cout << "######RISK RULES TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+    void test_risk_rules_rate_limit()
+    {
+        //An alert storm only lets "burst" alerts through; the rest are counted, not retried every cycle
+        std::vector<RuleSpec> rules = {{7, RuleKind::ORDER_RATE, risk_rules::ALL_INSTRUMENTS, 2}};
+        RuleEngine engine(100, rules, risk_rules::AlertLimits{64, 1000000000ull, 4, 1000, 10000000000ull});
+        position_engine::PositionEngine positions(100);
+        for (int i = 0; i < 100; i++)
+            for (int k = 0; k < 3; k++)
+                engine.on_order(i, 10);
+
+        engine.evaluate(positions, 10);
+        Alert alert;
+        int sent = 0;
+        while (engine.next_alert(alert))
+            sent++;
+        assert(sent == 4 && engine.suppressed_alerts() == 96 && engine.pending_checks() == 0);
+
+        for (int i = 0; i < 100; i++)
+            engine.touch(i);
+        engine.evaluate(positions, 10 + 10000000ull);   // 10ms later, still in breach: inside repeat_ns
+        assert(!engine.next_alert(alert) && engine.suppressed_alerts() == 96);
+
+        for (int i = 0; i < 100; i++)
+            engine.touch(i);
+        engine.evaluate(positions, 1000000010ull);     // 1s later: repeated, tokens capped at the burst of 4
+        sent = 0;
+        while (engine.next_alert(alert))
+            sent++;
+        assert(sent == 4 && engine.suppressed_alerts() == 192);
+
+        for (int i = 0; i < 100; i++)
+            engine.touch(i);
+        assert(engine.evaluate(positions, 20000000000ull) == 100);   // next window: order counts reset
+        assert(!engine.next_alert(alert));
+        std::cout << "######RISK RULES TEST CASE 2 PASSED" << std::endl<< std::endl;
+    }
+    void test_risk_rules_portfolio()
+    {
+        //Portfolio drawdown from the intraday peak, concentration against gross exposure
+        std::vector<RuleSpec> rules = {
+            {1, RuleKind::DRAWDOWN, risk_rules::PORTFOLIO, 500.0},
+            {2, RuleKind::CONCENTRATION, risk_rules::ALL_INSTRUMENTS, 0.6},
+        };
+        RuleEngine engine(2, rules, risk_rules::AlertLimits{64, 1000000000ull, 10, 10, 1000000000ull});
+        position_engine::PositionEngine positions(2);
+        positions.on_fill(0, 100, 10.00);
+        positions.on_fill(1, 100, 10.00);
+        positions.on_bbo(0, 19.99, 20.01);
+        positions.on_bbo(1, 9.99, 10.01);
+        positions.revalue();
+        engine.touch(0);
+        engine.touch(1);
+        engine.evaluate(positions, 1000);
+        Alert alert;
+        assert(engine.next_alert(alert) && alert.rule == 2 && alert.instrument == 0);   // 2000 of 3000
+        assert(!engine.next_alert(alert));
+
+        positions.on_bbo(0, 13.99, 14.01);   // PnL 1000 -> 400
+        positions.revalue();
+        engine.evaluate(positions, 2000);
+        assert(engine.next_alert(alert) && alert.rule == 1 && alert.instrument == risk_rules::PORTFOLIO && std::abs(alert.value - 600.0) < 1e-6);
+        std::cout << "######RISK RULES TEST CASE 3 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_risk_rules_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_risk_rules_touched_and_dedup();
+        test_risk_rules_rate_limit();
+        test_risk_rules_portfolio();
+    }
@@ -0,0 +1,70 @@
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include "../tca.hpp"
+
+    void test_tca_slippage_and_markouts()
+    {
+        //Buy 100 @ 100.02, arrival mid 100.00: 2bps slippage, 4bps effective spread,
+        //markouts against the mid 1s / 5s / 60s after the fill
+        const uint64_t s = 1000000000ull;
+        tca::TcaEngine engine(1, 2, 16);
+        engine.on_order(1, 0, tca::OrderEvent::SENT);
+        engine.on_order(1, 0, tca::OrderEvent::SENT);
+        engine.on_order(1, 0, tca::OrderEvent::REJECTED);
+        engine.on_book(0, 0, 99.99, 100.01);
+        engine.on_book(0, 1 * s, 99.99, 100.01);
+        engine.on_fill(tca::Fill{2 * s, 0, 0, 1, 100, true, 100.02});
+        engine.on_book(0, 3500000000ull, 100.04, 100.06);
+        engine.on_book(0, 7500000000ull, 99.94, 99.96);
+        assert(engine.pending_fills() == 1);
+        engine.on_book(0, 62500000000ull, 100.09, 100.11);
+        assert(engine.pending_fills() == 0);
+
+        tca::VenueTca v = engine.venue(1);
+        assert(v.orders == 2 && v.fills == 1 && v.rejects == 1 && v.quantity == 100);
+        assert(std::abs(v.fill_rate - 0.5) < 1e-9 && std::abs(v.reject_rate - 0.5) < 1e-9);
+        assert(std::abs(v.slippage_bps - 2.0) < 1e-6);
+        assert(std::abs(v.effective_spread_bps - 4.0) < 1e-6);
+        assert(std::abs(v.markout_bps[0] - (-2.0)) < 1e-6);     // mid still 100.00 at 3s
+        assert(std::abs(v.markout_bps[1] - 3.0) < 1e-6);        // 100.05 at 7s
+        assert(std::abs(v.realized_spread_bps - (-6.0)) < 1e-6);
+        assert(std::abs(v.markout_bps[2] - (-7.0)) < 1e-6);     // 99.95 at 62s
+        assert(engine.venue(0).fills == 0);
+        std::cout << "######TCA TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+    void test_tca_window_and_capacity()
+    {
+        //Venue statistics only cover the last 5 minutes; a full pending ring drops the oldest markouts
+        const uint64_t ms = 1000000ull;
+        tca::TcaEngine engine(1, 1, 2);
+        engine.on_book(0, 0, 9.99, 10.01);
+        engine.on_fill(tca::Fill{1 * ms, 0, 0, 0, 10, false, 9.99});
+        engine.on_fill(tca::Fill{2 * ms, 0, 0, 0, 10, false, 9.99});
+        engine.on_fill(tca::Fill{3 * ms, 0, 0, 0, 10, false, 9.99});
+        assert(engine.dropped_markouts() == 1 && engine.pending_fills() == 2);
+        assert(engine.venue(0).fills == 3 && std::abs(engine.venue(0).slippage_bps - 10.0) < 1e-6);
+
+        engine.on_book(0, 100000 * ms, 9.99, 10.01);
+        assert(engine.pending_fills() == 0 && engine.venue(0).fills == 3);
+        engine.on_book(0, 400000 * ms, 9.99, 10.01);
+        assert(engine.venue(0).fills == 0 && engine.venue(0).slippage_bps == 0);
+
+        //A parent older than the mid history has no arrival mid unless the caller passes it
+        engine.on_fill(tca::Fill{410000 * ms, 1 * ms, 0, 0, 10, false, 9.99});
+        assert(engine.dropped_arrivals() == 1 && engine.venue(0).slippage_bps == 0);
+        engine.on_fill(tca::Fill{410000 * ms, 1 * ms, 0, 0, 10, false, 9.99, 10.00});
+        assert(engine.dropped_arrivals() == 1 && std::abs(engine.venue(0).slippage_bps - 10.0) < 1e-6);
+        std::cout << "######TCA TEST CASE 2 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_tca_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_tca_slippage_and_markouts();
+        test_tca_window_and_capacity();
+    }
@@ -0,0 +1,100 @@
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../thread_placement.hpp"
+
+    void test_thread_placement_layout()
+    {
+        //A copy of sysfs for 2 sockets (= nodes) x 2 cores x 2 hyperthreads: cpu c is core
+        //(c / 2) % 2 of socket c / 4, siblings are c and c ^ 1
+        std::string root = "/tmp/thread_placement_test_" + std::to_string(getpid());
+        auto write = [](const std::string& path, const std::string& text) { std::ofstream(path) << text << "\n"; };
+        mkdir(root.c_str(), 0755);
+        mkdir((root + "/cpu").c_str(), 0755);
+        mkdir((root + "/node").c_str(), 0755);
+        write(root + "/cpu/online", "0-7");
+        write(root + "/node/online", "0-1");
+        for (int cpu = 0; cpu < 8; cpu++) {
+            std::string dir = root + "/cpu/cpu" + std::to_string(cpu);
+            mkdir(dir.c_str(), 0755);
+            mkdir((dir + "/topology").c_str(), 0755);
+            write(dir + "/topology/core_id", std::to_string((cpu / 2) % 2));
+            write(dir + "/topology/physical_package_id", std::to_string(cpu / 4));
+        }
+        for (int node = 0; node < 2; node++) {
+            mkdir((root + "/node/node" + std::to_string(node)).c_str(), 0755);
+            write(root + "/node/node" + std::to_string(node) + "/cpulist", node == 0 ? "0-3" : "4-7");
+        }
+        placement::Topology topology = placement::Topology::read(root);
+        std::system(("rm -rf " + root).c_str());
+        assert(topology.cpus().size() == 8 && topology.num_nodes() == 2);
+        assert(topology.find(5)->package == 1 && topology.find(5)->node == 1 && topology.find(5)->core == 0);
+        assert(topology.same_core(4, 5) && !topology.same_core(1, 2) && !topology.same_core(0, 4));
+        assert(topology.physical_cores() == std::vector<int>({0, 2, 4, 6}));
+
+        //Two physical cores on the first node: the hot roles wrap around and the check says so
+        placement::ThreadPlacement automatic(topology, placement::PlacementConfig::automatic(topology));
+        assert(automatic.cpu_of(placement::FEED) == 0 && automatic.cpu_of(placement::BOOK) == 2 && automatic.cpu_of(placement::STRATEGY) == 0);
+        assert(!automatic.warnings().empty() && automatic.node_of(placement::OMS) == 0);
+
+        //An explicit layout: hyperthread siblings and a NUMA crossing are reported, an offline cpu throws
+        placement::ThreadPlacement layout(topology, placement::PlacementConfig::parse("feed=2,book=3,strategy=6,oms=7,logger=0"));
+        assert(layout.cpu_of(placement::HUB) == -1 && layout.node_of(placement::STRATEGY) == 1);
+        assert(layout.warnings().size() == 3);   // feed/book siblings, strategy/oms siblings, book -> strategy crosses nodes
+        assert(layout.report().find("strategy: cpu 6 (core 1, socket 1, node 1)") != std::string::npos);
+        bool thrown = false;
+        try { placement::ThreadPlacement bad(topology, placement::PlacementConfig::parse("book=9")); }
+        catch (const std::runtime_error&) { thrown = true; }
+        assert(thrown);
+        thrown = false;
+        try { placement::PlacementConfig::parse("books=1"); }
+        catch (const std::runtime_error&) { thrown = true; }
+        assert(thrown);
+
+        //Process start: the spec when there is one, the automatic layout otherwise; the report goes to the log
+        assert(placement::ThreadPlacement::configure(topology, "book=4,strategy=6").cpu_of(placement::STRATEGY) == 6);
+        assert(placement::ThreadPlacement::configure(topology, "").cpu_of(placement::BOOK) == automatic.cpu_of(placement::BOOK));
+        assert(placement::ThreadPlacement::configure(topology, nullptr).cpu_of(placement::OMS) == automatic.cpu_of(placement::OMS));
+        setenv("THREAD_PLACEMENT_TEST", "book=0", 1);
+        std::ostringstream log;
+        placement::ThreadPlacement started = placement::ThreadPlacement::startup("THREAD_PLACEMENT_TEST", log);
+        unsetenv("THREAD_PLACEMENT_TEST");
+        assert(started.cpu_of(placement::BOOK) == 0 && started.cpu_of(placement::FEED) == -1);
+        assert(log.str().find("THREAD_PLACEMENT_TEST") != std::string::npos && log.str().find("book: cpu 0") != std::string::npos);
+        assert(placement::pin_current_thread(-1));   // unpinned role: the thread stays where it is
+
+        //This machine: pin, first-touch construction and node memory on the role's core / node
+        placement::Topology machine = placement::Topology::read();
+        int cpu = machine.cpus().back().cpu;
+        placement::PlacementConfig config;
+        config.cpu[placement::BOOK] = cpu;
+        placement::ThreadPlacement local(machine, config);
+        int ran_on = local.construct_on(placement::BOOK, [] { return sched_getcpu(); });
+        assert(ran_on == cpu);
+        thrown = false;
+        try { local.construct_on(placement::BOOK, []() -> int { throw std::runtime_error("factory"); }); }
+        catch (const std::runtime_error&) { thrown = true; }
+        assert(thrown);
+        placement::NodeBuffer buffer = local.allocate(placement::BOOK, 1 << 20);
+        int node = placement::node_of_address(buffer.data());
+        assert(node == -1 || node == local.node_of(placement::BOOK));
+        std::cout << "######THREAD PLACEMENT TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_thread_placement_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_thread_placement_layout();
+    }
@@ -0,0 +1,110 @@
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <tbb/task_arena.h>
+#include "../../chapter_4/vector_env.hpp"
+
+    void test_vector_env_step()
+    {
+        //Environment::step rules: buy needs cash, sell needs an asset, hold earns change x assets;
+        //the episode resets in place after episode_length steps
+        rollout::EnvConfig config;
+        config.initial_cash = 150;
+        config.episode_length = 3;
+        rollout::VectorEnv envs(4, config);
+        int32_t actions[4] = {0, 1, 2, 0};
+        float rewards[4];
+        uint8_t dones[4];
+        double total[4] = {};
+        envs.step(actions, rewards, dones);
+        for (int i = 0; i < 4; i++)
+            total[i] += rewards[i];
+        double change = envs.price_of(0) - 100;
+        assert(std::abs(change) <= 0.5 && std::abs(rewards[0] - change) < 1e-5);
+        assert(envs.assets_of(0) == 1 && std::abs(envs.cash_of(0) - (150 - envs.price_of(0))) < 1e-9);
+        assert(rewards[1] == -1 && envs.assets_of(1) == 0 && envs.cash_of(1) == 150);   // nothing to sell
+        assert(rewards[2] == 0 && envs.cash_of(2) == 150);                               // hold, no assets
+        assert(envs.price_of(0) != envs.price_of(3));                                    // own random stream
+
+        int32_t buy[4] = {0, 0, 0, 0};
+        envs.step(buy, rewards, dones);
+        for (int i = 0; i < 4; i++)
+            total[i] += rewards[i];
+        assert(rewards[0] == -1 && envs.assets_of(0) == 1);                              // about 50 cash left
+        assert(dones[0] == 0 && envs.episodes_of(0) == 0);
+        int32_t sell[4] = {1, 1, 1, 1};
+        envs.step(sell, rewards, dones);
+        for (int i = 0; i < 4; i++)
+            total[i] += rewards[i];
+        assert(dones[0] == 1 && dones[3] == 1 && envs.episodes_of(0) == 1);
+        assert(envs.cash_of(0) == 150 && envs.assets_of(0) == 0 && envs.price_of(0) == 100);
+        for (int i = 0; i < 4; i++)
+            assert(std::abs(envs.last_return_of(i) - total[i]) < 1e-4);
+
+        //The AVX-512 loop is bit-identical to the scalar one (101 environments: 12 vectors + a tail)
+        rollout::VectorEnv scalar(101, config), simd(101, config);
+        std::vector<int32_t> mixed(101);
+        std::vector<float> r_scalar(101), r_simd(101);
+        std::vector<uint8_t> d_scalar(101), d_simd(101);
+        for (int s = 0; s < 10; s++) {
+            for (size_t i = 0; i < mixed.size(); i++)
+                mixed[i] = static_cast<int32_t>((i * 7 + s * 3) % 3);
+            scalar.step(mixed.data(), r_scalar.data(), d_scalar.data(), false, false);
+            simd.step(mixed.data(), r_simd.data(), d_simd.data(), true, true);
+            assert(r_scalar == r_simd && d_scalar == d_simd);
+        }
+        for (size_t i = 0; i < 101; i++)
+            assert(scalar.cash_of(i) == simd.cash_of(i) && scalar.assets_of(i) == simd.assets_of(i) &&
+                   scalar.price_of(i) == simd.price_of(i) && scalar.episodes_of(i) == simd.episodes_of(i) &&
+                   scalar.last_return_of(i) == simd.last_return_of(i));
+        std::cout << "######VECTOR ENV TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+    void test_vector_env_deterministic_rollout()
+    {
+        //Same seeds, one thread vs the whole pool: identical trajectories; every transition is stored
+        rollout::EnvConfig config;
+        config.episode_length = 20;
+        rollout::VectorEnv serial(1000, config), pooled(1000, config);
+        replay::ReplayBuffer memory(100000, features::NUM_FEATURES);
+        tbb::task_arena one_thread(1);
+        one_thread.execute([&] {
+            rollout::RolloutRunner runner(serial, nullptr, nullptr, 3);
+            runner.run(50, 1.0);
+        });
+        rollout::RolloutRunner runner(pooled, nullptr, &memory, 3);
+        runner.run(50, 1.0);
+        for (size_t i = 0; i < 1000; i++) {
+            assert(serial.cash_of(i) == pooled.cash_of(i) && serial.assets_of(i) == pooled.assets_of(i));
+            assert(serial.price_of(i) == pooled.price_of(i) && serial.last_return_of(i) == pooled.last_return_of(i));
+            assert(pooled.episodes_of(i) == 2);
+        }
+        assert(memory.size() == 50 * 1000 && runner.steps() == 50);
+
+        //A policy handed over between runs is used from the next step on (here: always action 2)
+        mlp::Network always_sell(1000);
+        std::vector<float> kernel(features::NUM_FEATURES * 3, 0.0f), bias = {0.0f, 0.0f, 1.0f};
+        always_sell.add_layer(features::NUM_FEATURES, 3, mlp::Activation::NONE, kernel.data(), bias.data());
+        runner.set_policy(&always_sell);
+        runner.run(1, 0.0);
+        assert(&runner.environments() == &pooled && std::count(runner.last_actions(), runner.last_actions() + 1000, 2) == 1000);
+
+        std::mt19937_64 rng(1);
+        replay::SampleBatch batch;
+        memory.sample(32, 0.4, rng, batch);
+        for (size_t k = 0; k < batch.rows; k++)
+            assert(batch.states[k * batch.stride + features::SPREAD] == static_cast<float>(config.spread) && batch.actions[k] < 3);
+        std::cout << "######VECTOR ENV TEST CASE 2 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_vector_env_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_vector_env_step();
+        test_vector_env_deterministic_rollout();
+    }
@@ -0,0 +1,70 @@
+#include <cassert>
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <iomanip>
+#include <iostream>
+#include "../../chapter_4/venue_metrics.hpp"
+
+using venue_metrics::VenueMetricsStore;
+using venue_metrics::VenueReport;
+using venue_metrics::VenueSnapshot;
+
+    void test_venue_metrics_decay_and_window()
+    {
+        //Half-life 1s: reports from one second ago weigh half; window counts expire after 60s
+        const uint64_t s = 1000000000ull;
+        VenueMetricsStore store(2, s);
+        store.on_report(VenueReport{0, 1, venue_metrics::ReportType::SENT, 0, 0, 0});
+        store.on_report(VenueReport{0, 1, venue_metrics::ReportType::SENT, 0, 0, 0});
+        store.on_report(VenueReport{0, 1, venue_metrics::ReportType::FILL, 100, 2.0, 0});
+        assert(std::abs(store.read(1).fill_rate - 0.5) < 1e-9);
+
+        store.on_report(VenueReport{s, 1, venue_metrics::ReportType::SENT, 0, 0, 0});
+        store.on_report(VenueReport{s, 1, venue_metrics::ReportType::SENT, 0, 0, 0});
+        store.on_report(VenueReport{s, 1, venue_metrics::ReportType::FILL, 100, 4.0, 0});
+        store.on_report(VenueReport{s, 1, venue_metrics::ReportType::FILL, 100, 4.0, 0});
+        store.on_report(VenueReport{s, 1, venue_metrics::ReportType::ACK, 0, 0, 50000});
+        VenueSnapshot v = store.read(1);
+        assert(std::abs(v.fill_rate - 2.5 / 3.0) < 1e-9);
+        assert(std::abs(v.slippage_bps - 900.0 / 250.0) < 1e-9);
+        assert(std::abs(v.ack_latency_us - 50.0) < 1e-9);
+        assert(v.window_orders == 4 && v.window_fills == 3 && v.time_ns == s);
+        assert(store.read(0).window_orders == 0);
+
+        store.on_timer(61 * s);
+        v = store.read(1);
+        assert(v.window_orders == 0 && v.window_fills == 0);
+        assert(std::abs(v.fill_rate - 2.5 / 3.0) < 1e-9);   // decay scales both counts, the rate holds
+        std::cout << "######VENUE METRICS TEST CASE 1 PASSED" << std::endl<< std::endl;
+    }
+    void test_venue_metrics_consistent_reads()
+    {
+        //A reader racing the writer never sees a half-written snapshot
+        VenueMetricsStore store(1, 1000000000ull);
+        std::atomic<bool> done{false};
+        std::atomic<bool> torn{false};
+        std::thread reader([&]() {
+            while (!done.load()) {
+                VenueSnapshot v = store.read(0);
+                if (v.window_orders != v.time_ns)
+                    torn = true;
+            }
+        });
+        for (uint64_t i = 1; i <= 200000; i++)
+            store.on_report(VenueReport{i, 0, venue_metrics::ReportType::SENT, 0, 0, 0});
+        done = true;
+        reader.join();
+        assert(!torn.load() && store.read(0).window_orders == 200000);
+        std::cout << "######VENUE METRICS TEST CASE 2 PASSED" << std::endl<< std::endl;
+    }
+
+
+    void run_venue_metrics_tests()
+    {
+        std::cout << std::fixed;
+        std::cout << std::setprecision(2);
+
+        test_venue_metrics_decay_and_window();
+        test_venue_metrics_consistent_reads();
+    }
@@ -0,0 +1,359 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <exception>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <cstdint>
+#include <cstddef>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+// Which core runs which part of the trading stack, and which NUMA node holds its data.
+// The topology comes from sysfs; a PlacementConfig assigns roles to cores; ThreadPlacement
+// checks the layout once at startup, pins threads and places memory on the role's node.
+namespace placement
+{
+
+struct CpuInfo {
+    int cpu;
+    int core;       // core_id, unique within the package
+    int package;    // physical_package_id (socket)
+    int node;       // NUMA node
+};
+
+// "0-3,8,10-11" (sysfs cpu / node lists)
+inline std::vector<int> parse_list(const std::string& text) {
+    std::vector<int> out;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item.erase(std::remove_if(item.begin(), item.end(), ::isspace), item.end());
+        if (item.empty())
+            continue;
+        size_t dash = item.find('-');
+        try {
+            int first = std::stoi(item.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+            for (int i = first; i <= last; i++)
+                out.push_back(i);
+        }
+        catch (const std::exception&) {
+            throw std::runtime_error("Invalid cpu list: " + text);
+        }
+    }
+    return out;
+}
+
+class Topology {
+private:
+    std::vector<CpuInfo> cpu_info;   // online cpus, ascending
+    int nodes = 1;
+
+    static bool read_file(const std::string& path, std::string& out) {
+        std::ifstream in(path);
+        if (!in)
+            return false;
+        std::getline(in, out);
+        return true;
+    }
+    static int read_int(const std::string& path, int fallback) {
+        std::string text;
+        return read_file(path, text) && !text.empty() ? std::stoi(text) : fallback;
+    }
+
+public:
+    // root: the sysfs "system" directory (a copy of it in tests). A machine without
+    // /sys/devices/system/node is one node.
+    static Topology read(const std::string& root = "/sys/devices/system") {
+        Topology t;
+        std::string online;
+        if (!read_file(root + "/cpu/online", online))
+            throw std::runtime_error("Cannot read " + root + "/cpu/online");
+        for (int cpu : parse_list(online)) {
+            std::string dir = root + "/cpu/cpu" + std::to_string(cpu) + "/topology/";
+            t.cpu_info.push_back(CpuInfo{cpu, read_int(dir + "core_id", cpu), read_int(dir + "physical_package_id", 0), 0});
+        }
+        std::string node_list;
+        if (read_file(root + "/node/online", node_list)) {
+            std::vector<int> node_ids = parse_list(node_list);
+            t.nodes = node_ids.empty() ? 1 : node_ids.back() + 1;
+            for (int node : node_ids) {
+                std::string cpus;
+                if (!read_file(root + "/node/node" + std::to_string(node) + "/cpulist", cpus))
+                    continue;
+                for (int cpu : parse_list(cpus))
+                    for (CpuInfo& c : t.cpu_info)
+                        if (c.cpu == cpu)
+                            c.node = node;
+            }
+        }
+        return t;
+    }
+
+    // Synthetic layouts (tests, planning for another machine)
+    static Topology from(std::vector<CpuInfo> cpus, int nodes) {
+        Topology t;
+        t.cpu_info = std::move(cpus);
+        t.nodes = nodes;
+        return t;
+    }
+
+    const std::vector<CpuInfo>& cpus() const { return cpu_info; }
+    int num_nodes() const { return nodes; }
+    const CpuInfo* find(int cpu) const {
+        for (const CpuInfo& c : cpu_info)
+            if (c.cpu == cpu)
+                return &c;
+        return nullptr;
+    }
+    // Hyperthreads of one physical core
+    bool same_core(int a, int b) const {
+        const CpuInfo* x = find(a);
+        const CpuInfo* y = find(b);
+        return x != nullptr && y != nullptr && x->package == y->package && x->core == y->core;
+    }
+    // First cpu of every physical core (no hyperthread siblings), node by node
+    std::vector<int> physical_cores() const {
+        std::vector<int> out;
+        for (const CpuInfo& c : cpu_info) {
+            bool seen = false;
+            for (int cpu : out)
+                seen = seen || same_core(cpu, c.cpu);
+            if (!seen)
+                out.push_back(c.cpu);
+        }
+        std::stable_sort(out.begin(), out.end(), [&](int a, int b) { return find(a)->node < find(b)->node; });
+        return out;
+    }
+};
+
+enum Role { FEED, BOOK, STRATEGY, OMS, HUB, LOGGER, NUM_ROLES };
+inline const char* role_name(Role r) {
+    static const char* names[NUM_ROLES] = {"feed", "book", "strategy", "oms", "hub", "logger"};
+    return names[r];
+}
+// Busy-polling roles on the tick-to-trade path, in pipeline order; each wants a core of its own
+inline bool is_hot(Role r) { return r <= OMS; }
+
+struct PlacementConfig {
+    int cpu[NUM_ROLES] = {-1, -1, -1, -1, -1, -1};   // -1: not pinned
+
+    // "feed=2,book=3,strategy=4,oms=5,hub=1,logger=1"
+    static PlacementConfig parse(const std::string& spec) {
+        PlacementConfig config;
+        std::stringstream ss(spec);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            size_t eq = item.find('=');
+            int r = 0;
+            while (r < NUM_ROLES && (eq == std::string::npos || item.compare(0, eq, role_name(Role(r))) != 0))
+                r++;
+            if (r == NUM_ROLES)
+                throw std::runtime_error("Invalid thread placement: " + item);
+            try {
+                config.cpu[r] = std::stoi(item.substr(eq + 1));
+            }
+            catch (const std::exception&) {
+                throw std::runtime_error("Invalid thread placement: " + item);
+            }
+        }
+        return config;
+    }
+
+    // Hot roles on their own physical cores of the first node, in pipeline order; hub and
+    // logger share the first core with the OS. Needs 5 physical cores on the node for no
+    // sharing; with fewer, roles wrap around (and check() says so).
+    static PlacementConfig automatic(const Topology& topology) {
+        PlacementConfig config;
+        std::vector<int> cores = topology.physical_cores();
+        int node = topology.find(cores[0])->node;
+        std::vector<int> local;
+        for (int cpu : cores)
+            if (topology.find(cpu)->node == node)
+                local.push_back(cpu);
+        size_t next = local.size() > OMS + 1 ? 1 : 0;
+        for (int r = FEED; r <= OMS; r++)
+            config.cpu[r] = local[(next++) % local.size()];
+        config.cpu[HUB] = config.cpu[LOGGER] = local[0];
+        return config;
+    }
+};
+
+// Pins the calling thread; false (errno set) if the cpu can't be used. cpu < 0: not pinned
+inline bool pin_current_thread(int cpu) {
+    if (cpu < 0)
+        return true;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+// Memory of one NUMA node: anonymous pages with a preferred-node policy (mbind), touched up front
+// so they are placed (and faulted in) before the hot path uses them
+class NodeBuffer {
+private:
+    void* memory = nullptr;
+    size_t bytes = 0;
+    int target = 0;
+
+public:
+    NodeBuffer(size_t size, int node) : bytes(size), target(node) {
+        memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+            throw std::runtime_error("Cannot allocate node memory");
+        const int MPOL_PREFERRED = 1;
+        unsigned long mask = 1ul << node;
+        // best effort: without NUMA support the kernel places the pages as usual
+        syscall(SYS_mbind, memory, bytes, MPOL_PREFERRED, &mask, sizeof(mask) * 8, 0);
+        std::memset(memory, 0, bytes);
+    }
+    NodeBuffer(const NodeBuffer&) = delete;
+    NodeBuffer& operator=(const NodeBuffer&) = delete;
+    NodeBuffer(NodeBuffer&& other) noexcept : memory(other.memory), bytes(other.bytes), target(other.target) {
+        other.memory = nullptr;
+    }
+    ~NodeBuffer() {
+        if (memory != nullptr)
+            munmap(memory, bytes);
+    }
+
+    void* data() const { return memory; }
+    size_t size() const { return bytes; }
+    int node() const { return target; }
+};
+
+// Node holding the page at address, -1 if the kernel can't tell
+inline int node_of_address(const void* address) {
+    const unsigned long MPOL_F_NODE = 1, MPOL_F_ADDR = 2;
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, nullptr, 0, address, MPOL_F_NODE | MPOL_F_ADDR) != 0)
+        return -1;
+    return node;
+}
+
+// A checked role -> core layout for this process
+class ThreadPlacement {
+private:
+    Topology topology;
+    PlacementConfig config;
+    std::vector<std::string> problems;
+
+    void check() {
+        for (int a = 0; a < NUM_ROLES; a++) {
+            for (int b = a + 1; b < NUM_ROLES; b++) {
+                int x = config.cpu[a], y = config.cpu[b];
+                if (x < 0 || y < 0 || (!is_hot(Role(a)) && !is_hot(Role(b))))
+                    continue;
+                std::string pair = std::string(role_name(Role(a))) + " and " + role_name(Role(b));
+                if (x == y)
+                    problems.push_back(pair + " share cpu " + std::to_string(x));
+                else if (topology.same_core(x, y))
+                    problems.push_back(pair + " are hyperthreads of one core (cpus " + std::to_string(x) + ", " + std::to_string(y) + ")");
+            }
+        }
+        // neighbours in the pipeline hand data over every tick: keep them on one node
+        for (int r = FEED; r < OMS; r++) {
+            int x = config.cpu[r], y = config.cpu[r + 1];
+            if (x >= 0 && y >= 0 && topology.find(x)->node != topology.find(y)->node)
+                problems.push_back(std::string(role_name(Role(r))) + " -> " + role_name(Role(r + 1)) + " crosses NUMA nodes (" +
+                                   std::to_string(topology.find(x)->node) + " -> " + std::to_string(topology.find(y)->node) + ")");
+        }
+    }
+
+public:
+    // Throws if a role is assigned to a cpu that isn't online; layout warnings are in warnings()
+    ThreadPlacement(Topology topology, const PlacementConfig& config) : topology(std::move(topology)), config(config) {
+        for (int r = 0; r < NUM_ROLES; r++) {
+            int cpu = config.cpu[r];
+            if (cpu >= 0 && this->topology.find(cpu) == nullptr)
+                throw std::runtime_error(std::string("Thread placement: ") + role_name(Role(r)) + " on cpu " +
+                                         std::to_string(cpu) + ", which is not online");
+        }
+        check();
+    }
+
+    // The layout of spec ("feed=2,book=3,...", see PlacementConfig::parse), or the automatic one
+    // when spec is null or empty
+    static ThreadPlacement configure(const Topology& topology, const char* spec) {
+        if (spec == nullptr || *spec == '\0')
+            return ThreadPlacement(topology, PlacementConfig::automatic(topology));
+        return ThreadPlacement(topology, PlacementConfig::parse(spec));
+    }
+
+    // Process start: this machine's topology, the layout from the environment variable (automatic
+    // if it isn't set), and the report with its warnings written to log
+    static ThreadPlacement startup(const char* variable = "THREAD_PLACEMENT", std::ostream& log = std::cerr) {
+        const char* spec = std::getenv(variable);
+        ThreadPlacement layout = configure(Topology::read(), spec);
+        log << "Thread placement (" << (spec != nullptr && *spec != '\0' ? variable : "automatic") << "):\n" << layout.report();
+        return layout;
+    }
+
+    int cpu_of(Role r) const { return config.cpu[r]; }
+    // Node of the role's core (node 0 if the role isn't pinned)
+    int node_of(Role r) const { return config.cpu[r] >= 0 ? topology.find(config.cpu[r])->node : 0; }
+    const Topology& machine() const { return topology; }
+    const std::vector<std::string>& warnings() const { return problems; }
+
+    // Pins the calling thread to the role's core and checks it runs there. An unpinned role stays where it is.
+    bool pin(Role r) const {
+        int cpu = config.cpu[r];
+        if (cpu < 0)
+            return true;
+        return pin_current_thread(cpu) && sched_getcpu() == cpu;
+    }
+
+    // Runs make() on a thread pinned to the role's core and returns its result. Heap pages are
+    // placed on first touch, so what make() allocates and initialises (a book's level arrays,
+    // a queue's ring) lands on the role's node. What make() throws is rethrown to the caller.
+    template <class F>
+    auto construct_on(Role r, F make) const -> decltype(make()) {
+        decltype(make()) result{};
+        std::exception_ptr error;
+        std::thread worker([&]() {
+            try {
+                pin(r);
+                result = make();
+            } catch (...) {
+                error = std::current_exception();
+            }
+        });
+        worker.join();
+        if (error)
+            std::rethrow_exception(error);
+        return result;
+    }
+
+    NodeBuffer allocate(Role r, size_t bytes) const { return NodeBuffer(bytes, node_of(r)); }
+
+    // One line per role, then the warnings
+    std::string report() const {
+        std::ostringstream out;
+        for (int r = 0; r < NUM_ROLES; r++) {
+            out << role_name(Role(r)) << ": ";
+            if (config.cpu[r] < 0) {
+                out << "not pinned\n";
+                continue;
+            }
+            const CpuInfo* c = topology.find(config.cpu[r]);
+            out << "cpu " << c->cpu << " (core " << c->core << ", socket " << c->package << ", node " << c->node << ")\n";
+        }
+        for (const std::string& p : problems)
+            out << "warning: " << p << "\n";
+        return out.str();
+    }
+};
+
+} // namespace placement
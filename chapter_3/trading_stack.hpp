@@ -0,0 +1,56 @@
+#pragma once
+#include <memory>
+#include <thread>
+#include <vector>
+#include "thread_placement.hpp"
+#include "exploring_circular_array.hpp"
+#include "strategy.hpp"
+#include "rms.hpp"
+#include "oms_ems.hpp"
+#include "messaging_hub.hpp"
+
+// Process start of the trading stack. One ThreadPlacement for the whole process (from
+// $THREAD_PLACEMENT, automatic otherwise, reported with its warnings on stderr); every role's
+// book and queues are constructed on the role's core, so first touch puts them on its node,
+// and every role's loop runs pinned to that core.
+namespace trading_stack
+{
+
+class TradingStack {
+private:
+    placement::ThreadPlacement layout;
+    std::unique_ptr<circular_array::LimitOrderBook> book;
+    std::unique_ptr<strategy::StrategyModule> strategy_module;
+    std::unique_ptr<RMS> rms;
+    std::unique_ptr<OMS> oms;
+    std::unique_ptr<MessagingHub> hub;
+    std::vector<std::thread> threads;
+
+public:
+    TradingStack(int precision = 2, int levels = 10000) : layout(placement::ThreadPlacement::startup()) {
+        book = layout.construct_on(placement::BOOK, [&] { return std::make_unique<circular_array::LimitOrderBook>(precision, levels); });
+        strategy_module = layout.construct_on(placement::STRATEGY, [&] { return std::make_unique<strategy::StrategyModule>(*book); });
+        // the RMS takes the OMS's execution batches on the OMS thread: same node
+        rms = layout.construct_on(placement::OMS, [] { return std::make_unique<RMS>(); });
+        // the OMS's update queue and execution report ring are first touched here
+        oms = layout.construct_on(placement::OMS, [&] { return std::make_unique<OMS>(*rms); });
+        hub = layout.construct_on(placement::HUB, [&] { return std::make_unique<MessagingHub>(*book); });
+    }
+
+    ~TradingStack() {
+        for (std::thread& t : threads)
+            if (t.joinable())
+                t.join();
+    }
+
+    // Each role's loop on a thread of its own, on the role's core
+    void start() {
+        threads.emplace_back([this] { strategy_module->run(layout.cpu_of(placement::STRATEGY)); });
+        threads.emplace_back([this] { oms->run(layout.cpu_of(placement::OMS)); });
+        threads.emplace_back([this] { hub->run(layout.cpu_of(placement::HUB)); });
+    }
+
+    const placement::ThreadPlacement& thread_layout() const { return layout; }
+};
+
+} // namespace trading_stack
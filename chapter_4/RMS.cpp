@@ -30,6 +30,9 @@ Use this code at your own risk.
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 #include <tensorflow/cc/client/client_session.h>
@@ -37,6 +40,11 @@ Use this code at your own risk.
 #include <tensorflow/core/framework/tensor.h>
 #include <algorithm>
 #include <random>
+#include "mlp_inference.hpp"
+#include "replay_buffer.hpp"
+#include "ohlcv_store.hpp"
+#include "indicators.hpp"
+#include "portfolio_book.hpp"
 
 
 // Define a single piece of market data.
@@ -50,114 +58,211 @@ struct DataPoint {
 };
 
 // MarketData class definition
+// Backed by a columnar ohlcv::OhlcvStore (one contiguous array per field per ticker, dense ticker
+// ids). Resolve a ticker once with tickerId() and use the id overloads in per-step code: no string
+// lookup and no copy. The store is shared, so copying a State doesn't copy the history.
+// Rolling indicators of every ticker (mean, volatility, EMA, VWAP, min / max, returns over the
+// last 10 days up to the current position) are updated by next(), one O(1) step per ticker.
 class MarketData {
 private:
-    std::map<std::string, std::vector<DataPoint>> data; // Key: Ticker symbol, Value: Data points
+    std::shared_ptr<const ohlcv::OhlcvStore> store;
     size_t currentPosition; // Current position in the data vector
+    indicators::IndicatorEngine signals{0, 10};
+    std::vector<double> dayCloses;
+    std::vector<double> dayVolumes;
+
+    // Feeds the bar of the current position of every ticker
+    void updateIndicators() {
+        if (currentPosition >= store->days())
+            return;
+        for (size_t t = 0; t < store->tickers(); t++) {
+            dayCloses[t] = store->column(static_cast<int32_t>(t), ohlcv::CLOSE)[currentPosition];
+            dayVolumes[t] = store->column(static_cast<int32_t>(t), ohlcv::VOLUME)[currentPosition];
+        }
+        signals.update(dayCloses.data(), dayVolumes.data());
+    }
+    void startIndicators() {
+        signals = indicators::IndicatorEngine(store->tickers(), 10);
+        dayCloses.assign(store->tickers(), 0.0);
+        dayVolumes.assign(store->tickers(), 0.0);
+        updateIndicators();
+    }
+
+    static DataPoint toDataPoint(const ohlcv::Bar& bar) {
+        return DataPoint{bar.open, bar.close, bar.high, bar.low, bar.volume, bar.adjusted_close};
+    }
 
 public:
     // Constructor that initializes the market data from a given source (e.g., a file or a database)
-    MarketData(const std::map<std::string, std::vector<DataPoint>>& inputData)
-        : data(inputData), currentPosition(0) {}
+    // Points are aligned by position: point i of every ticker is day i of the calendar.
+    MarketData(const std::map<std::string, std::vector<DataPoint>>& inputData) : currentPosition(0) {
+        std::vector<std::string> tickers;
+        size_t days = 0;
+        for (const auto& [ticker, dataPoints] : inputData) {
+            tickers.push_back(ticker);
+            days = std::max(days, dataPoints.size());
+        }
+        std::vector<int32_t> calendar(days);
+        for (size_t i = 0; i < days; i++)
+            calendar[i] = static_cast<int32_t>(i);
+        auto columns = std::make_shared<ohlcv::OhlcvStore>(std::move(tickers), std::move(calendar));
+        int32_t id = 0;
+        for (const auto& [ticker, dataPoints] : inputData) {
+            for (size_t i = 0; i < dataPoints.size(); i++) {
+                columns->mutable_column(id, ohlcv::OPEN)[i] = dataPoints[i].open;
+                columns->mutable_column(id, ohlcv::HIGH)[i] = dataPoints[i].high;
+                columns->mutable_column(id, ohlcv::LOW)[i] = dataPoints[i].low;
+                columns->mutable_column(id, ohlcv::CLOSE)[i] = dataPoints[i].close;
+                columns->mutable_column(id, ohlcv::VOLUME)[i] = dataPoints[i].volume;
+                columns->mutable_column(id, ohlcv::ADJ_CLOSE)[i] = dataPoints[i].adjustedClose;
+            }
+            id++;
+        }
+        store = std::move(columns);
+        startIndicators();
+    }
+
+    // e.g. std::make_shared<const ohlcv::OhlcvStore>(ohlcv::OhlcvStore::open("universe.ohlcv"))
+    explicit MarketData(std::shared_ptr<const ohlcv::OhlcvStore> columns) : store(std::move(columns)), currentPosition(0) {
+        startIndicators();
+    }
 
-    // Assuming all tickers have the same length of data for simplicity
+    // All tickers share one calendar
     void next() {
-        if (currentPosition < data.begin()->second.size() - 1) {
+        if (hasMoreData()) {
             ++currentPosition;
-            for (auto &[ticker, dataPoints] : data) {
-                // Assuming all tickers have the same data length for now
-                // This will move all ticker data positions forward
-                ++currentPosition;
-            }
+            updateIndicators();
         }
     }
 
+    // -1 if unknown
+    int32_t tickerId(const std::string& ticker) const {
+        return store->id(ticker);
+    }
+
     // Get the current data point for a specific ticker
     DataPoint getCurrentData(const std::string& ticker) const {
-        return data.at(ticker)[currentPosition];
+        int32_t id = store->id(ticker);
+        if (id < 0)
+            throw std::out_of_range("Unknown ticker " + ticker);
+        return getCurrentData(id);
+    }
+    DataPoint getCurrentData(int32_t ticker) const {
+        return toDataPoint(store->bar(ticker, currentPosition));
     }
 
     // Check if there's more data available
     bool hasMoreData() const {
-        return currentPosition < data.begin()->second.size() - 1;
+        return currentPosition + 1 < store->days();
     }
 
     // Reset to start position (e.g., for a new episode in reinforcement learning)
     void reset() {
         currentPosition = 0;
+        signals.reset();
+        updateIndicators();
     }
     
     // For demonstration purposes, return the last 'days' data points for the ticker
     std::vector<DataPoint> getHistoricalData(const std::string& ticker, size_t days) const {
-        if (data.at(ticker).size() < days) {
-            return data.at(ticker);
-        } else {
-            return std::vector<DataPoint>(data.at(ticker).end() - days, data.at(ticker).end());
-        }
+        int32_t id = store->id(ticker);
+        if (id < 0)
+            throw std::out_of_range("Unknown ticker " + ticker);
+        ohlcv::Window window = getHistoryWindow(id, days);
+        std::vector<DataPoint> points;
+        points.reserve(window.size);
+        for (size_t i = 0; i < window.size; i++)
+            points.push_back(DataPoint{window(ohlcv::OPEN, i), window(ohlcv::CLOSE, i), window(ohlcv::HIGH, i),
+                                       window(ohlcv::LOW, i), window(ohlcv::VOLUME, i), window(ohlcv::ADJ_CLOSE, i)});
+        return points;
+    }
+    // Same days as getHistoricalData(), as a view into the store
+    ohlcv::Window getHistoryWindow(int32_t ticker, size_t days) const {
+        return store->window(ticker, store->days(), days);
+    }
+
+    const ohlcv::OhlcvStore& columns() const {
+        return *store;
     }
 
+    // Indicators as of the current position, by ticker id
+    const indicators::IndicatorEngine& getIndicators() const {
+        return signals;
+    }
 };
 
 
 class Portfolio { // Data structure to hold the assets and their quantities.
 private:    
-    std::map<std::string, double> assets; // Key: Ticker symbol, Value: Quantity    
-    double cashBalance; // Cash balance in the portfolio.
+    // Positions by ticker id of the MarketData, cash, and the total value kept up to date
+    // incrementally: trades and price changes cost O(1), whatever the size of the universe.
+    portfolio_book::PortfolioBook book;
+
+    static int32_t idOf(const std::string& ticker, const MarketData& marketData) {
+        int32_t id = marketData.tickerId(ticker);
+        if (id < 0)
+            throw std::out_of_range("Unknown ticker " + ticker);
+        return id;
+    }
 public:
     // Constructor to initialize the portfolio with a starting cash balance.
-    Portfolio(double initialCash) : cashBalance(initialCash) {}
+    // assets: size of the universe, if known (the book grows otherwise)
+    Portfolio(double initialCash, size_t assets = 0) : book(assets, initialCash) {}
     // Method to add an asset to the portfolio.
-    void addAsset(const std::string& ticker, double quantity) {
-        assets[ticker] += quantity;
+    void addAsset(int32_t asset, double quantity) {
+        book.add(asset, quantity);
     }
     // Method to remove an asset from the portfolio.
-    void removeAsset(const std::string& ticker, double quantity) {
-        if (assets[ticker] < quantity) {
+    void removeAsset(int32_t asset, double quantity) {
+        if (!book.add(asset, -quantity)) {
             throw std::runtime_error("Not enough assets to remove.");
         }
-        assets[ticker] -= quantity;
     }
 
     // Method to get the quantity of a specific asset.
-    double getAssetQuantity(const std::string& ticker) const {
-        if (assets.find(ticker) != assets.end()) {
-            return assets.at(ticker);
-        }
-        return 0.0;
+    double getAssetQuantity(int32_t asset) const {
+        return book.quantity_of(asset);
+    }
+    double getAssetQuantity(const std::string& ticker, const MarketData& marketData) const {
+        return book.quantity_of(marketData.tickerId(ticker));
     }
     // Method to adjust the cash balance when buying/selling assets.
     void adjustCashBalance(double amount) {
-        cashBalance += amount;
+        book.adjust_cash(amount);
     }
     // Method to get the current cash balance.
     double getCashBalance() const {
-        return cashBalance;
+        return book.cash_balance();
     }
-    void buy(const std::string& ticker, double quantity, const MarketData& marketData) {
-        double cost = marketData.getCurrentData(ticker).close * quantity;
-        if (cashBalance < cost) {
+    void buy(int32_t asset, double quantity, const MarketData& marketData) {
+        if (!book.buy(asset, quantity, marketData.getCurrentData(asset).close)) {
             throw std::runtime_error("Not enough cash to buy.");
         }
-        addAsset(ticker, quantity);
-        adjustCashBalance(-cost);
     }
-    void sell(const std::string& ticker, double quantity, const MarketData& marketData) {
-        double earnings = marketData.getCurrentData(ticker).close * quantity;
-        if (getAssetQuantity(ticker) < quantity) {
+    void buy(const std::string& ticker, double quantity, const MarketData& marketData) {
+        buy(idOf(ticker, marketData), quantity, marketData);
+    }
+    void sell(int32_t asset, double quantity, const MarketData& marketData) {
+        if (!book.sell(asset, quantity, marketData.getCurrentData(asset).close)) {
             throw std::runtime_error("Not enough assets to sell.");
         }
-        removeAsset(ticker, quantity);
-        adjustCashBalance(earnings);
     }
-    // Method to compute the portfolio's total value using the market data.
-    double computeTotalValue(const MarketData& marketData) const {
-        double totalValue = cashBalance;
-        for (const auto& [ticker, quantity] : assets) {
-            if (marketData.getCurrentData(ticker).close != 0) { // Check for non-zero close price
-                totalValue += quantity * marketData.getCurrentData(ticker).close;
+    void sell(const std::string& ticker, double quantity, const MarketData& marketData) {
+        sell(idOf(ticker, marketData), quantity, marketData);
+    }
+    // Marks the held assets at the current prices of the market data: O(held)
+    void markToMarket(const MarketData& marketData) {
+        for (int32_t asset : book.held()) {
+            double close = marketData.getCurrentData(asset).close;
+            if (close != 0 && !std::isnan(close)) { // Check for non-zero close price
+                book.mark(asset, close);
             }
         }
-        return totalValue;
+    }
+    // Method to compute the portfolio's total value using the market data.
+    double computeTotalValue(const MarketData& marketData) {
+        markToMarket(marketData);
+        return book.total_value();
     }
 };
 
@@ -166,12 +271,14 @@ private:
     Portfolio currentPortfolio;            // The current status of our portfolio.
     MarketData currentMarketData;          // The latest market data.
     double historicalPerformance;          // Past performance metric of the portfolio.
+    int32_t featureTicker;                 // id of "TICKER" in the market data, -1 if it has none
     // ... any other relevant state-related data members ...
 
 public:
     // Constructor initializing the state with a portfolio and market data.
     State(const Portfolio& portfolio, const MarketData& marketData)
-        : currentPortfolio(portfolio), currentMarketData(marketData), historicalPerformance(0.0) {}
+        : currentPortfolio(portfolio), currentMarketData(marketData), historicalPerformance(0.0),
+          featureTicker(marketData.tickerId("TICKER")) {}
 
     // Getter for current portfolio.
     Portfolio& getPortfolio() {
@@ -216,6 +323,29 @@ public:
         return tensor;
     }
 
+    // Same 60 values as toTensor(), into a caller-provided row (64 floats, zero padded).
+    // The ticker id is resolved once, at construction.
+    void toFeatures(float* row) const {
+        if (featureTicker < 0)
+            throw std::out_of_range("Unknown ticker TICKER");
+        ohlcv::Window window = currentMarketData.getHistoryWindow(featureTicker, 10);
+        int idx = 0;
+        for (size_t i = 0; i < window.size; i++) {
+            row[idx++] = window(ohlcv::OPEN, i);
+            row[idx++] = window(ohlcv::CLOSE, i);
+            row[idx++] = window(ohlcv::HIGH, i);
+            row[idx++] = window(ohlcv::LOW, i);
+            row[idx++] = window(ohlcv::VOLUME, i);
+            row[idx++] = window(ohlcv::ADJ_CLOSE, i);
+        }
+    }
+
+    // The ticker's precomputed rolling indicators (indicators::NUM_INDICATORS floats), for
+    // networks and strategies that take them instead of raw windows
+    void toIndicatorFeatures(int32_t ticker, float* row) const {
+        currentMarketData.getIndicators().write_features(ticker, row);
+    }
+
 };
 
 class Action {
@@ -252,19 +382,15 @@ public:
     }
 };
 
-class Experience {
-public:
-    State state;
-    Action action;
+
+// What a step returns: a view of the environment's state (updated in place by the next step, so
+// copy out what must outlive it, e.g. State::toFeatures), the reward and the end of the episode
+struct StepResult {
+    const State& state;
     double reward;
-    State nextState;
     bool done;
-
-    Experience(const State& s, const Action& a, double r, const State& ns, bool d)
-        : state(s), action(a), reward(r), nextState(ns), done(d) {}
 };
 
-
 class TradingEnvironment {
 private:
     State currentState;            // Current state of the trading system.
@@ -279,8 +405,8 @@ public:
 
 
     // Execute an action in the environment.
-    std::tuple<State, double, bool> step(const Action& action) {
-        double previousPortfolioValue = currentState.getPortfolio().totalValue(currentState.getMarketData());
+    StepResult step(const Action& action) {
+        double previousPortfolioValue = currentState.getPortfolio().computeTotalValue(currentState.getMarketData());
 
         // Apply the action to the current state.
         switch(action.getType()) {
@@ -301,7 +427,7 @@ public:
         currentDay++;
         currentState.updateState();
 
-        double newPortfolioValue = currentState.getPortfolio().totalValue(currentState.getMarketData());
+        double newPortfolioValue = currentState.getPortfolio().computeTotalValue(currentState.getMarketData());
 
         // Reward is the change in portfolio value.
         double reward = newPortfolioValue - previousPortfolioValue;
@@ -309,11 +435,11 @@ public:
         // Check if the trading period is over.
         bool done = (currentDay >= maxTradingDays);
 
-        return std::make_tuple(currentState, reward, done);
+        return StepResult{currentState, reward, done};
     }
 
     // Reset the environment to its initial state.
-    State reset() {
+    const State& reset() {
         currentState = State(Portfolio(initialBalance), MarketData({{"TICKER", {}}}));
         currentDay = 0;
         return currentState;
@@ -344,9 +470,17 @@ private:
 
     double epsilon;  // Exploration rate.
     const double discountFactor = 0.95; // Define hyperparameters as needed.
-    std::deque<Experience> memory; // Experience replay memory
     const size_t memoryCapacity = 10000;
     const size_t batchSize = 64;
+    // Experience replay memory: two 60-float feature rows per experience (about 550 bytes),
+    // preallocated, prioritised by TD error; remember() may be called from actor threads
+    replay::ReplayBuffer memory{10000, 60};
+    replay::SampleBatch batch;      // reused by every sample()
+    std::mt19937_64 sampleRng{std::random_device{}()};
+    double importanceBeta = 0.4;    // annealed towards 1 over training
+
+    mlp::Network inference{1};      // native copy of the Q-network, used by act() once loaded
+    bool inferenceLoaded = false;
 
 public:
     DQNAgent(int inputSize, int outputSize) 
@@ -373,8 +507,6 @@ public:
             {0, 0, 0, 0}, 
             0.001, 0.9, 0.999, 1e-8, loss);
 
-        // Define the experience replay memory
-        memory = std::deque<Experience>();
 
         // Global variables initializer for Tensorflow
         initOp = tensorflow::ops::GlobalVariablesInitializer(scope);
@@ -402,42 +534,64 @@ public:
         }
     }
     
-    void train(const std::vector<Experience>& experienceBatch) {
-        // Experience is a structure that holds state, action, reward, next state, and done flag.
-
-        std::vector<tensorflow::Tensor> currentStates;
-        std::vector<tensorflow::Tensor> targetQValuesBatch;
-
-        for (const auto& experience : experienceBatch) {
-            currentStates.push_back(experience.state.toTensor());
-
-            // Compute the target Q-value for the action taken.
-            tensorflow::Tensor targetQValue;
-            if (experience.done) {
-                targetQValue = tensorflow::Tensor(experience.reward);
-            } else {
-                std::vector<tensorflow::Tensor> qValuesNext;
-                TF_CHECK_OK(session.Run({{modelInput, experience.nextState.toTensor()}}, {qValues}, &qValuesNext));
-
-                // We use the Q-value of the best action as the target.
-                double maxQValueNext = qValuesNext[0].vec<float>().maximum();
-                targetQValue = tensorflow::Tensor(experience.reward + discountFactor * maxQValueNext);
-            }
+    // The whole batch as one [rows, stride] tensor, copied straight from the replay rows
+    static tensorflow::Tensor rowsToTensor(const float* rows, size_t count, size_t stride) {
+        tensorflow::Tensor tensor(tensorflow::DT_FLOAT,
+                                  tensorflow::TensorShape({static_cast<int64_t>(count), static_cast<int64_t>(stride)}));
+        std::memcpy(tensor.flat<float>().data(), rows, count * stride * sizeof(float));
+        return tensor;
+    }
 
-            targetQValuesBatch.push_back(targetQValue);
+    void train(const replay::SampleBatch& experienceBatch) {
+        // One session call for the next states of the whole batch instead of one per experience
+        size_t rows = experienceBatch.rows;
+        tensorflow::Tensor currentStates = rowsToTensor(experienceBatch.states.data(), rows, experienceBatch.stride);
+        tensorflow::Tensor nextStates = rowsToTensor(experienceBatch.next_states.data(), rows, experienceBatch.stride);
+        std::vector<tensorflow::Tensor> qValuesNext, qValuesNow;
+        TF_CHECK_OK(session.Run({{modelInput, nextStates}}, {qValues}, &qValuesNext));
+        TF_CHECK_OK(session.Run({{modelInput, currentStates}}, {qValues}, &qValuesNow));
+        auto next = qValuesNext[0].matrix<float>();
+        auto now = qValuesNow[0].matrix<float>();
+
+        // Target Q-value for the action taken: the reward, plus the discounted best Q-value of the next state
+        tensorflow::Tensor targetQValuesBatch(tensorflow::DT_FLOAT, tensorflow::TensorShape({static_cast<int64_t>(rows)}));
+        auto targets = targetQValuesBatch.vec<float>();
+        std::vector<float> tdErrors(rows);
+        for (size_t i = 0; i < rows; ++i) {
+            float maxQValueNext = next(i, 0);
+            for (int a = 1; a < next.dimension(1); ++a)
+                maxQValueNext = std::max(maxQValueNext, next(i, a));
+            targets(i) = experienceBatch.rewards[i] + (experienceBatch.dones[i] ? 0.0f : static_cast<float>(discountFactor) * maxQValueNext);
+            tdErrors[i] = targets(i) - now(i, experienceBatch.actions[i]);
         }
 
         // Train the neural network.
         session.Run({{modelInput, currentStates}, {targetQValues, targetQValuesBatch}}, {trainOp}, nullptr);
 
+        // Experiences with large errors get replayed more often
+        memory.update_priorities(experienceBatch, tdErrors.data());
+        importanceBeta = std::min(1.0, importanceBeta + 1e-4);
+
         // Gradually reduce epsilon over time.
         epsilon *= 0.995;
     }
     void remember(const State& state, const Action& action, double reward, const State& nextState, bool done) {
-        if (memory.size() == memoryCapacity) {
-            memory.pop_front();
-        }
-        memory.push_back(Experience(state, action, reward, nextState, done));
+        alignas(64) float row[64] = {};
+        alignas(64) float nextRow[64] = {};
+        state.toFeatures(row);
+        nextState.toFeatures(nextRow);
+        remember(row, action, reward, nextRow, done);
+    }
+    // Rows already written by State::toFeatures (the environment's state is a view, so the
+    // state before a step has to be kept as its features)
+    void remember(const float* row, const Action& action, double reward, const float* nextRow, bool done) {
+        memory.add(row, static_cast<int32_t>(action.getType()), static_cast<float>(reward), nextRow, done);
+    }
+
+    // Weights exported from the trained session (see mlp::Network for the format)
+    void loadInferenceWeights(const std::string& path) {
+        inference.load(path);
+        inferenceLoaded = true;
     }
 
     Action act(const State& state) {
@@ -456,12 +610,20 @@ public:
             }
         } else {
             // Exploit: Return the action with the highest Q-value based on the neural network
-            std::vector<tensorflow::Tensor> outputs;
-            TF_CHECK_OK(session.Run({{modelInput, state.toTensor()}}, {qValues}, &outputs));
-            
-            // Assume Q-values tensor is 1D. Find the index of the maximum Q-value which corresponds to the best action.
-            auto q_values_t = outputs[0].flat<float>();
-            int bestActionIndex = std::distance(&q_values_t(0), std::max_element(&q_values_t(0), &q_values_t(0) + q_values_t.size()));
+            int bestActionIndex;
+            if (inferenceLoaded) {
+                // Native forward pass, a few microseconds instead of a session call
+                alignas(64) float features[64] = {};
+                state.toFeatures(features);
+                bestActionIndex = inference.best_action(features);
+            } else {
+                std::vector<tensorflow::Tensor> outputs;
+                TF_CHECK_OK(session.Run({{modelInput, state.toTensor()}}, {qValues}, &outputs));
+
+                // Assume Q-values tensor is 1D. Find the index of the maximum Q-value which corresponds to the best action.
+                auto q_values_t = outputs[0].flat<float>();
+                bestActionIndex = std::distance(&q_values_t(0), std::max_element(&q_values_t(0), &q_values_t(0) + q_values_t.size()));
+            }
             
             // Convert bestActionIndex to an actual Action object. For simplicity, we'll consider only 3 actions like before.
             switch(bestActionIndex) {
@@ -481,9 +643,9 @@ public:
     size_t batchSize() const {
         return batchSize;
     }
-    std::vector<Experience> sample() {
-        std::vector<Experience> batch;
-        std::sample(memory.begin(), memory.end(), std::back_inserter(batch), batchSize, std::mt19937{std::random_device{}()});
+    // Prioritised sample; the batch is reused, valid until the next call
+    const replay::SampleBatch& sample() {
+        memory.sample(batchSize, importanceBeta, sampleRng, batch);
         return batch;
     }
     void saveModel(const std::string& path) {
@@ -501,8 +663,11 @@ int main() {
     int maxStepsPerEpisode = 200;
 
     for (int episode = 0; episode < numberOfEpisodes; ++episode) {
-        State state = env.reset();  // Reset the environment to start a new episode
+        const State& state = env.reset();  // Reset the environment to start a new episode (a view, updated by step)
         double episodeReward = 0;
+        alignas(64) float row[64] = {};
+        alignas(64) float nextRow[64] = {};
+        state.toFeatures(row);
 
         for (int step = 0; step < maxStepsPerEpisode; ++step) {
             Action action = agent.act(state); // Let the agent decide on an action based on current state
@@ -511,15 +676,16 @@ int main() {
             auto [nextState, reward, done] = env.step(action);
             
             // Store the experience in the agent's memory
-            agent.remember(state, action, reward, nextState, done);
+            nextState.toFeatures(nextRow);
+            agent.remember(row, action, reward, nextRow, done);
 
             // Update the state and accumulate reward
-            state = nextState;
+            std::memcpy(row, nextRow, sizeof(row));
             episodeReward += reward;
 
             // Train the agent with a batch of experiences
             if (agent.memorySize() > agent.batchSize()) {
-                std::vector<Experience> batch = agent.sample();
+                const replay::SampleBatch& batch = agent.sample();
                 agent.train(batch);
             }
 
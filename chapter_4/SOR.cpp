@@ -30,6 +30,15 @@ Use this code at your own risk.
 #include <string>
 #include <vector>
 #include <random>
+#include <cstring>
+#include <cmath>
+#include <memory>
+#include <algorithm>
+#include "venue_metrics.hpp"
+#include "feature_builder.hpp"
+#include "mlp_inference.hpp"
+#include "replay_buffer.hpp"
+#include "vector_env.hpp"
 #include <tensorflow/core/public/session.h>
 #include <tensorflow/core/protobuf/meta_graph.pb.h>
 
@@ -37,8 +46,17 @@ class PortfolioState {
 private:
     double cashOnHand;
     int current_asset_count;  // Current number of assets held
-    std::map<std::string, double> assetPositions;  // Asset name to quantity mapping
-    std::map<std::string, double> pendingOrders;  // Asset name to quantity of pending orders
+    std::vector<double> assetPositions;  // Quantity by asset id (dense ids of the traded universe)
+    std::vector<double> pendingOrders;  // Quantity of pending orders by asset id
+
+    static void setAt(std::vector<double>& values, int32_t asset, double quantity) {
+        if (static_cast<size_t>(asset) >= values.size())
+            values.resize(static_cast<size_t>(asset) + 1, 0.0);
+        values[asset] = quantity;
+    }
+    static double getAt(const std::vector<double>& values, int32_t asset) {
+        return static_cast<size_t>(asset) < values.size() ? values[asset] : 0.0;  // Default to zero if not found
+    }
 
 public:
     // Constructor
@@ -61,32 +79,26 @@ public:
     }
 
     // Methods for asset positions
-    void setAssetPosition(const std::string& assetName, double quantity) {
-        assetPositions[assetName] = quantity;
+    void setAssetPosition(int32_t asset, double quantity) {
+        setAt(assetPositions, asset, quantity);
     }
 
-    double getAssetPosition(const std::string& assetName) const {
-        if (assetPositions.find(assetName) != assetPositions.end()) {
-            return assetPositions.at(assetName);
-        }
-        return 0.0;  // Default to zero if asset not found
+    double getAssetPosition(int32_t asset) const {
+        return getAt(assetPositions, asset);
     }
 
     // Methods for pending orders
-    void setPendingOrder(const std::string& assetName, double quantity) {
-        pendingOrders[assetName] = quantity;
+    void setPendingOrder(int32_t asset, double quantity) {
+        setAt(pendingOrders, asset, quantity);
     }
 
-    double getPendingOrder(const std::string& assetName) const {
-        if (pendingOrders.find(assetName) != pendingOrders.end()) {
-            return pendingOrders.at(assetName);
-        }
-        return 0.0;  // Default to zero if order not found
+    double getPendingOrder(int32_t asset) const {
+        return getAt(pendingOrders, asset);
     }
 
     // Clear pending order
-    void clearPendingOrder(const std::string& assetName) {
-        pendingOrders.erase(assetName);
+    void clearPendingOrder(int32_t asset) {
+        setAt(pendingOrders, asset, 0.0);
     }
 };
 
@@ -156,6 +168,14 @@ public:
     double getOrderCancelRate() const { return orderCancelRate; }
     double getHistoricalFillRate() const { return historicalFillRate; }
     std::string getVenueName() const { return venueName; }
+
+    // Refresh from the live venue metrics store (one consistent snapshot)
+    void update(const venue_metrics::VenueSnapshot& snapshot) {
+        slippageRate = snapshot.slippage_bps;
+        rejectionRate = snapshot.reject_rate;
+        orderCancelRate = snapshot.cancel_rate;
+        historicalFillRate = snapshot.fill_rate;
+    }
 };
 
 class Order {
@@ -193,6 +213,8 @@ private:
     PortfolioState current_portfolio_state;
     MarketData current_market_data;
     VenueMetrics venue_metrics;
+    const venue_metrics::VenueMetricsStore* live_metrics = nullptr;   // when set, read on every decision
+    int venue_id = 0;
 
     // Random number generator for simulation purposes (e.g., market fluctuations)
     std::mt19937 rng;
@@ -212,6 +234,12 @@ public:
         rng.seed(std::random_device()());
     }
 
+    // Route decisions on the live statistics of "venue" instead of the static metrics
+    void attachLiveMetrics(const venue_metrics::VenueMetricsStore* store, int venue) {
+        live_metrics = store;
+        venue_id = venue;
+    }
+
     // Get the current state representation of the environment
     std::vector<double> getStateRepresentation() const {
         std::vector<double> state_representation;
@@ -223,15 +251,34 @@ public:
         // Append market data details
         state_representation.push_back(current_market_data.getLastTradedPrice());
 
-        // Append venue metrics details
-        state_representation.push_back(venue_metrics.getSlippageRate());
-        state_representation.push_back(venue_metrics.getRejectionRate());
-        state_representation.push_back(venue_metrics.getOrderCancelRate());
-        state_representation.push_back(venue_metrics.getHistoricalFillRate());
+        // Append venue metrics details (lock-free snapshot read when the live store is attached)
+        VenueMetrics metrics = venue_metrics;
+        if (live_metrics != nullptr)
+            metrics.update(live_metrics->read(venue_id));
+        state_representation.push_back(metrics.getSlippageRate());
+        state_representation.push_back(metrics.getRejectionRate());
+        state_representation.push_back(metrics.getOrderCancelRate());
+        state_representation.push_back(metrics.getHistoricalFillRate());
 
         return state_representation;
     }
 
+    // Same state, written into a preallocated FeatureMatrix row (features::Feature order), no allocation
+    void writeState(float* row) const {
+        row[features::CASH] = static_cast<float>(current_portfolio_state.getCashOnHand());
+        row[features::ASSET_COUNT] = static_cast<float>(current_portfolio_state.getCurrentAssetCount());
+        row[features::PRICE] = static_cast<float>(current_market_data.getLastTradedPrice());
+        row[features::SPREAD] = static_cast<float>(current_market_data.getAskPrice() - current_market_data.getBidPrice());
+        row[features::VWAP] = 0;   // MarketData has no VWAP yet
+        VenueMetrics metrics = venue_metrics;
+        if (live_metrics != nullptr)
+            metrics.update(live_metrics->read(venue_id));
+        row[features::SLIPPAGE] = static_cast<float>(metrics.getSlippageRate());
+        row[features::REJECT_RATE] = static_cast<float>(metrics.getRejectionRate());
+        row[features::CANCEL_RATE] = static_cast<float>(metrics.getOrderCancelRate());
+        row[features::FILL_RATE] = static_cast<float>(metrics.getHistoricalFillRate());
+    }
+
     // Simulate the effect of an action taken by the DRL agent
     double step(const int action) {
         double reward = 0.0;
@@ -288,20 +335,28 @@ private:
     tensorflow::Scope scope;                   // TensorFlow computation scope
     tensorflow::Session session;               // TensorFlow session for computation
     tensorflow::Output model;                  // The neural network model (Deep Q-Network)
+    tensorflow::Output weights_1, weights_2, weights_output;   // its kernels (variables of the graph)
     double exploration_rate;                   // Current exploration rate for epsilon-greedy strategy
-    std::deque<Experience> experience_replay;  // Experience replay memory
-    int global_step;                           // Tracking the number of steps
-    const int TRAINING_INTERVAL = 100;         // Training frequency
+    int global_step;                           // Tracking the number of training steps
     const int BATCH_SIZE = 64;                 // Size of the training batch
     const int MAX_REPLAY_MEMORY_SIZE = 10000;  // Maximum size of replay memory
     const int TOTAL_POSSIBLE_ACTIONS = 3;      // Define this based on your problem
+    mlp::Network policy{256};                  // native copy of the Q-network for decisions
+    bool policy_loaded = false;
+    std::vector<float> q_values;               // batch x actions, reused
+    replay::ReplayBuffer replay_memory{10000, features::NUM_FEATURES};   // MAX_REPLAY_MEMORY_SIZE experiences
+    replay::SampleBatch mini_batch;            // reused by every training step
+    std::mt19937_64 sample_rng{std::random_device{}()};
+    double importance_beta = 0.4;              // annealed towards 1 over training
+    uint64_t rollout_seed = 1;                 // exploration streams, one per RolloutRunner
+    std::unique_ptr<rollout::RolloutRunner> runner;   // kept across collectExperience() calls
 
 
     tensorflow::Output buildModel(tensorflow::Input state_input) {
         // Define a simple feed-forward neural network here
-        auto layer_1 = tensorflow::ops::Relu(scope, tensorflow::ops::MatMul(scope, state_input, /* weights_1 */));
-        auto layer_2 = tensorflow::ops::Relu(scope, tensorflow::ops::MatMul(scope, layer_1, /* weights_2 */));
-        return tensorflow::ops::MatMul(scope, layer_2, /* weights_output */);
+        auto layer_1 = tensorflow::ops::Relu(scope, tensorflow::ops::MatMul(scope, state_input, weights_1));
+        auto layer_2 = tensorflow::ops::Relu(scope, tensorflow::ops::MatMul(scope, layer_1, weights_2));
+        return tensorflow::ops::MatMul(scope, layer_2, weights_output);
     }
     tensorflow::Tensor tensorFromState(const State& state) {
         // Placeholder tensor for our state data
@@ -325,13 +380,28 @@ private:
 
         return state_tensor;
     }
+    // A whole batch of states built by features::FeatureBuilder: one bulk copy into one tensor
+    // instead of a tensor per state. Rows keep their 16-float padding (zero), so the copy is a
+    // single memcpy; the first layer just has inert weights for the padding columns.
+    tensorflow::Tensor tensorFromBatch(const features::FeatureMatrix& batch) {
+        return tensorFromRows(batch.data(), batch.rows(), batch.stride());
+    }
+    tensorflow::Tensor tensorFromRows(const float* rows, size_t count, size_t stride) {
+        tensorflow::Tensor batch_tensor(tensorflow::DT_FLOAT,
+                                        tensorflow::TensorShape({static_cast<int64_t>(count), static_cast<int64_t>(stride)}));
+        std::memcpy(batch_tensor.flat<float>().data(), rows, count * stride * sizeof(float));
+        return batch_tensor;
+    }
     tensorflow::Tensor computeLoss(const std::vector<tensorflow::Tensor>& targetQs, 
                             const std::vector<tensorflow::Tensor>& predictedQs, 
                             const std::vector<tensorflow::Tensor>& actions, 
                             const std::vector<tensorflow::Tensor>& rewards, 
-                            const std::vector<tensorflow::Tensor>& done_flags) {
-        // Loss = Summation of (reward + gamma * max(targetQ) - predictedQ)^2
-        // where gamma is the discount factor
+                            const std::vector<tensorflow::Tensor>& done_flags,
+                            const std::vector<float>& weights,
+                            std::vector<float>& td_errors) {
+        // Loss = Summation of weight * (reward + gamma * max(targetQ) - predictedQ)^2
+        // where gamma is the discount factor and weight the importance sampling weight of
+        // the prioritised sample; the TD errors become the new priorities
 
         const float gamma = 0.99; // discount factor
         tensorflow::Tensor loss(tensorflow::DT_FLOAT, tensorflow::TensorShape({})); // scalar tensor to 
@@ -339,12 +409,13 @@ private:
         auto loss_tensor = loss.tensor<float, 0>();
 
         float accumulated_loss = 0.0;
+        td_errors.resize(targetQs.size());
         for(size_t i = 0; i < targetQs.size(); i++) {
             float max_targetQ = targetQs[i].tensor<float, 2>().maximum(); // assuming Q-values are in 2D tensor
             float predictedQ = predictedQs[i].tensor<float, 2>()(0, actions[i].tensor<int, 1>()(0));
-            accumulated_loss += std::pow(
-                rewards[i].tensor<float, 1>()(0) + gamma * max_targetQ * (1 - done_flags[i].tensor<float, 1>()(0)) 
-                - predictedQ, 2);
+            td_errors[i] = rewards[i].tensor<float, 1>()(0) + gamma * max_targetQ * (1 - done_flags[i].tensor<float, 1>()(0))
+                - predictedQ;
+            accumulated_loss += weights[i] * td_errors[i] * td_errors[i];
         }
 
         loss_tensor(0) = accumulated_loss / targetQs.size(); // average loss
@@ -395,30 +466,78 @@ public:
         return best_action;
     }
 
-    // Method to train the model based on experiences in replay memory
-    void train() {
-        // Check if it's time to train (based on a predefined interval)
-        if (global_step % TRAINING_INTERVAL != 0) {
-            return;
+    // Weights exported by the training side after each update (see mlp::Network for the format)
+    void loadPolicy(const std::string& path) {
+        policy.load(path);
+        policy_loaded = true;
+        if (runner)
+            runner->set_policy(&policy);
+    }
+
+    // Writes the Q-network's current weights in mlp::Network's format, for loadPolicy()
+    void exportPolicy(const std::string& path) {
+        std::vector<tensorflow::Tensor> kernels;
+        TF_CHECK_OK(session.Run({}, {weights_1, weights_2, weights_output}, &kernels));
+        mlp::Network exported(1);
+        for (size_t l = 0; l < kernels.size(); l++) {
+            size_t inputs = kernels[l].dim_size(0), outputs = kernels[l].dim_size(1);
+            std::vector<float> bias(outputs, 0.0f);   // the model's layers have no bias
+            exported.add_layer(inputs, outputs, l + 1 < kernels.size() ? mlp::Activation::RELU : mlp::Activation::NONE,
+                               kernels[l].flat<float>().data(), bias.data());
         }
+        exported.save(path);
+    }
 
-        // Sample a mini-batch from the replay memory
-        std::vector<Experience> mini_batch; // Initialize an empty vector
-        if(experience_replay.size() >= BATCH_SIZE) {
-            for(int i=0; i<BATCH_SIZE; i++) {
-                mini_batch.push_back(experience_replay[i]);
-            }
+    // Greedy action for one routing decision with the native network: no session call, no tensor
+    int chooseAction(const Environment& env) {
+        if (!policy_loaded)
+            throw std::logic_error("loadPolicy() must be called before native inference");
+        alignas(64) float row[features::ROW_STRIDE] = {};
+        env.writeState(row);
+        return policy.best_action(row);
+    }
+
+    // Greedy actions for a whole batch of decisions, read in place from the feature matrix
+    void chooseActions(const features::FeatureMatrix& batch, int* actions) {
+        if (!policy_loaded)
+            throw std::logic_error("loadPolicy() must be called before native inference");
+        size_t n = batch.rows();
+        q_values.resize(n * TOTAL_POSSIBLE_ACTIONS);
+        policy.forward(batch.data(), batch.stride(), n, q_values.data());
+        for (size_t i = 0; i < n; i++) {
+            const float* q = q_values.data() + i * TOTAL_POSSIBLE_ACTIONS;
+            actions[i] = static_cast<int>(std::max_element(q, q + TOTAL_POSSIBLE_ACTIONS) - q);
+        }
+    }
+
+    // Vectorised experience collection: all environments step in lockstep on the TBB pool with one
+    // batched inference per step (uniform actions until a policy is loaded); the transitions go
+    // straight into the replay memory. Replaces stepping one Environment at a time. Successive
+    // calls continue the same episodes, so training can run between short chunks of steps.
+    void collectExperience(rollout::VectorEnv& envs, size_t steps, double epsilon) {
+        if (!runner || &runner->environments() != &envs)
+            runner = std::make_unique<rollout::RolloutRunner>(envs, policy_loaded ? &policy : nullptr, &replay_memory, rollout_seed++);
+        runner->run(steps, epsilon);
+    }
+
+    // One training step on a mini-batch from the replay memory; false if there isn't one yet.
+    // The caller decides how often (see main)
+    bool train() {
+        // Sample a prioritised mini-batch from the replay memory (rows copied straight into mini_batch)
+        if (replay_memory.size() < BATCH_SIZE ||
+            replay_memory.sample(BATCH_SIZE, importance_beta, sample_rng, mini_batch) < BATCH_SIZE) {
+            return false;
         }
 
         // Prepare tensors for states, next_states, rewards, actions, and done_flags
-        // Convert the data from the mini_batch into TensorFlow tensors
-        std::vector<tensorflow::Tensor> states, next_states, rewards, actions, done_flags;
-        for (const auto& exp : mini_batch) {
-            states.push_back(tensorFromState(exp.state));
-            next_states.push_back(tensorFromState(exp.next_state));
-            rewards.push_back(tensorflow::Tensor(exp.reward));
-            actions.push_back(tensorflow::Tensor(exp.action));
-            done_flags.push_back(tensorflow::Tensor(exp.done));
+        // The state rows are already one contiguous batch, one copy each
+        std::vector<tensorflow::Tensor> states{tensorFromRows(mini_batch.states.data(), mini_batch.rows, mini_batch.stride)};
+        std::vector<tensorflow::Tensor> next_states{tensorFromRows(mini_batch.next_states.data(), mini_batch.rows, mini_batch.stride)};
+        std::vector<tensorflow::Tensor> rewards, actions, done_flags;
+        for (size_t i = 0; i < mini_batch.rows; i++) {
+            rewards.push_back(tensorflow::Tensor(mini_batch.rewards[i]));
+            actions.push_back(tensorflow::Tensor(mini_batch.actions[i]));
+            done_flags.push_back(tensorflow::Tensor(static_cast<float>(mini_batch.dones[i])));
         }
 
         // Compute the target Q-values using the Bellman equation
@@ -430,8 +549,12 @@ public:
         TF_CHECK_OK(session.Run({{states_input, states}}, {main_model}, &predicted_q_values_outputs));
 
         // Compute loss
+        std::vector<float> td_errors;
         tensorflow::Tensor loss = 
-            computeLoss(target_q_values_outputs, predicted_q_values_outputs, actions, rewards, done_flags);
+            computeLoss(target_q_values_outputs, predicted_q_values_outputs, actions, rewards, done_flags,
+                        mini_batch.weights, td_errors);
+        replay_memory.update_priorities(mini_batch, td_errors.data());
+        importance_beta = std::min(1.0, importance_beta + 1e-4);
 
         // Perform backpropagation using the optimizer
         TF_CHECK_OK(session.Run({{states_input, states}, {actions_input, actions}, 
@@ -439,65 +562,50 @@ public:
                                     {done_flags_input, done_flags}}, {optimizer, loss}, nullptr));
 
         global_step++;
+        return true;
     }
 
     // Method to update the agent's state after an action has been taken
-    void updateState(const Environment& env, const Action& action, double reward, const Environment& new_env) {
-        // Store the experience in the replay memory
-        Experience experience;
-        experience.state = env;
-        experience.action = action;
-        experience.reward = reward;
-        experience.new_state = new_env;
-
-        // If replay memory is full, remove the oldest experience
-        if (experience_replay.size() == MAX_REPLAY_MEMORY_SIZE) {
-            experience_replay.pop_front();
-        }
-
-        // Add the new experience to the replay memory
-        experience_replay.push_back(experience);
+    // Safe to call from several actor threads while train() runs
+    void updateState(const Environment& env, int action, double reward, const Environment& new_env, bool done = false) {
+        // Store the experience in the replay memory as two feature rows (the oldest is overwritten when full)
+        alignas(64) float state[features::ROW_STRIDE] = {};
+        alignas(64) float next_state[features::ROW_STRIDE] = {};
+        env.writeState(state);
+        new_env.writeState(next_state);
+        replay_memory.add(state, action, static_cast<float>(reward), next_state, done);
     }    
 };
 
 
+// Standalone replay memory for feature rows: a thin wrapper over replay::ReplayBuffer
+// (prioritised, lock-free, preallocated)
 class ExperienceReplay {
 private:
-    std::deque<Experience> memory;   // Deque to store experiences
-    int capacity;                    // Maximum number of experiences to store
+    replay::ReplayBuffer memory;     // Ring of fixed-size experiences with a priority sum-tree
+    std::mt19937_64 generator;
 
 public:
     // Constructor to initialize ExperienceReplay with a given capacity
-    ExperienceReplay(int capacity) : capacity(capacity) {}
-
-    // Method to add an experience to the replay memory
-    void add(const Experience& experience) {
-        // If the memory is full, remove the oldest experience
-        if (memory.size() == capacity) {
-            memory.pop_front();
-        }
+    ExperienceReplay(int capacity, int state_size = features::NUM_FEATURES)
+        : memory(capacity, state_size), generator(std::random_device{}()) {}
 
-        // Add the new experience
-        memory.push_back(experience);
+    // Method to add an experience to the replay memory (any thread)
+    void add(const float* state, int action, float reward, const float* next_state, bool done) {
+        memory.add(state, action, reward, next_state, done);
     }
 
-    // Method to sample a batch of experiences
-    std::vector<Experience> sample(int batch_size) {
+    // Method to sample a batch of experiences into a reusable batch
+    void sample(int batch_size, double beta, replay::SampleBatch& batch) {
         if (batch_size > memory.size()) {
             throw std::runtime_error("Batch size is larger than current memory size.");
         }
+        memory.sample(batch_size, beta, generator, batch);
+    }
 
-        std::random_device rd;
-        std::mt19937 generator(rd());
-        std::uniform_int_distribution<> distribution(0, memory.size() - 1);
-
-        std::vector<Experience> batch;
-        for (int i = 0; i < batch_size; ++i) {
-            int idx = distribution(generator);
-            batch.push_back(memory[idx]);
-        }
-
-        return batch;
+    // Method to feed the TD errors of a sampled batch back as priorities
+    void updatePriorities(const replay::SampleBatch& batch, const float* td_errors) {
+        memory.update_priorities(batch, td_errors);
     }
 
     // Method to get the current size of the memory
@@ -512,58 +620,48 @@ int main() {
     int total_episodes = 10000;  // Total episodes for training
     double epsilon = 1.0;  // Exploration rate
     double min_epsilon = 0.01;  // Minimum exploration rate
-    double epsilon_decay = 0.995;  // Decay rate for exploration
-    int training_interval = 10;  // Train the agent every x episodes
-
-    // Initialize the DRL agent and the simulated trading environment
+    double epsilon_decay = 0.995;  // Decay rate for exploration, per episode
+    const size_t num_envs = 256;  // Environments stepped in lockstep
+    const uint32_t episode_length = 1000;
+    const uint32_t training_interval = 16;  // Train the agent every x lockstep steps (x * num_envs transitions)
+    const int updates_per_interval = 64;  // Mini-batches of 64 per interval: each transition is replayed about once
+    const std::string policy_path = "sor_policy.mlp";  // Weights handed from training to the rollouts
+
+    // Initialize the DRL agent and the simulated trading environments
     DRLAgent agent;
-    SimulatedEnvironment env;
-
-    // Main execution loop
-    for (int episode = 0; episode < total_episodes; episode++) {
-        // Reset the environment for a new episode
-        State current_state = env.reset();
-
-        // Initialize episode reward
-        double episode_reward = 0.0;
-
-        // Continue until the episode is done
-        bool done = false;
-        while (!done) {
-            Action action;
-
-            // Decide action based on epsilon-greedy strategy
-            if (((double) rand() / (RAND_MAX)) < epsilon) {
-                action = agent.explore_action();  // Explore
-            } else {
-                action = agent.exploit_action(current_state);  // Exploit
+    rollout::EnvConfig config;
+    config.episode_length = episode_length;
+    rollout::VectorEnv envs(num_envs, config);
+
+    // Main execution loop: each pass runs one episode in every environment at once,
+    // so total_episodes / num_envs passes cover the same number of episodes
+    for (int episode = 0; episode < total_episodes; episode += num_envs) {
+        for (uint32_t step = 0; step < episode_length; step += training_interval) {
+            // Step all environments training_interval steps, storing every transition
+            uint32_t steps = std::min(training_interval, episode_length - step);
+            agent.collectExperience(envs, steps, epsilon);
+
+            // Train the agent on what the replay memory holds now, then act with the new weights
+            bool trained = false;
+            for (int update = 0; update < updates_per_interval; update++) {
+                trained = agent.train() || trained;
+            }
+            if (trained) {
+                agent.exportPolicy(policy_path);
+                agent.loadPolicy(policy_path);
             }
 
-            // Perform the action and get the new state and reward
-            State new_state;
-            double reward;
-            tie(new_state, reward, done) = env.perform_action(action);
-
-            // Store this experience in the agent's memory
-            agent.store_experience(current_state, action, reward, new_state, done);
-
-            // Update the current state and accumulate the reward
-            current_state = new_state;
-            episode_reward += reward;
-        }
-
-        // Train the agent at intervals
-        if (episode % training_interval == 0) {
-            agent.train();
+            // Decay the exploration rate once per episode: num_envs episodes every episode_length steps
+            epsilon = std::max(min_epsilon, epsilon * std::pow(epsilon_decay, static_cast<double>(num_envs) * steps / episode_length));
         }
 
-        // Decay the exploration rate
-        if (epsilon > min_epsilon) {
-            epsilon *= epsilon_decay;
+        // Log the mean episode reward (for illustration purposes)
+        double episode_reward = 0.0;
+        for (size_t i = 0; i < envs.size(); i++) {
+            episode_reward += envs.last_return_of(i);
         }
-
-        // Log episode reward (for illustration purposes)
-        std::cout << "Episode " << episode + 1 << ": Reward = " << episode_reward << std::endl;
+        std::cout << "Episodes " << episode + 1 << "-" << episode + num_envs << ": Mean reward = "
+                  << episode_reward / envs.size() << std::endl;
     }
 
     return 0;
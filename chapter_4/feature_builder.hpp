@@ -0,0 +1,146 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "venue_metrics.hpp"
+
+namespace features
+{
+
+// Column of each feature in a state row (the order the agent's network was trained with)
+enum Feature : int {
+    CASH,
+    ASSET_COUNT,
+    PRICE,
+    SPREAD,
+    VWAP,
+    SLIPPAGE,
+    REJECT_RATE,
+    CANCEL_RATE,
+    FILL_RATE,
+    NUM_FEATURES
+};
+
+// Rows are padded to 16 floats (one cache line, one AVX-512 register); padding stays zero
+const size_t ROW_STRIDE = 16;
+
+// batch x features, row-major, 64-byte aligned, allocated once. Inference and training
+// read it in place: row(i) is the state of decision i.
+class FeatureMatrix {
+private:
+    float* values;
+    size_t capacity;
+    size_t count;
+
+public:
+    FeatureMatrix(size_t max_rows) : capacity(max_rows), count(0) {
+        values = static_cast<float*>(std::aligned_alloc(64, max_rows * ROW_STRIDE * sizeof(float)));
+        if (values == nullptr)
+            throw std::bad_alloc();
+        std::memset(values, 0, max_rows * ROW_STRIDE * sizeof(float));
+    }
+    ~FeatureMatrix() { std::free(values); }
+    FeatureMatrix(const FeatureMatrix&) = delete;
+    FeatureMatrix& operator=(const FeatureMatrix&) = delete;
+
+    float* row(size_t i) { return values + i * ROW_STRIDE; }
+    const float* row(size_t i) const { return values + i * ROW_STRIDE; }
+    const float* data() const { return values; }
+    size_t rows() const { return count; }
+    size_t max_rows() const { return capacity; }
+    size_t stride() const { return ROW_STRIDE; }
+    void set_rows(size_t n) { count = n; }
+};
+
+// Inputs, one array per field (SoA), indexed by portfolio / instrument / venue id
+struct PortfolioArrays {
+    std::vector<float> cash;
+    std::vector<float> asset_count;
+};
+struct MarketArrays {
+    std::vector<float> price;
+    std::vector<float> spread;
+    std::vector<float> vwap;
+};
+struct VenueArrays {
+    std::vector<float> slippage;
+    std::vector<float> reject_rate;
+    std::vector<float> cancel_rate;
+    std::vector<float> fill_rate;
+
+    // One consistent snapshot per venue, taken once per batch rather than once per decision
+    void refresh(const venue_metrics::VenueMetricsStore& store) {
+        size_t n = store.venues();
+        slippage.resize(n);
+        reject_rate.resize(n);
+        cancel_rate.resize(n);
+        fill_rate.resize(n);
+        for (size_t v = 0; v < n; v++) {
+            venue_metrics::VenueSnapshot s = store.read(static_cast<int32_t>(v));
+            slippage[v] = static_cast<float>(s.slippage_bps);
+            reject_rate[v] = static_cast<float>(s.reject_rate);
+            cancel_rate[v] = static_cast<float>(s.cancel_rate);
+            fill_rate[v] = static_cast<float>(s.fill_rate);
+        }
+    }
+};
+
+// One routing decision to score: which portfolio, instrument and venue
+struct Decision {
+    int32_t portfolio;
+    int32_t instrument;
+    int32_t venue;
+};
+
+// Writes the state rows of a batch of decisions straight into a FeatureMatrix:
+// no vector per state, no tensor per state. Features are normalised on the way,
+// (x - offset) * scale per column (identity until set_normalization is called).
+class FeatureBuilder {
+private:
+    alignas(64) float offset[ROW_STRIDE];
+    alignas(64) float scale[ROW_STRIDE];
+
+public:
+    FeatureBuilder() {
+        for (size_t i = 0; i < ROW_STRIDE; i++) {
+            offset[i] = 0;
+            scale[i] = i < NUM_FEATURES ? 1.0f : 0.0f;   // keeps the padding at zero
+        }
+    }
+
+    // e.g. mean and 1/stddev of the training set
+    void set_normalization(Feature feature, float mean, float inv_stddev) {
+        offset[feature] = mean;
+        scale[feature] = inv_stddev;
+    }
+
+    // Returns the number of rows written (capped at out.max_rows())
+    size_t build(const Decision* decisions, size_t n, const PortfolioArrays& portfolio, const MarketArrays& market,
+                 const VenueArrays& venues, FeatureMatrix& out) const {
+        if (n > out.max_rows())
+            n = out.max_rows();
+        for (size_t i = 0; i < n; i++) {
+            const Decision& d = decisions[i];
+            float* row = out.row(i);
+            row[CASH] = portfolio.cash[d.portfolio];
+            row[ASSET_COUNT] = portfolio.asset_count[d.portfolio];
+            row[PRICE] = market.price[d.instrument];
+            row[SPREAD] = market.spread[d.instrument];
+            row[VWAP] = market.vwap[d.instrument];
+            row[SLIPPAGE] = venues.slippage[d.venue];
+            row[REJECT_RATE] = venues.reject_rate[d.venue];
+            row[CANCEL_RATE] = venues.cancel_rate[d.venue];
+            row[FILL_RATE] = venues.fill_rate[d.venue];
+            // whole row at once, the compiler turns this into one or two vector ops
+            for (size_t f = 0; f < ROW_STRIDE; f++)
+                row[f] = (row[f] - offset[f]) * scale[f];
+        }
+        out.set_rows(n);
+        return n;
+    }
+};
+
+} // namespace features
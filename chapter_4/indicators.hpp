@@ -0,0 +1,302 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace indicators
+{
+
+const size_t TICKER_PAD = 8;    // doubles per AVX-512 register, per-ticker arrays are padded to it
+
+// Columns written by IndicatorEngine::write_features, in this order
+enum Indicator : int {
+    MEAN,
+    STDDEV,
+    EMA,
+    VWAP,
+    MIN,
+    MAX,
+    BAR_RETURN,
+    WINDOW_RETURN,
+    NUM_INDICATORS
+};
+
+// Rolling indicators over the last `window` bars of a universe of tickers, updated with one bar of
+// every ticker at a time:
+// - mean / variance: sliding Welford update (the leaving bar replaced by the new one), no
+//   sum-of-squares cancellation
+// - EMA, volume weighted average price over the window, bar and window returns
+// - min / max: van Herk / Gil-Werman. The window is the start of this lap of the ring plus the
+//   end of the previous lap, so it is min(running min of this lap, suffix min of the previous lap)
+//   with the suffixes computed once per lap. O(1) per bar like a monotonic deque, but branch
+//   free (a deque's pops mispredict on every price reversal: 4x slower overall here)
+// Everything is O(1) per ticker per bar. Per-ticker state is one array per field, so the update
+// is a loop over tickers: 8 per AVX-512 iteration, the scalar loop is the reference and the
+// fallback (same operations, explicit fma in both, so the results are bit-identical). The
+// running sums are recomputed exactly from the window once per lap, so rounding doesn't
+// accumulate over a long history.
+// A NaN price (no bar that day, e.g. a gap in an ohlcv::OhlcvStore) carries the last price
+// forward with zero volume; a ticker's first bar must have a price.
+class IndicatorEngine {
+private:
+    size_t n;              // tickers
+    size_t padded;         // n rounded up to TICKER_PAD, row length of the rings
+    size_t length;         // window
+    double alpha;          // EMA weight of the new bar
+    uint64_t count = 0;    // bars seen
+    std::vector<double> prices;    // [window][padded] ring, bar b in row b % window
+    std::vector<double> volumes;
+    std::vector<double> mean;
+    std::vector<double> m2;        // sum of squared deviations from the mean over the window
+    std::vector<double> ema;
+    std::vector<double> pv;        // sum of price x volume over the window
+    std::vector<double> volume_sum;
+    std::vector<double> last;
+    std::vector<double> bar_return;
+    std::vector<double> prefix_min;     // over this lap of the ring (rows 0..current)
+    std::vector<double> prefix_max;
+    std::vector<double> suffix_min;     // [window + 1][padded], row r: rows r.. of the previous lap
+    std::vector<double> suffix_max;
+    std::vector<double> low;
+    std::vector<double> high;
+
+    double price_at(uint64_t bar, size_t t) const { return prices[(bar % length) * padded + t]; }
+
+    void update_scalar(size_t begin, size_t end, const double* price, const double* volume, size_t row) {
+        bool filling = count < length;
+        double inv_n = 1.0 / static_cast<double>(count + 1);
+        double inv_w = 1.0 / static_cast<double>(length);
+        double* ring_p = &prices[row * padded];
+        double* ring_v = &volumes[row * padded];
+        const double* rest_min = &suffix_min[(row + 1) * padded];
+        const double* rest_max = &suffix_max[(row + 1) * padded];
+        for (size_t t = begin; t < end; t++) {
+            double x = price[t];
+            double v = volume[t];
+            if (std::isnan(x)) {
+                x = last[t];
+                v = 0;
+            }
+            if (std::isnan(v))
+                v = 0;
+            if (filling) {
+                double delta = x - mean[t];
+                double new_mean = std::fma(delta, inv_n, mean[t]);
+                m2[t] = std::fma(delta, x - new_mean, m2[t]);
+                mean[t] = new_mean;
+                pv[t] = std::fma(x, v, pv[t]);
+                volume_sum[t] = volume_sum[t] + v;
+            }
+            else {
+                double old = ring_p[t];
+                double old_v = ring_v[t];
+                double delta = x - old;
+                double new_mean = std::fma(delta, inv_w, mean[t]);
+                m2[t] = std::fma(delta, (x - new_mean) + (old - mean[t]), m2[t]);
+                mean[t] = new_mean;
+                pv[t] = std::fma(-old, old_v, std::fma(x, v, pv[t]));
+                volume_sum[t] = (volume_sum[t] + v) - old_v;
+            }
+            m2[t] = m2[t] < 0 ? 0 : m2[t];
+            if (count == 0) {
+                ema[t] = x;
+                bar_return[t] = 0;
+            }
+            else {
+                ema[t] = std::fma(alpha, x - ema[t], ema[t]);
+                bar_return[t] = x / last[t] - 1;
+            }
+            double lo = x, hi = x;
+            if (row != 0) {
+                lo = prefix_min[t] < x ? prefix_min[t] : x;
+                hi = prefix_max[t] > x ? prefix_max[t] : x;
+            }
+            prefix_min[t] = lo;
+            prefix_max[t] = hi;
+            low[t] = rest_min[t] < lo ? rest_min[t] : lo;
+            high[t] = rest_max[t] > hi ? rest_max[t] : hi;
+            last[t] = x;
+            ring_p[t] = x;
+            ring_v[t] = v;
+        }
+    }
+
+#if defined(__AVX512F__)
+    // Same operations in the same order as update_scalar
+    void update_simd(const double* price, const double* volume, size_t row) {
+        bool filling = count < length;
+        const __m512d zero = _mm512_setzero_pd();
+        const __m512d one = _mm512_set1_pd(1.0);
+        const __m512d inv_n = _mm512_set1_pd(1.0 / static_cast<double>(count + 1));
+        const __m512d inv_w = _mm512_set1_pd(1.0 / static_cast<double>(length));
+        const __m512d a = _mm512_set1_pd(alpha);
+        double* ring_p = &prices[row * padded];
+        double* ring_v = &volumes[row * padded];
+        const double* rest_min = &suffix_min[(row + 1) * padded];
+        const double* rest_max = &suffix_max[(row + 1) * padded];
+        size_t t = 0;
+        for (; t + 8 <= n; t += 8) {
+            __m512d x = _mm512_loadu_pd(price + t);
+            __m512d v = _mm512_loadu_pd(volume + t);
+            __m512d prev = _mm512_loadu_pd(&last[t]);
+            __mmask8 gap = _mm512_cmp_pd_mask(x, x, _CMP_UNORD_Q);
+            x = _mm512_mask_blend_pd(gap, x, prev);
+            v = _mm512_mask_blend_pd(gap | _mm512_cmp_pd_mask(v, v, _CMP_UNORD_Q), v, zero);
+            __m512d m = _mm512_loadu_pd(&mean[t]);
+            __m512d s = _mm512_loadu_pd(&m2[t]);
+            __m512d new_mean, new_pv, new_volume;
+            if (filling) {
+                __m512d delta = _mm512_sub_pd(x, m);
+                new_mean = _mm512_fmadd_pd(delta, inv_n, m);
+                s = _mm512_fmadd_pd(delta, _mm512_sub_pd(x, new_mean), s);
+                new_pv = _mm512_fmadd_pd(x, v, _mm512_loadu_pd(&pv[t]));
+                new_volume = _mm512_add_pd(_mm512_loadu_pd(&volume_sum[t]), v);
+            }
+            else {
+                __m512d old = _mm512_loadu_pd(ring_p + t);
+                __m512d old_v = _mm512_loadu_pd(ring_v + t);
+                __m512d delta = _mm512_sub_pd(x, old);
+                new_mean = _mm512_fmadd_pd(delta, inv_w, m);
+                s = _mm512_fmadd_pd(delta, _mm512_add_pd(_mm512_sub_pd(x, new_mean), _mm512_sub_pd(old, m)), s);
+                new_pv = _mm512_fnmadd_pd(old, old_v, _mm512_fmadd_pd(x, v, _mm512_loadu_pd(&pv[t])));
+                new_volume = _mm512_sub_pd(_mm512_add_pd(_mm512_loadu_pd(&volume_sum[t]), v), old_v);
+            }
+            // maskz: GCC 12 warns about the undefined source operand of the plain intrinsic
+            _mm512_storeu_pd(&m2[t], _mm512_maskz_max_pd(0xFF, zero, s));
+            _mm512_storeu_pd(&mean[t], new_mean);
+            _mm512_storeu_pd(&pv[t], new_pv);
+            _mm512_storeu_pd(&volume_sum[t], new_volume);
+            if (count == 0) {
+                _mm512_storeu_pd(&ema[t], x);
+                _mm512_storeu_pd(&bar_return[t], zero);
+            }
+            else {
+                __m512d e = _mm512_loadu_pd(&ema[t]);
+                _mm512_storeu_pd(&ema[t], _mm512_fmadd_pd(a, _mm512_sub_pd(x, e), e));
+                _mm512_storeu_pd(&bar_return[t], _mm512_sub_pd(_mm512_div_pd(x, prev), one));
+            }
+            __m512d lo = x, hi = x;
+            if (row != 0) {
+                lo = _mm512_maskz_min_pd(0xFF, _mm512_loadu_pd(&prefix_min[t]), x);
+                hi = _mm512_maskz_max_pd(0xFF, _mm512_loadu_pd(&prefix_max[t]), x);
+            }
+            _mm512_storeu_pd(&prefix_min[t], lo);
+            _mm512_storeu_pd(&prefix_max[t], hi);
+            _mm512_storeu_pd(&low[t], _mm512_maskz_min_pd(0xFF, _mm512_loadu_pd(rest_min + t), lo));
+            _mm512_storeu_pd(&high[t], _mm512_maskz_max_pd(0xFF, _mm512_loadu_pd(rest_max + t), hi));
+            _mm512_storeu_pd(&last[t], x);
+            _mm512_storeu_pd(ring_p + t, x);
+            _mm512_storeu_pd(ring_v + t, v);
+        }
+        update_scalar(t, n, price, volume, row);
+    }
+#endif
+
+    // Once per lap of the ring (window bars): exact sums over the window replace the running
+    // ones, and the suffix min / max of the lap just finished are taken for the next one
+    void end_lap() {
+        for (size_t r = length; r-- > 0;)
+            for (size_t t = 0; t < n; t++) {
+                double x = prices[r * padded + t];
+                double rest_lo = suffix_min[(r + 1) * padded + t], rest_hi = suffix_max[(r + 1) * padded + t];
+                suffix_min[r * padded + t] = rest_lo < x ? rest_lo : x;
+                suffix_max[r * padded + t] = rest_hi > x ? rest_hi : x;
+            }
+
+        std::fill(mean.begin(), mean.end(), 0.0);
+        std::fill(m2.begin(), m2.end(), 0.0);
+        std::fill(pv.begin(), pv.end(), 0.0);
+        std::fill(volume_sum.begin(), volume_sum.end(), 0.0);
+        for (size_t r = 0; r < length; r++)
+            for (size_t t = 0; t < n; t++) {
+                mean[t] += prices[r * padded + t];
+                pv[t] += prices[r * padded + t] * volumes[r * padded + t];
+                volume_sum[t] += volumes[r * padded + t];
+            }
+        for (size_t t = 0; t < n; t++)
+            mean[t] /= static_cast<double>(length);
+        for (size_t r = 0; r < length; r++)
+            for (size_t t = 0; t < n; t++) {
+                double d = prices[r * padded + t] - mean[t];
+                m2[t] += d * d;
+            }
+    }
+
+public:
+    // ema_span: EMA weight 2 / (span + 1), the window length if 0
+    IndicatorEngine(size_t tickers, size_t window, size_t ema_span = 0)
+        : n(tickers), padded((tickers + TICKER_PAD - 1) / TICKER_PAD * TICKER_PAD), length(std::max<size_t>(window, 1)),
+          alpha(2.0 / (static_cast<double>(ema_span == 0 ? length : ema_span) + 1.0)),
+          prices(length * padded), volumes(length * padded), mean(padded), m2(padded), ema(padded), pv(padded),
+          volume_sum(padded), last(padded), bar_return(padded), prefix_min(padded), prefix_max(padded),
+          suffix_min((length + 1) * padded), suffix_max((length + 1) * padded), low(padded), high(padded) {
+        reset();
+    }
+
+    void reset() {
+        count = 0;
+        for (std::vector<double>* field : {&prices, &volumes, &mean, &m2, &ema, &pv, &volume_sum, &last, &bar_return})
+            std::fill(field->begin(), field->end(), 0.0);
+        for (std::vector<double>* field : {&prefix_min, &prefix_max, &low, &high})
+            std::fill(field->begin(), field->end(), 0.0);
+        // no previous lap yet: the suffixes don't constrain the window
+        std::fill(suffix_min.begin(), suffix_min.end(), std::numeric_limits<double>::infinity());
+        std::fill(suffix_max.begin(), suffix_max.end(), -std::numeric_limits<double>::infinity());
+    }
+
+    // One bar for every ticker: price[tickers()] (e.g. the close) and volume[tickers()]
+    void update(const double* price, const double* volume, bool vectorised = true) {
+        size_t row = count % length;
+#if defined(__AVX512F__)
+        if (vectorised)
+            update_simd(price, volume, row);
+        else
+            update_scalar(0, n, price, volume, row);
+#else
+        (void)vectorised;
+        update_scalar(0, n, price, volume, row);
+#endif
+        count++;
+        if (count % length == 0)
+            end_lap();
+    }
+
+    size_t tickers() const { return n; }
+    size_t window() const { return length; }
+    uint64_t bars() const { return count; }
+    bool ready() const { return count >= length; }     // the window is full
+    size_t filled() const { return static_cast<size_t>(std::min<uint64_t>(count, length)); }
+
+    double rolling_mean(size_t t) const { return mean[t]; }
+    // Sample variance over the window (0 until two bars)
+    double variance(size_t t) const { return filled() > 1 ? m2[t] / static_cast<double>(filled() - 1) : 0.0; }
+    double stddev(size_t t) const { return std::sqrt(variance(t)); }
+    double exponential_average(size_t t) const { return ema[t]; }
+    double vwap(size_t t) const { return volume_sum[t] > 0 ? pv[t] / volume_sum[t] : last[t]; }
+    double rolling_min(size_t t) const { return low[t]; }
+    double rolling_max(size_t t) const { return high[t]; }
+    double last_return(size_t t) const { return bar_return[t]; }
+    // Latest price over the oldest one in the window
+    double window_return(size_t t) const { return count == 0 ? 0.0 : last[t] / price_at(count - filled(), t) - 1; }
+    double last_price(size_t t) const { return last[t]; }
+
+    // The ticker's indicators as floats in Indicator order, e.g. into a state row
+    void write_features(size_t t, float* row) const {
+        row[MEAN] = static_cast<float>(rolling_mean(t));
+        row[STDDEV] = static_cast<float>(stddev(t));
+        row[EMA] = static_cast<float>(exponential_average(t));
+        row[VWAP] = static_cast<float>(vwap(t));
+        row[MIN] = static_cast<float>(rolling_min(t));
+        row[MAX] = static_cast<float>(rolling_max(t));
+        row[BAR_RETURN] = static_cast<float>(last_return(t));
+        row[WINDOW_RETURN] = static_cast<float>(window_return(t));
+    }
+};
+
+} // namespace indicators
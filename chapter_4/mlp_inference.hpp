@@ -0,0 +1,372 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace mlp
+{
+
+// Every row (weights, activations) is padded to a multiple of 16 floats and 64-byte aligned:
+// the kernels never need a remainder loop, and a features::FeatureMatrix (16 floats per row)
+// is read in place as the input of the first layer.
+const size_t PAD = 16;
+const size_t BATCH_BLOCK = 64;   // input rows kept hot in L2 while every weight panel goes over them
+
+inline size_t padded(size_t n) { return (n + PAD - 1) / PAD * PAD; }
+
+// 64-byte aligned array, sized once
+template <class T>
+class AlignedBuffer {
+private:
+    T* values = nullptr;
+    size_t count = 0;
+
+public:
+    AlignedBuffer() = default;
+    explicit AlignedBuffer(size_t n) { resize(n); }
+    ~AlignedBuffer() { std::free(values); }
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+    AlignedBuffer(AlignedBuffer&& other) noexcept : values(other.values), count(other.count) {
+        other.values = nullptr;
+        other.count = 0;
+    }
+
+    void resize(size_t n) {
+        std::free(values);
+        size_t bytes = (n * sizeof(T) + 63) / 64 * 64;
+        values = static_cast<T*>(std::aligned_alloc(64, bytes > 0 ? bytes : 64));
+        if (values == nullptr)
+            throw std::bad_alloc();
+        std::memset(values, 0, bytes);
+        count = n;
+    }
+    T* data() { return values; }
+    const T* data() const { return values; }
+    T& operator[](size_t i) { return values[i]; }
+    const T& operator[](size_t i) const { return values[i]; }
+    size_t size() const { return count; }
+};
+
+// ---- float kernels ---------------------------------------------------------------------------
+// One vector type for the host: AVX-512 (16 floats), AVX2+FMA (8 floats) or scalar.
+#if defined(__AVX512F__)
+typedef __m512 vfloat;
+const size_t VW = 16;
+inline vfloat vzero() { return _mm512_setzero_ps(); }
+inline vfloat vload(const float* p) { return _mm512_loadu_ps(p); }
+inline vfloat vbroadcast(float x) { return _mm512_set1_ps(x); }
+inline vfloat vfmadd(vfloat a, vfloat b, vfloat c) { return _mm512_fmadd_ps(a, b, c); }
+inline vfloat vmax(vfloat a, vfloat b) { return _mm512_maskz_max_ps(0xFFFF, a, b); }   // GCC 12 warns on _mm512_max_ps
+inline void vstore(float* p, vfloat v) { _mm512_storeu_ps(p, v); }
+#elif defined(__AVX2__) && defined(__FMA__)
+typedef __m256 vfloat;
+const size_t VW = 8;
+inline vfloat vzero() { return _mm256_setzero_ps(); }
+inline vfloat vload(const float* p) { return _mm256_loadu_ps(p); }
+inline vfloat vbroadcast(float x) { return _mm256_set1_ps(x); }
+inline vfloat vfmadd(vfloat a, vfloat b, vfloat c) { return _mm256_fmadd_ps(a, b, c); }
+inline vfloat vmax(vfloat a, vfloat b) { return _mm256_max_ps(a, b); }
+inline void vstore(float* p, vfloat v) { _mm256_storeu_ps(p, v); }
+#else
+typedef float vfloat;
+const size_t VW = 1;
+inline vfloat vzero() { return 0.0f; }
+inline vfloat vload(const float* p) { return *p; }
+inline vfloat vbroadcast(float x) { return x; }
+inline vfloat vfmadd(vfloat a, vfloat b, vfloat c) { return a * b + c; }
+inline vfloat vmax(vfloat a, vfloat b) { return a > b ? a : b; }
+inline void vstore(float* p, vfloat v) { *p = v; }
+#endif
+
+// R input rows x NV vectors of outputs, all in registers: each weight vector feeds R rows and
+// each broadcast input feeds NV vectors. Outputs are computed a vector at a time, so there is
+// no horizontal sum anywhere; every output accumulates in the same order whatever R is, so a
+// state gives the same bits alone or inside a batch.
+template <size_t R, size_t NV>
+inline void dense_tile(const float* w, size_t n, size_t inputs, const float* bias, bool relu, const float* x, size_t x_stride,
+                       float* y, size_t y_stride) {
+    vfloat acc[R][NV];
+    for (size_t r = 0; r < R; r++)
+        for (size_t v = 0; v < NV; v++)
+            acc[r][v] = vload(bias + v * VW);
+    for (size_t i = 0; i < inputs; i++) {
+        vfloat wv[NV];
+        for (size_t v = 0; v < NV; v++)
+            wv[v] = vload(w + i * n + v * VW);
+        for (size_t r = 0; r < R; r++) {
+            vfloat xv = vbroadcast(x[r * x_stride + i]);
+            for (size_t v = 0; v < NV; v++)
+                acc[r][v] = vfmadd(xv, wv[v], acc[r][v]);
+        }
+    }
+    for (size_t r = 0; r < R; r++)
+        for (size_t v = 0; v < NV; v++)
+            vstore(y + r * y_stride + v * VW, relu ? vmax(acc[r][v], vzero()) : acc[r][v]);
+}
+
+// y[r][o] = act(sum_i x[r][i] * w[i][o] + bias[o]) for r < rows and all n (padded) outputs;
+// the padding outputs have zero weights and bias, so they come out zero.
+// w: inputs x n, TensorFlow's kernel layout with rows padded to n. x: rows x x_stride, y: rows x y_stride.
+// Loop order: a block of 64 input rows, then every panel of 4 output vectors over it, so the block
+// stays in L2 and the panel (inputs x 4 vectors) in L1. A single state (rows = 1) is the GEMV case.
+inline void dense_float(const float* w, const float* bias, size_t n, size_t inputs, bool relu, const float* x, size_t x_stride,
+                        size_t rows, float* y, size_t y_stride) {
+    for (size_t rb = 0; rb < rows; rb += BATCH_BLOCK) {
+        size_t re = std::min(rows, rb + BATCH_BLOCK);
+        size_t o = 0;
+        for (; o + 4 * VW <= n; o += 4 * VW) {
+            size_t r = rb;
+            for (; r + 4 <= re; r += 4)
+                dense_tile<4, 4>(w + o, n, inputs, bias + o, relu, x + r * x_stride, x_stride, y + r * y_stride + o, y_stride);
+            for (; r < re; r++)
+                dense_tile<1, 4>(w + o, n, inputs, bias + o, relu, x + r * x_stride, x_stride, y + r * y_stride + o, y_stride);
+        }
+        for (; o < n; o += VW) {
+            size_t r = rb;
+            for (; r + 4 <= re; r += 4)
+                dense_tile<4, 1>(w + o, n, inputs, bias + o, relu, x + r * x_stride, x_stride, y + r * y_stride + o, y_stride);
+            for (; r < re; r++)
+                dense_tile<1, 1>(w + o, n, inputs, bias + o, relu, x + r * x_stride, x_stride, y + r * y_stride + o, y_stride);
+        }
+    }
+}
+
+// ---- int8 kernels ----------------------------------------------------------------------------
+// Symmetric quantisation: weights per output row (scale = max|w| / 127), activations per input
+// row at run time. The dot product accumulates in int32, then y = acc * w_scale * x_scale + bias.
+inline int32_t dot_int8(const int8_t* a, const int8_t* b, size_t k) {
+#if defined(__AVX2__)
+    __m256i acc = _mm256_setzero_si256();
+    for (size_t i = 0; i < k; i += 16) {
+        __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));   // pairs of int16 products into int32
+    }
+    __m128i x = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(x);
+#else
+    int32_t acc = 0;
+    for (size_t i = 0; i < k; i++)
+        acc += static_cast<int32_t>(a[i]) * b[i];
+    return acc;
+#endif
+}
+
+inline float quantize_row(const float* x, size_t k, int8_t* q) {
+    float max_abs = 0;
+    for (size_t i = 0; i < k; i++)
+        max_abs = std::max(max_abs, std::fabs(x[i]));
+    float scale = max_abs > 0 ? max_abs / 127.0f : 1.0f;
+    float inv = 1.0f / scale;
+    for (size_t i = 0; i < k; i++)
+        q[i] = static_cast<int8_t>(std::lrint(x[i] * inv));
+    return scale;
+}
+
+enum class Activation : uint32_t { NONE = 0, RELU = 1 };
+
+struct DenseLayer {
+    size_t inputs;
+    size_t outputs;
+    size_t k;                        // inputs padded
+    size_t n;                        // outputs padded
+    Activation activation;
+    AlignedBuffer<float> weights;    // inputs x n, row i = the weights of input i to every output
+    AlignedBuffer<float> bias;       // n, the padding zero
+    bool quantized = false;
+    AlignedBuffer<int8_t> weights_q; // outputs x k, row o = the weights of output o (dot products)
+    AlignedBuffer<float> weight_scale;
+};
+
+// Small dense network (the Q-networks of the SOR and RMS agents) evaluated natively:
+// no session, no graph, no allocation per call. Sized for up to max_batch states per call.
+//
+// Weight file (little endian), written by the training side after each export:
+//   "MLP1", uint32 layers, then per layer: uint32 inputs, uint32 outputs, uint32 activation
+//   (0 none, 1 relu), float kernel[inputs][outputs] (TensorFlow Dense layout), float bias[outputs]
+class Network {
+private:
+    std::vector<DenseLayer> layers;
+    size_t max_batch;
+    size_t max_width;
+    AlignedBuffer<float> act[2];     // ping-pong activations, max_batch x max_width
+    AlignedBuffer<int8_t> act_q;     // quantised input rows
+    AlignedBuffer<float> act_scale;
+    AlignedBuffer<float> single;     // outputs of best_action()
+
+    void allocate() {
+        max_width = PAD;
+        for (const DenseLayer& l : layers)
+            max_width = std::max(max_width, std::max(l.k, l.n));
+        act[0].resize(max_batch * max_width);
+        act[1].resize(max_batch * max_width);
+        act_q.resize(max_batch * max_width);
+        act_scale.resize(max_batch);
+        single.resize(layers.empty() ? PAD : padded(layers.back().outputs));
+    }
+
+    // A network without layers (default constructed, or not loaded yet) can't be evaluated
+    const DenseLayer& first() const {
+        if (layers.empty())
+            throw std::logic_error("Network has no layers");
+        return layers.front();
+    }
+    const DenseLayer& last() const {
+        if (layers.empty())
+            throw std::logic_error("Network has no layers");
+        return layers.back();
+    }
+
+    void run_layer(const DenseLayer& l, const float* x, size_t x_stride, size_t rows, float* y, size_t y_stride) {
+        if (!l.quantized) {
+            dense_float(l.weights.data(), l.bias.data(), l.n, l.inputs, l.activation == Activation::RELU, x, x_stride, rows, y, y_stride);
+            return;
+        }
+        for (size_t r = 0; r < rows; r++)
+            act_scale[r] = quantize_row(x + r * x_stride, l.k, act_q.data() + r * max_width);
+        for (size_t o = 0; o < l.outputs; o++) {
+            const int8_t* wo = l.weights_q.data() + o * l.k;
+            float ws = l.weight_scale[o];
+            for (size_t r = 0; r < rows; r++) {
+                float v = dot_int8(wo, act_q.data() + r * max_width, l.k) * ws * act_scale[r] + l.bias[o];
+                y[r * y_stride + o] = l.activation == Activation::RELU && v < 0 ? 0.0f : v;
+            }
+        }
+        // the padding of the next layer's input must be zero
+        for (size_t r = 0; r < rows; r++)
+            for (size_t o = l.outputs; o < l.n; o++)
+                y[r * y_stride + o] = 0;
+    }
+
+public:
+    explicit Network(size_t max_batch = 256) : max_batch(max_batch), max_width(PAD) {}
+
+    // kernel in TensorFlow layout: kernel[i * outputs + o]
+    void add_layer(size_t inputs, size_t outputs, Activation activation, const float* kernel, const float* bias) {
+        if (!layers.empty() && layers.back().outputs != inputs)
+            throw std::runtime_error("Layer inputs do not match the previous layer outputs");
+        DenseLayer l;
+        l.inputs = inputs;
+        l.outputs = outputs;
+        l.k = padded(inputs);
+        l.n = padded(outputs);
+        l.activation = activation;
+        l.weights.resize(inputs * l.n);
+        l.bias.resize(l.n);
+        for (size_t i = 0; i < inputs; i++)
+            std::memcpy(&l.weights[i * l.n], kernel + i * outputs, outputs * sizeof(float));
+        std::memcpy(l.bias.data(), bias, outputs * sizeof(float));
+        layers.push_back(std::move(l));
+        allocate();
+    }
+
+    void load(const std::string& path) {
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (f == nullptr)
+            throw std::runtime_error("Cannot open weights file " + path);
+        char magic[4];
+        uint32_t count = 0;
+        bool ok = std::fread(magic, 1, 4, f) == 4 && std::memcmp(magic, "MLP1", 4) == 0 && std::fread(&count, 4, 1, f) == 1;
+        std::vector<DenseLayer> previous;
+        previous.swap(layers);
+        std::vector<float> kernel, bias;
+        for (uint32_t n = 0; ok && n < count; n++) {
+            uint32_t header[3];
+            ok = std::fread(header, 4, 3, f) == 3 && header[2] <= 1 && (layers.empty() || layers.back().outputs == header[0]);
+            if (!ok)
+                break;
+            kernel.resize(static_cast<size_t>(header[0]) * header[1]);
+            bias.resize(header[1]);
+            ok = std::fread(kernel.data(), sizeof(float), kernel.size(), f) == kernel.size() &&
+                 std::fread(bias.data(), sizeof(float), bias.size(), f) == bias.size();
+            if (ok)
+                add_layer(header[0], header[1], static_cast<Activation>(header[2]), kernel.data(), bias.data());
+        }
+        std::fclose(f);
+        if (!ok || layers.empty()) {
+            layers.swap(previous);
+            allocate();
+            throw std::runtime_error("Invalid weights file " + path);
+        }
+    }
+
+    void save(const std::string& path) const {
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (f == nullptr)
+            throw std::runtime_error("Cannot write weights file " + path);
+        uint32_t count = static_cast<uint32_t>(layers.size());
+        std::fwrite("MLP1", 1, 4, f);
+        std::fwrite(&count, 4, 1, f);
+        for (const DenseLayer& l : layers) {
+            uint32_t header[3] = {static_cast<uint32_t>(l.inputs), static_cast<uint32_t>(l.outputs), static_cast<uint32_t>(l.activation)};
+            std::fwrite(header, 4, 3, f);
+            for (size_t i = 0; i < l.inputs; i++)
+                std::fwrite(&l.weights[i * l.n], sizeof(float), l.outputs, f);
+            std::fwrite(l.bias.data(), sizeof(float), l.outputs, f);
+        }
+        std::fclose(f);
+    }
+
+    // int8 weights for every layer but the last one (the Q-values keep full precision)
+    void quantize() {
+        for (size_t n = 0; n + 1 < layers.size(); n++) {
+            DenseLayer& l = layers[n];
+            l.weights_q.resize(l.outputs * l.k);
+            l.weight_scale.resize(l.outputs);
+            std::vector<float> row(l.k, 0.0f);
+            for (size_t o = 0; o < l.outputs; o++) {
+                for (size_t i = 0; i < l.inputs; i++)
+                    row[i] = l.weights[i * l.n + o];
+                l.weight_scale[o] = quantize_row(row.data(), l.k, l.weights_q.data() + o * l.k);
+            }
+            l.quantized = true;
+        }
+    }
+
+    // rows states, row r at x + r * x_stride (x_stride >= input_stride(), padding zero;
+    // a features::FeatureMatrix qualifies). Writes rows x outputs() values to out.
+    void forward(const float* x, size_t x_stride, size_t rows, float* out) {
+        size_t outputs = last().outputs;
+        for (size_t r0 = 0; r0 < rows; r0 += max_batch) {
+            size_t n = std::min(max_batch, rows - r0);
+            const float* in = x + r0 * x_stride;
+            size_t in_stride = x_stride;
+            for (size_t l = 0; l < layers.size(); l++) {
+                float* y = act[l & 1].data();
+                run_layer(layers[l], in, in_stride, n, y, max_width);
+                in = y;
+                in_stride = max_width;
+            }
+            for (size_t r = 0; r < n; r++)
+                std::memcpy(out + (r0 + r) * outputs, in + r * in_stride, outputs * sizeof(float));
+        }
+    }
+
+    // Single state, e.g. one routing decision: index of the highest output (the greedy action).
+    // x holds input_stride() floats, the padding zero.
+    int best_action(const float* x) {
+        forward(x, input_stride(), 1, single.data());
+        const float* q = single.data();
+        return static_cast<int>(std::max_element(q, q + last().outputs) - q);
+    }
+
+    size_t inputs() const { return first().inputs; }
+    size_t outputs() const { return last().outputs; }
+    size_t input_stride() const { return padded(first().inputs); }
+    size_t num_layers() const { return layers.size(); }
+};
+
+} // namespace mlp
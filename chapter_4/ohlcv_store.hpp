@@ -0,0 +1,387 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+namespace ohlcv
+{
+
+enum Field : int { OPEN, HIGH, LOW, CLOSE, VOLUME, ADJ_CLOSE, NUM_FIELDS };
+
+// One bar, copied out of the columns
+struct Bar {
+    double open, high, low, close, volume, adjusted_close;
+};
+
+// Zero-copy view of n consecutive days of one ticker: field[f][i], i < size, oldest first.
+// Valid as long as the store is.
+struct Window {
+    const double* field[NUM_FIELDS];
+    size_t size;
+
+    double operator()(Field f, size_t i) const { return field[f][i]; }
+};
+
+// On-disk layout (little endian), every section 64-byte aligned so the columns can be used in place:
+//   FileHeader | int32 dates[days] | ticker names, '\0' separated | double values[tickers][fields][days]
+struct FileHeader {
+    char magic[8];          // "OHLCV01"
+    uint32_t tickers;
+    uint32_t days;
+    uint32_t fields;
+    uint32_t names_bytes;
+    uint64_t dates_offset;
+    uint64_t names_offset;
+    uint64_t values_offset;
+    uint64_t file_bytes;
+};
+
+inline uint64_t align64(uint64_t n) { return (n + 63) / 64 * 64; }
+
+// Columnar daily OHLCV history of a universe of tickers on a shared calendar.
+// Tickers have dense ids 0..tickers()-1 (look the id up once, not per access); each field of each
+// ticker is one contiguous array over the calendar, NaN on days the ticker has no bar. The store
+// either owns its columns (built in memory or from CSV) or reads them straight from an mmap'ed
+// file written by save(), in which case startup costs the ticker index only and the pages are
+// read on first touch.
+class OhlcvStore {
+private:
+    std::vector<std::string> names;
+    std::unordered_map<std::string, int32_t> ids;
+    size_t num_days = 0;
+    const int32_t* dates = nullptr;
+    const double* values = nullptr;
+    std::vector<int32_t> owned_dates;
+    std::vector<double> owned_values;
+    void* mapping = nullptr;
+    size_t mapping_bytes = 0;
+
+    void index_names() {
+        ids.clear();
+        ids.reserve(names.size());
+        for (size_t t = 0; t < names.size(); t++)
+            ids.emplace(names[t], static_cast<int32_t>(t));
+    }
+    void release() {
+        if (mapping != nullptr)
+            munmap(mapping, mapping_bytes);
+        mapping = nullptr;
+        mapping_bytes = 0;
+    }
+
+public:
+    OhlcvStore() = default;
+
+    // In memory, every value NaN until filled through mutable_column(). dates ascending (yyyymmdd).
+    OhlcvStore(std::vector<std::string> tickers, std::vector<int32_t> calendar)
+        : names(std::move(tickers)), num_days(calendar.size()), owned_dates(std::move(calendar)),
+          owned_values(names.size() * NUM_FIELDS * num_days, std::numeric_limits<double>::quiet_NaN()) {
+        dates = owned_dates.data();
+        values = owned_values.data();
+        index_names();
+    }
+
+    ~OhlcvStore() { release(); }
+    OhlcvStore(const OhlcvStore&) = delete;
+    OhlcvStore& operator=(const OhlcvStore&) = delete;
+    OhlcvStore(OhlcvStore&& other) noexcept { *this = std::move(other); }
+    OhlcvStore& operator=(OhlcvStore&& other) noexcept {
+        if (this == &other)
+            return *this;
+        release();
+        names = std::move(other.names);
+        ids = std::move(other.ids);
+        num_days = other.num_days;
+        bool owned = other.mapping == nullptr;
+        owned_dates = std::move(other.owned_dates);
+        owned_values = std::move(other.owned_values);
+        dates = owned ? owned_dates.data() : other.dates;
+        values = owned ? owned_values.data() : other.values;
+        mapping = other.mapping;
+        mapping_bytes = other.mapping_bytes;
+        other.mapping = nullptr;
+        other.mapping_bytes = 0;
+        other.dates = nullptr;
+        other.values = nullptr;
+        other.num_days = 0;
+        return *this;
+    }
+
+    // Maps a file written by save(), read only
+    static OhlcvStore open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Cannot open market data file " + path);
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Invalid market data file " + path);
+        }
+        size_t bytes = static_cast<size_t>(st.st_size);
+        void* map = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED)
+            throw std::runtime_error("Cannot map market data file " + path);
+
+        const char* base = static_cast<const char*>(map);
+        FileHeader h;
+        std::memcpy(&h, base, sizeof(h));
+        uint64_t values_bytes = static_cast<uint64_t>(h.tickers) * NUM_FIELDS * h.days * sizeof(double);
+        if (std::memcmp(h.magic, "OHLCV01", 8) != 0 || h.fields != NUM_FIELDS || h.file_bytes != bytes ||
+            h.dates_offset + h.days * sizeof(int32_t) > bytes || h.names_offset + h.names_bytes > bytes ||
+            h.values_offset % 64 != 0 || h.values_offset + values_bytes > bytes) {
+            munmap(map, bytes);
+            throw std::runtime_error("Invalid market data file " + path);
+        }
+
+        OhlcvStore store;
+        store.mapping = map;
+        store.mapping_bytes = bytes;
+        store.num_days = h.days;
+        store.dates = reinterpret_cast<const int32_t*>(base + h.dates_offset);
+        store.values = reinterpret_cast<const double*>(base + h.values_offset);
+        store.names.reserve(h.tickers);
+        const char* name = base + h.names_offset;
+        const char* names_end = name + h.names_bytes;
+        for (uint32_t t = 0; t < h.tickers; t++) {
+            size_t length = strnlen(name, names_end - name);
+            if (name + length >= names_end)
+                throw std::runtime_error("Invalid market data file " + path);   // store unmaps
+            store.names.emplace_back(name, length);
+            name += length + 1;
+        }
+        store.index_names();
+        return store;
+    }
+
+    void save(const std::string& path) const {
+        FileHeader h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, "OHLCV01", 8);
+        h.tickers = static_cast<uint32_t>(names.size());
+        h.days = static_cast<uint32_t>(num_days);
+        h.fields = NUM_FIELDS;
+        for (const std::string& n : names)
+            h.names_bytes += static_cast<uint32_t>(n.size() + 1);
+        h.dates_offset = align64(sizeof(FileHeader));
+        h.names_offset = align64(h.dates_offset + num_days * sizeof(int32_t));
+        h.values_offset = align64(h.names_offset + h.names_bytes);
+        h.file_bytes = h.values_offset + names.size() * NUM_FIELDS * num_days * sizeof(double);
+
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (f == nullptr)
+            throw std::runtime_error("Cannot write market data file " + path);
+        auto pad_to = [&](uint64_t offset) {
+            static const char zeros[64] = {};
+            long at = std::ftell(f);
+            std::fwrite(zeros, 1, offset - static_cast<uint64_t>(at), f);
+        };
+        std::fwrite(&h, sizeof(h), 1, f);
+        pad_to(h.dates_offset);
+        std::fwrite(dates, sizeof(int32_t), num_days, f);
+        pad_to(h.names_offset);
+        for (const std::string& n : names)
+            std::fwrite(n.c_str(), 1, n.size() + 1, f);
+        pad_to(h.values_offset);
+        std::fwrite(values, sizeof(double), names.size() * NUM_FIELDS * num_days, f);
+        bool ok = std::ferror(f) == 0;
+        ok = std::fclose(f) == 0 && ok;
+        if (!ok)
+            throw std::runtime_error("Cannot write market data file " + path);
+    }
+
+    // One CSV file per ticker (the file name without directory and extension is the ticker),
+    // header "Date,Open,High,Low,Close,Adj Close,Volume" in any column order, dates YYYY-MM-DD.
+    // Files are parsed in parallel; the calendar is the union of all dates.
+    static OhlcvStore from_csv(const std::vector<std::string>& paths);
+
+    int32_t id(const std::string& ticker) const {
+        auto it = ids.find(ticker);
+        return it == ids.end() ? -1 : it->second;
+    }
+    const std::string& name(int32_t ticker) const { return names[ticker]; }
+    size_t tickers() const { return names.size(); }
+    size_t days() const { return num_days; }
+    int32_t date(size_t day) const { return dates[day]; }
+    bool mapped() const { return mapping != nullptr; }
+
+    // First day on or after date (days() if none)
+    size_t day_index(int32_t date) const { return std::lower_bound(dates, dates + num_days, date) - dates; }
+
+    const double* column(int32_t ticker, Field field) const {
+        return values + (static_cast<size_t>(ticker) * NUM_FIELDS + field) * num_days;
+    }
+    // In-memory stores only
+    double* mutable_column(int32_t ticker, Field field) {
+        if (mapping != nullptr)
+            throw std::logic_error("Mapped market data is read only");
+        return owned_values.data() + (static_cast<size_t>(ticker) * NUM_FIELDS + field) * num_days;
+    }
+
+    Bar bar(int32_t ticker, size_t day) const {
+        return Bar{column(ticker, OPEN)[day], column(ticker, HIGH)[day], column(ticker, LOW)[day],
+                   column(ticker, CLOSE)[day], column(ticker, VOLUME)[day], column(ticker, ADJ_CLOSE)[day]};
+    }
+
+    // The n days ending at end_day (exclusive), fewer at the start of the calendar
+    Window window(int32_t ticker, size_t end_day, size_t n) const {
+        end_day = std::min(end_day, num_days);
+        size_t begin = end_day > n ? end_day - n : 0;
+        Window w;
+        for (int f = 0; f < NUM_FIELDS; f++)
+            w.field[f] = column(ticker, static_cast<Field>(f)) + begin;
+        w.size = end_day - begin;
+        return w;
+    }
+};
+
+namespace detail
+{
+
+struct CsvRow {
+    int32_t date;
+    double field[NUM_FIELDS];
+};
+
+inline int32_t parse_date(const char* p, const char* end) {
+    // YYYY-MM-DD
+    if (end - p < 10 || p[4] != '-' || p[7] != '-')
+        return -1;
+    int32_t v = 0;
+    for (int i : {0, 1, 2, 3, 5, 6, 8, 9}) {
+        if (p[i] < '0' || p[i] > '9')
+            return -1;
+        v = v * 10 + (p[i] - '0');
+    }
+    return v;
+}
+
+inline std::string ticker_of(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string file = slash == std::string::npos ? path : path.substr(slash + 1);
+    size_t dot = file.find_last_of('.');
+    return dot == std::string::npos ? file : file.substr(0, dot);
+}
+
+inline std::vector<CsvRow> read_csv(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (f == nullptr)
+        throw std::runtime_error("Cannot open " + path);
+    std::string text;
+    char buffer[1 << 16];
+    size_t got;
+    while ((got = std::fread(buffer, 1, sizeof(buffer), f)) > 0)
+        text.append(buffer, got);
+    std::fclose(f);
+
+    // header: which column holds which field
+    size_t line_end = text.find('\n');
+    std::string header = text.substr(0, line_end);
+    int column_of[NUM_FIELDS];
+    int date_column = -1;
+    std::fill(column_of, column_of + NUM_FIELDS, -1);
+    int column = 0;
+    size_t start = 0;
+    while (start <= header.size()) {
+        size_t comma = header.find(',', start);
+        std::string name = header.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        while (!name.empty() && (name.back() == '\r' || name.back() == ' '))
+            name.pop_back();
+        if (name == "Date") date_column = column;
+        else if (name == "Open") column_of[OPEN] = column;
+        else if (name == "High") column_of[HIGH] = column;
+        else if (name == "Low") column_of[LOW] = column;
+        else if (name == "Close") column_of[CLOSE] = column;
+        else if (name == "Volume") column_of[VOLUME] = column;
+        else if (name == "Adj Close") column_of[ADJ_CLOSE] = column;
+        column++;
+        if (comma == std::string::npos)
+            break;
+        start = comma + 1;
+    }
+    if (date_column < 0)
+        throw std::runtime_error("No Date column in " + path);
+
+    std::vector<CsvRow> rows;
+    size_t pos = line_end == std::string::npos ? text.size() : line_end + 1;
+    const char* data = text.c_str();
+    while (pos < text.size()) {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string::npos)
+            eol = text.size();
+        CsvRow row;
+        row.date = -1;
+        std::fill(row.field, row.field + NUM_FIELDS, std::numeric_limits<double>::quiet_NaN());
+        const char* p = data + pos;
+        const char* line_end_ptr = data + eol;
+        for (int c = 0; p <= line_end_ptr; c++) {
+            const char* comma = static_cast<const char*>(std::memchr(p, ',', line_end_ptr - p));
+            const char* cell_end = comma != nullptr ? comma : line_end_ptr;
+            if (c == date_column) {
+                row.date = parse_date(p, cell_end);
+            }
+            else {
+                for (int f = 0; f < NUM_FIELDS; f++)
+                    if (column_of[f] == c && p < cell_end)
+                        row.field[f] = std::strtod(p, nullptr);
+            }
+            if (comma == nullptr)
+                break;
+            p = comma + 1;
+        }
+        if (row.date >= 0)
+            rows.push_back(row);
+        pos = eol + 1;
+    }
+    std::sort(rows.begin(), rows.end(), [](const CsvRow& a, const CsvRow& b) { return a.date < b.date; });
+    return rows;
+}
+
+} // namespace detail
+
+inline OhlcvStore OhlcvStore::from_csv(const std::vector<std::string>& paths) {
+    std::vector<std::vector<detail::CsvRow>> parsed(paths.size());
+    tbb::parallel_for(size_t(0), paths.size(), [&](size_t i) { parsed[i] = detail::read_csv(paths[i]); });
+
+    std::vector<int32_t> calendar;
+    for (const auto& rows : parsed)
+        for (const detail::CsvRow& row : rows)
+            calendar.push_back(row.date);
+    std::sort(calendar.begin(), calendar.end());
+    calendar.erase(std::unique(calendar.begin(), calendar.end()), calendar.end());
+
+    std::vector<std::string> tickers;
+    tickers.reserve(paths.size());
+    for (const std::string& p : paths)
+        tickers.push_back(detail::ticker_of(p));
+    OhlcvStore store(std::move(tickers), std::move(calendar));
+    tbb::parallel_for(size_t(0), paths.size(), [&](size_t t) {
+        double* columns[NUM_FIELDS];
+        for (int f = 0; f < NUM_FIELDS; f++)
+            columns[f] = store.mutable_column(static_cast<int32_t>(t), static_cast<Field>(f));
+        size_t day = 0;
+        for (const detail::CsvRow& row : parsed[t]) {
+            while (store.dates[day] < row.date)
+                day++;
+            for (int f = 0; f < NUM_FIELDS; f++)
+                columns[f][day] = row.field[f];
+        }
+    });
+    return store;
+}
+
+} // namespace ohlcv
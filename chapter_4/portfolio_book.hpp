@@ -0,0 +1,150 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace portfolio_book
+{
+
+const uint32_t RESYNC_INTERVAL = 4096;   // revalues between exact recomputations of the holdings value
+
+// Everything a trade or a price touches for one asset, in one half cache line
+struct alignas(32) AssetPosition {
+    double quantity;
+    double mark;       // last price seen
+    double value;      // quantity * mark, as of the last revalue()
+    int32_t held;      // index in the held list, -1 if flat
+    uint8_t dirty;
+};
+
+// Cash and positions of a portfolio over dense asset ids [0, assets), e.g. ticker ids of an
+// ohlcv::OhlcvStore. As position_engine::PositionEngine, the total is never summed over the
+// universe:
+// - buy / sell / mark: O(1), the asset goes into a dirty set
+// - revalue: recomputes the value of the dirty assets and moves the holdings total by the
+//   difference (and sums the held assets exactly every RESYNC_INTERVAL calls, so the running
+//   total doesn't drift)
+// - held(): the assets with a position, so a new day's prices are applied in O(held)
+// Quantities and cash are doubles (fractional shares, as RMS.cpp's Portfolio).
+class PortfolioBook {
+private:
+    std::vector<AssetPosition> assets;
+    std::vector<int32_t> held_assets;
+    std::vector<int32_t> dirty;
+    double cash;
+    double holdings = 0;
+    uint32_t revalues = 0;
+
+    void touch(int32_t asset) {
+        AssetPosition& p = assets[asset];
+        if (!p.dirty) {
+            p.dirty = 1;
+            dirty.push_back(asset);
+        }
+    }
+    // keeps the held list in step with the quantity
+    void set_quantity(int32_t asset, double quantity) {
+        AssetPosition& p = assets[asset];
+        p.quantity = quantity;
+        if (quantity != 0 && p.held < 0) {
+            p.held = static_cast<int32_t>(held_assets.size());
+            held_assets.push_back(asset);
+        }
+        else if (quantity == 0 && p.held >= 0) {
+            int32_t moved = held_assets.back();
+            held_assets[p.held] = moved;
+            assets[moved].held = p.held;
+            held_assets.pop_back();
+            p.held = -1;
+        }
+        touch(asset);
+    }
+
+public:
+    PortfolioBook(size_t num_assets, double initial_cash)
+        : assets(num_assets, AssetPosition{0, 0, 0, -1, 0}), cash(initial_cash) {}
+
+    // Ids past the end grow the book (amortised, not on the per-step path once the universe is known)
+    void ensure(int32_t asset) {
+        if (static_cast<size_t>(asset) >= assets.size())
+            assets.resize(static_cast<size_t>(asset) + 1, AssetPosition{0, 0, 0, -1, 0});
+    }
+
+    // false (and nothing changes) without enough cash
+    bool buy(int32_t asset, double quantity, double price) {
+        double cost = quantity * price;
+        if (cash < cost)
+            return false;
+        ensure(asset);
+        cash -= cost;
+        assets[asset].mark = price;
+        set_quantity(asset, assets[asset].quantity + quantity);
+        return true;
+    }
+    // false (and nothing changes) without enough of the asset
+    bool sell(int32_t asset, double quantity, double price) {
+        if (quantity_of(asset) < quantity)
+            return false;
+        ensure(asset);
+        cash += quantity * price;
+        assets[asset].mark = price;
+        set_quantity(asset, assets[asset].quantity - quantity);
+        return true;
+    }
+    // Transfers without cash (deposits of securities, corrections); false if it would go negative
+    bool add(int32_t asset, double quantity) {
+        ensure(asset);
+        if (assets[asset].quantity + quantity < 0)
+            return false;
+        set_quantity(asset, assets[asset].quantity + quantity);
+        return true;
+    }
+    void adjust_cash(double amount) { cash += amount; }
+
+    // New price: only a held asset whose price changed needs revaluing
+    void mark(int32_t asset, double price) {
+        ensure(asset);
+        AssetPosition& p = assets[asset];
+        if (price != p.mark) {
+            p.mark = price;
+            if (p.quantity != 0)
+                touch(asset);
+        }
+    }
+
+    // Recomputes the value of the dirty assets, returns how many
+    size_t revalue() {
+        size_t n = dirty.size();
+        for (int32_t asset : dirty) {
+            AssetPosition& p = assets[asset];
+            double value = p.quantity * p.mark;
+            holdings += value - p.value;
+            p.value = value;
+            p.dirty = 0;
+        }
+        dirty.clear();
+        if (++revalues >= RESYNC_INTERVAL) {
+            revalues = 0;
+            holdings = 0;
+            for (int32_t asset : held_assets)
+                holdings += assets[asset].value;
+        }
+        return n;
+    }
+
+    // Cash + holdings at the last marks
+    double total_value() {
+        revalue();
+        return cash + holdings;
+    }
+
+    double cash_balance() const { return cash; }
+    double quantity_of(int32_t asset) const {
+        return static_cast<size_t>(asset) < assets.size() ? assets[asset].quantity : 0.0;
+    }
+    double mark_of(int32_t asset) const { return static_cast<size_t>(asset) < assets.size() ? assets[asset].mark : 0.0; }
+    const std::vector<int32_t>& held() const { return held_assets; }
+    size_t universe() const { return assets.size(); }
+};
+
+} // namespace portfolio_book
@@ -0,0 +1,228 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+namespace replay
+{
+
+// Priorities are stored in fixed point (1.0 = 2^20) so the sum-tree is plain integer adds:
+// exact, order independent, no drift, and updatable from several threads with fetch_add.
+const double PRIORITY_UNIT = 1048576.0;
+const double MAX_PRIORITY = 1e6;
+const double PRIORITY_EPSILON = 1e-3;   // |td error| + epsilon, so no experience becomes unreachable
+const size_t ROW_PAD = 16;              // floats, rows padded like features::FeatureMatrix
+const int SAMPLE_ATTEMPTS = 16;         // per row, before giving up on a stratum
+
+inline uint64_t to_fixed(double priority) {
+    priority = std::min(std::max(priority, 0.0), MAX_PRIORITY);
+    return std::max<uint64_t>(1, static_cast<uint64_t>(priority * PRIORITY_UNIT));
+}
+
+// A sampled mini-batch, row-major and ready to hand to the network (rows x stride, padding zero).
+// slots / versions identify what was sampled, for update_priorities().
+struct SampleBatch {
+    std::vector<float> states;
+    std::vector<float> next_states;
+    std::vector<int32_t> actions;
+    std::vector<float> rewards;
+    std::vector<uint8_t> dones;
+    std::vector<float> weights;      // importance sampling weights, the largest is 1
+    std::vector<uint64_t> slots;
+    std::vector<uint64_t> versions;
+    size_t rows = 0;
+    size_t stride = 0;
+};
+
+// Prioritised experience replay over fixed-size feature vectors.
+// - storage: one preallocated ring per field (state rows, next state rows, action, reward, done),
+//   nothing is allocated or freed after construction, the oldest experience is overwritten
+// - priorities: a sum-tree of (|td| + epsilon)^alpha over the slots; sampling is stratified
+//   (one draw per 1/batch of the total) and descends the tree in log2(capacity) steps
+// - threads: any number of actors call add(), learners call sample() / update_priorities(),
+//   no locks. add() takes a sequence number with fetch_add and publishes the slot through a
+//   per-slot version (odd while being written, as in venue_metrics::Seqlock); sample() copies a
+//   row between two loads of the version and draws again if it raced a write. Tree nodes are
+//   updated by adding the leaf's change, so concurrent updates compose.
+//   The version is claimed with a CAS, so two actors a full lap apart (one preempted mid-write)
+//   never write the same slot together, and only by a ticket newer than the slot's: a newer
+//   ticket waits for an older writer, an older ticket that finds a newer one already there drops
+//   its experience (it would have been overwritten anyway). Both only happen when the ring wraps
+//   during a single add().
+class ReplayBuffer {
+private:
+    size_t slots;            // capacity
+    size_t leaves;           // power of two >= slots, leaf i is tree node leaves + i
+    size_t dim;
+    size_t row_stride;
+    double alpha;
+    std::vector<float> states;
+    std::vector<float> next_states;
+    std::vector<int32_t> actions;
+    std::vector<float> rewards;
+    std::vector<uint8_t> dones;
+    std::unique_ptr<std::atomic<uint64_t>[]> version;
+    std::unique_ptr<std::atomic<uint64_t>[]> tree;
+    alignas(64) std::atomic<uint64_t> next{0};
+    alignas(64) std::atomic<uint64_t> max_priority;
+    std::atomic<uint64_t> dropped{0};        // adds that lost their slot to a newer ticket
+
+    void set_leaf(size_t slot, uint64_t priority) {
+        size_t node = leaves + slot;
+        uint64_t old = tree[node].exchange(priority, std::memory_order_acq_rel);
+        uint64_t delta = priority - old;    // modulo 2^64, adding it is the same as subtracting old
+        if (delta == 0)
+            return;
+        for (node >>= 1; node >= 1; node >>= 1)
+            tree[node].fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    // Leaf whose prefix sum interval holds u
+    size_t find(uint64_t u) const {
+        size_t node = 1;
+        while (node < leaves) {
+            uint64_t left = tree[2 * node].load(std::memory_order_relaxed);
+            if (u < left) {
+                node = 2 * node;
+            }
+            else {
+                u -= left;
+                node = 2 * node + 1;
+            }
+        }
+        return node - leaves;
+    }
+
+public:
+    ReplayBuffer(size_t capacity, size_t state_dim, double alpha = 0.6)
+        : slots(capacity), leaves(1), dim(state_dim), row_stride((state_dim + ROW_PAD - 1) / ROW_PAD * ROW_PAD), alpha(alpha),
+          states(capacity * row_stride, 0.0f), next_states(capacity * row_stride, 0.0f), actions(capacity, 0),
+          rewards(capacity, 0.0f), dones(capacity, 0), version(new std::atomic<uint64_t>[capacity]),
+          max_priority(to_fixed(1.0)) {
+        while (leaves < capacity)
+            leaves <<= 1;
+        tree.reset(new std::atomic<uint64_t>[2 * leaves]);
+        for (size_t i = 0; i < 2 * leaves; i++)
+            tree[i].store(0, std::memory_order_relaxed);
+        for (size_t i = 0; i < capacity; i++)
+            version[i].store(0, std::memory_order_relaxed);
+    }
+
+    // Any thread. New experiences get the highest priority seen so far, so each is replayed
+    // at least about once. Returns the experience's sequence number.
+    uint64_t add(const float* state, int32_t action, float reward, const float* next_state, bool done) {
+        uint64_t ticket = next.fetch_add(1, std::memory_order_relaxed);
+        size_t slot = ticket % slots;
+        uint64_t current = version[slot].load(std::memory_order_relaxed);
+        while (true) {
+            // versions of older tickets are at most 2 * ticket; anything above is a lap ahead
+            if (current > 2 * ticket) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return ticket;
+            }
+            if (current & 1) {
+                std::this_thread::yield();
+                current = version[slot].load(std::memory_order_relaxed);
+                continue;
+            }
+            if (version[slot].compare_exchange_weak(current, 2 * ticket + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                break;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&states[slot * row_stride], state, dim * sizeof(float));
+        std::memcpy(&next_states[slot * row_stride], next_state, dim * sizeof(float));
+        actions[slot] = action;
+        rewards[slot] = reward;
+        dones[slot] = done ? 1 : 0;
+        set_leaf(slot, max_priority.load(std::memory_order_relaxed));
+        version[slot].store(2 * ticket + 2, std::memory_order_release);
+        return ticket;
+    }
+
+    // Any thread, each with its own generator. Draws batch_size experiences with probability
+    // priority / total and importance weights (size * P)^-beta / max. Returns the number of
+    // rows written (fewer than batch_size only if the buffer is empty or churning very fast).
+    size_t sample(size_t batch_size, double beta, std::mt19937_64& rng, SampleBatch& out) const {
+        out.stride = row_stride;
+        out.states.resize(batch_size * row_stride);
+        out.next_states.resize(batch_size * row_stride);
+        out.actions.resize(batch_size);
+        out.rewards.resize(batch_size);
+        out.dones.resize(batch_size);
+        out.weights.resize(batch_size);
+        out.slots.resize(batch_size);
+        out.versions.resize(batch_size);
+        out.rows = 0;
+        size_t filled = size();
+        uint64_t total = tree[1].load(std::memory_order_acquire);
+        if (filled == 0 || total == 0 || batch_size == 0)
+            return 0;
+
+        uint64_t segment = std::max<uint64_t>(1, total / batch_size);
+        double max_weight = 0;
+        size_t k = 0;
+        for (size_t i = 0; i < batch_size; i++) {
+            uint64_t low = std::min(i * segment, total - 1);
+            uint64_t width = std::min(segment, total - low);
+            for (int attempt = 0; attempt < SAMPLE_ATTEMPTS; attempt++) {
+                size_t slot = find(low + rng() % width);
+                if (slot >= filled)
+                    continue;
+                uint64_t before = version[slot].load(std::memory_order_acquire);
+                uint64_t priority = tree[leaves + slot].load(std::memory_order_relaxed);
+                if (before == 0 || (before & 1) || priority == 0)
+                    continue;
+                std::memcpy(&out.states[k * row_stride], &states[slot * row_stride], row_stride * sizeof(float));
+                std::memcpy(&out.next_states[k * row_stride], &next_states[slot * row_stride], row_stride * sizeof(float));
+                out.actions[k] = actions[slot];
+                out.rewards[k] = rewards[slot];
+                out.dones[k] = dones[slot];
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (version[slot].load(std::memory_order_relaxed) != before)
+                    continue;
+                double probability = static_cast<double>(priority) / static_cast<double>(total);
+                out.weights[k] = static_cast<float>(std::pow(filled * probability, -beta));
+                max_weight = std::max(max_weight, static_cast<double>(out.weights[k]));
+                out.slots[k] = slot;
+                out.versions[k] = before;
+                k++;
+                break;
+            }
+        }
+        for (size_t i = 0; i < k; i++)
+            out.weights[i] = static_cast<float>(out.weights[i] / max_weight);
+        out.rows = k;
+        return k;
+    }
+
+    // Learner, after the training step: new priorities from the absolute TD errors of a sampled
+    // batch. Experiences overwritten since they were sampled are left alone.
+    void update_priorities(const SampleBatch& batch, const float* td_errors) {
+        for (size_t k = 0; k < batch.rows; k++) {
+            size_t slot = batch.slots[k];
+            if (version[slot].load(std::memory_order_acquire) != batch.versions[k])
+                continue;
+            uint64_t priority = to_fixed(std::pow(std::fabs(td_errors[k]) + PRIORITY_EPSILON, alpha));
+            set_leaf(slot, priority);
+            uint64_t current = max_priority.load(std::memory_order_relaxed);
+            while (priority > current && !max_priority.compare_exchange_weak(current, priority, std::memory_order_relaxed)) {
+            }
+        }
+    }
+
+    size_t size() const { return static_cast<size_t>(std::min<uint64_t>(next.load(std::memory_order_acquire), slots)); }
+    size_t capacity() const { return slots; }
+    uint64_t dropped_adds() const { return dropped.load(std::memory_order_relaxed); }
+    size_t stride() const { return row_stride; }
+    uint64_t total_priority() const { return tree[1].load(std::memory_order_acquire); }
+    uint64_t leaf_priority(size_t slot) const { return tree[leaves + slot].load(std::memory_order_acquire); }
+};
+
+} // namespace replay
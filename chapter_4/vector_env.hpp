@@ -0,0 +1,294 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+#include <immintrin.h>
+#endif
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "feature_builder.hpp"
+#include "mlp_inference.hpp"
+#include "replay_buffer.hpp"
+
+namespace rollout
+{
+
+const size_t ENV_BLOCK = 256;   // environments per parallel task
+const int NUM_ACTIONS = 3;      // buy, sell, hold
+
+// Counter-based random numbers: draw n of environment e depends only on (seed, e, n), so a run gives
+// the same trajectories whatever the number of threads and however the environments are split.
+inline uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+inline uint64_t stream(uint64_t seed, uint64_t env, uint64_t n, uint64_t salt) {
+    return mix(seed ^ mix(env * 0x9e3779b97f4a7c15ull + salt) ^ (n * 0xd1b54a32d192ed03ull));
+}
+inline double uniform(uint64_t bits) { return static_cast<double>(static_cast<int64_t>(bits >> 11)) * (1.0 / 9007199254740992.0); }
+
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+// maskz forms here and below: GCC 12 warns about the undefined source operand of the plain intrinsics
+inline __m512i shift_right(__m512i x, unsigned int bits) { return _mm512_maskz_srli_epi64(0xFF, x, bits); }
+inline __m512i mix(__m512i x) {
+    x = _mm512_xor_si512(x, shift_right(x, 30));
+    x = _mm512_mullo_epi64(x, _mm512_set1_epi64(static_cast<long long>(0xbf58476d1ce4e5b9ull)));
+    x = _mm512_xor_si512(x, shift_right(x, 27));
+    x = _mm512_mullo_epi64(x, _mm512_set1_epi64(static_cast<long long>(0x94d049bb133111ebull)));
+    return _mm512_xor_si512(x, shift_right(x, 31));
+}
+#endif
+
+struct EnvConfig {
+    double initial_cash = 10000.0;
+    double initial_price = 100.0;
+    double spread = 0.02;
+    double max_price_change = 0.5;   // uniform in [-max, max) per step, as Environment::simulateMarketReaction
+    uint32_t episode_length = 1000;
+    uint64_t seed = 1;
+};
+
+// N copies of the SOR trading environment (Environment::step: buy one / sell one / hold, rewarded
+// with the price change, -1 for an impossible trade) stepped in lockstep. The state is one array
+// per field, so a step is a loop of selects over contiguous arrays: 8 environments per AVX-512
+// iteration (the scalar loop is the reference and the fallback, GCC does not vectorise it under
+// the default -ftrapping-math), blocks of ENV_BLOCK environments in parallel on the TBB pool.
+// A finished episode resets in place and reports done for that step.
+class VectorEnv {
+private:
+    EnvConfig config;
+    size_t n;
+    std::vector<double> cash;
+    std::vector<double> assets;
+    std::vector<double> price;
+    std::vector<double> episode_return;
+    std::vector<double> last_return;   // of the last finished episode
+    std::vector<uint64_t> draws;       // random number counter
+    std::vector<uint32_t> episode_step;
+    std::vector<uint32_t> episodes;
+
+    void step_scalar(size_t begin, size_t end, const int32_t* actions, float* rewards, uint8_t* dones) {
+        const double reset_cash = config.initial_cash;
+        const double reset_price = config.initial_price;
+        const uint32_t length = config.episode_length;
+        for (size_t i = begin; i < end; i++) {
+            double change = (2.0 * uniform(stream(config.seed, i, draws[i], 0)) - 1.0) * config.max_price_change;
+            double new_price = price[i] + change;
+            int32_t action = actions[i];
+            bool buy = action == 0 && cash[i] >= new_price;
+            bool sell = action == 1 && assets[i] > 0;
+            double reward = buy || sell ? change : (action == 2 ? change * assets[i] : -1.0);
+            double new_cash = cash[i] + (sell ? new_price : 0.0) - (buy ? new_price : 0.0);
+            double new_assets = assets[i] + (buy ? 1.0 : 0.0) - (sell ? 1.0 : 0.0);
+            double total = episode_return[i] + reward;
+            uint32_t next_step = episode_step[i] + 1;
+            bool done = next_step >= length;
+
+            cash[i] = done ? reset_cash : new_cash;
+            assets[i] = done ? 0.0 : new_assets;
+            price[i] = done ? reset_price : new_price;
+            last_return[i] = done ? total : last_return[i];
+            episode_return[i] = done ? 0.0 : total;
+            episode_step[i] = done ? 0 : next_step;
+            episodes[i] += done ? 1 : 0;
+            draws[i]++;
+            rewards[i] = static_cast<float>(reward);
+            dones[i] = done ? 1 : 0;
+        }
+    }
+
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+    // Same operations in the same order as step_scalar, so the results are bit-identical
+    void step_simd(size_t begin, size_t end, const int32_t* actions, float* rewards, uint8_t* dones) {
+        const __m512d zero = _mm512_setzero_pd();
+        const __m512d one = _mm512_set1_pd(1.0);
+        const __m512i lanes = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+        const __m512i seed = _mm512_set1_epi64(static_cast<long long>(config.seed));
+        const __m512i env_key = _mm512_set1_epi64(static_cast<long long>(0x9e3779b97f4a7c15ull));
+        const __m512i draw_key = _mm512_set1_epi64(static_cast<long long>(0xd1b54a32d192ed03ull));
+        const __m512i length = _mm512_set1_epi64(config.episode_length);
+        const __m512d scale = _mm512_set1_pd(1.0 / 9007199254740992.0);
+        const __m512d max_change = _mm512_set1_pd(config.max_price_change);
+        size_t i = begin;
+        for (; i + 8 <= end; i += 8) {
+            __m512i env = _mm512_add_epi64(_mm512_set1_epi64(static_cast<long long>(i)), lanes);
+            __m512i draw = _mm512_loadu_si512(&draws[i]);
+            __m512i bits = mix(_mm512_xor_si512(_mm512_xor_si512(seed, mix(_mm512_mullo_epi64(env, env_key))),
+                                                _mm512_mullo_epi64(draw, draw_key)));
+            __m512d u = _mm512_mul_pd(_mm512_cvtepi64_pd(shift_right(bits, 11)), scale);
+            __m512d change = _mm512_mul_pd(_mm512_sub_pd(_mm512_add_pd(u, u), one), max_change);
+            __m512d cash_i = _mm512_loadu_pd(&cash[i]);
+            __m512d assets_i = _mm512_loadu_pd(&assets[i]);
+            __m512d new_price = _mm512_add_pd(_mm512_loadu_pd(&price[i]), change);
+
+            __m512i action = _mm512_maskz_cvtepi32_epi64(0xFF, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&actions[i])));
+            __mmask8 buy = _mm512_cmpeq_epi64_mask(action, _mm512_set1_epi64(0)) & _mm512_cmp_pd_mask(cash_i, new_price, _CMP_GE_OQ);
+            __mmask8 sell = _mm512_cmpeq_epi64_mask(action, _mm512_set1_epi64(1)) & _mm512_cmp_pd_mask(assets_i, zero, _CMP_GT_OQ);
+            __mmask8 hold = _mm512_cmpeq_epi64_mask(action, _mm512_set1_epi64(2));
+            __m512d other = _mm512_mask_blend_pd(hold, _mm512_set1_pd(-1.0), _mm512_mul_pd(change, assets_i));
+            __m512d reward = _mm512_mask_blend_pd(buy | sell, other, change);
+            __m512d new_cash = _mm512_sub_pd(_mm512_add_pd(cash_i, _mm512_maskz_mov_pd(sell, new_price)), _mm512_maskz_mov_pd(buy, new_price));
+            __m512d new_assets = _mm512_sub_pd(_mm512_add_pd(assets_i, _mm512_maskz_mov_pd(buy, one)), _mm512_maskz_mov_pd(sell, one));
+            __m512d total = _mm512_add_pd(_mm512_loadu_pd(&episode_return[i]), reward);
+            __m512i next_step = _mm512_add_epi64(_mm512_maskz_cvtepu32_epi64(0xFF, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&episode_step[i]))),
+                                                 _mm512_set1_epi64(1));
+            __mmask8 done = _mm512_cmp_epu64_mask(next_step, length, _MM_CMPINT_NLT);
+
+            _mm512_storeu_pd(&cash[i], _mm512_mask_blend_pd(done, new_cash, _mm512_set1_pd(config.initial_cash)));
+            _mm512_storeu_pd(&assets[i], _mm512_mask_blend_pd(done, new_assets, zero));
+            _mm512_storeu_pd(&price[i], _mm512_mask_blend_pd(done, new_price, _mm512_set1_pd(config.initial_price)));
+            _mm512_mask_storeu_pd(&last_return[i], done, total);
+            _mm512_storeu_pd(&episode_return[i], _mm512_mask_blend_pd(done, total, zero));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&episode_step[i]), _mm512_maskz_cvtepi64_epi32(0xFF, _mm512_maskz_mov_epi64(~done, next_step)));
+            __m512i finished = _mm512_maskz_cvtepu32_epi64(0xFF, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&episodes[i])));
+            finished = _mm512_mask_add_epi64(finished, done, finished, _mm512_set1_epi64(1));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&episodes[i]), _mm512_maskz_cvtepi64_epi32(0xFF, finished));
+            _mm512_storeu_si512(&draws[i], _mm512_add_epi64(draw, _mm512_set1_epi64(1)));
+            _mm256_storeu_ps(&rewards[i], _mm512_maskz_cvtpd_ps(0xFF, reward));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(&dones[i]), _mm512_maskz_cvtepi64_epi8(0xFF, _mm512_maskz_set1_epi64(done, 1)));
+        }
+        step_scalar(i, end, actions, rewards, dones);
+    }
+#endif
+
+    void step_block(size_t begin, size_t end, const int32_t* actions, float* rewards, uint8_t* dones, bool vectorised) {
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+        if (vectorised) {
+            step_simd(begin, end, actions, rewards, dones);
+            return;
+        }
+#else
+        (void)vectorised;   // scalar only without AVX-512
+#endif
+        step_scalar(begin, end, actions, rewards, dones);
+    }
+
+public:
+    VectorEnv(size_t num_envs, const EnvConfig& config = EnvConfig())
+        : config(config), n(num_envs), cash(num_envs), assets(num_envs), price(num_envs), episode_return(num_envs),
+          last_return(num_envs), draws(num_envs), episode_step(num_envs), episodes(num_envs) {
+        reset();
+    }
+
+    void reset() {
+        std::fill(cash.begin(), cash.end(), config.initial_cash);
+        std::fill(assets.begin(), assets.end(), 0.0);
+        std::fill(price.begin(), price.end(), config.initial_price);
+        std::fill(episode_return.begin(), episode_return.end(), 0.0);
+        std::fill(last_return.begin(), last_return.end(), 0.0);
+        std::fill(draws.begin(), draws.end(), 0);
+        std::fill(episode_step.begin(), episode_step.end(), 0);
+        std::fill(episodes.begin(), episodes.end(), 0);
+    }
+
+    // One action per environment in, one reward and done flag per environment out
+    void step(const int32_t* actions, float* rewards, uint8_t* dones, bool vectorised = true, bool parallel = true) {
+        if (parallel)
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, n, ENV_BLOCK), [&](const tbb::blocked_range<size_t>& block) {
+                step_block(block.begin(), block.end(), actions, rewards, dones, vectorised);
+            });
+        else
+            step_block(0, n, actions, rewards, dones, vectorised);
+    }
+
+    // State rows in the agent's feature layout (features::Feature), one per environment.
+    // The simulated market has no VWAP or venue statistics: those columns are zero.
+    void write_states(features::FeatureMatrix& out) const {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, n, ENV_BLOCK), [&](const tbb::blocked_range<size_t>& block) {
+            for (size_t i = block.begin(); i < block.end(); i++) {
+                float* row = out.row(i);
+                row[features::CASH] = static_cast<float>(cash[i]);
+                row[features::ASSET_COUNT] = static_cast<float>(assets[i]);
+                row[features::PRICE] = static_cast<float>(price[i]);
+                row[features::SPREAD] = static_cast<float>(config.spread);
+            }
+        });
+        out.set_rows(n);
+    }
+
+    size_t size() const { return n; }
+    double cash_of(size_t i) const { return cash[i]; }
+    double assets_of(size_t i) const { return assets[i]; }
+    double price_of(size_t i) const { return price[i]; }
+    double last_return_of(size_t i) const { return last_return[i]; }
+    uint32_t episodes_of(size_t i) const { return episodes[i]; }
+};
+
+// Collects experience from a VectorEnv: per step, the states of all environments go through the
+// policy in one batched inference call, actions are epsilon-greedy (exploration draws from each
+// environment's own stream), every environment steps, and the transitions go to the replay
+// buffer from the worker threads. Without a policy (nothing trained yet) actions are uniform.
+class RolloutRunner {
+private:
+    VectorEnv& envs;
+    mlp::Network* policy;
+    replay::ReplayBuffer* memory;
+    uint64_t seed;
+    uint64_t step_count = 0;
+    features::FeatureMatrix states_a, states_b;
+    features::FeatureMatrix* states;
+    features::FeatureMatrix* next_states;
+    std::vector<float> q;
+    std::vector<int32_t> actions;
+    std::vector<float> rewards;
+    std::vector<uint8_t> dones;
+
+    void select_actions(double epsilon) {
+        size_t n = envs.size();
+        if (policy != nullptr)
+            policy->forward(states->data(), states->stride(), n, q.data());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, n, ENV_BLOCK), [&](const tbb::blocked_range<size_t>& block) {
+            for (size_t i = block.begin(); i < block.end(); i++) {
+                uint64_t bits = stream(seed, i, step_count, 1);
+                if (policy == nullptr || uniform(bits) < epsilon) {
+                    actions[i] = static_cast<int32_t>(mix(bits) % NUM_ACTIONS);
+                    continue;
+                }
+                const float* qi = q.data() + i * NUM_ACTIONS;
+                actions[i] = static_cast<int32_t>(std::max_element(qi, qi + NUM_ACTIONS) - qi);
+            }
+        });
+    }
+
+public:
+    // policy: NUM_ACTIONS outputs, batch of any size; memory may be null
+    RolloutRunner(VectorEnv& envs, mlp::Network* policy, replay::ReplayBuffer* memory, uint64_t seed = 7)
+        : envs(envs), policy(policy), memory(memory), seed(seed), states_a(envs.size()), states_b(envs.size()),
+          states(&states_a), next_states(&states_b), q(envs.size() * NUM_ACTIONS), actions(envs.size()),
+          rewards(envs.size()), dones(envs.size()) {
+        envs.write_states(*states);
+    }
+
+    // steps x size() transitions
+    void run(size_t steps, double epsilon) {
+        size_t n = envs.size();
+        for (size_t s = 0; s < steps; s++) {
+            select_actions(epsilon);
+            envs.step(actions.data(), rewards.data(), dones.data());
+            envs.write_states(*next_states);
+            if (memory != nullptr)
+                tbb::parallel_for(tbb::blocked_range<size_t>(0, n, ENV_BLOCK), [&](const tbb::blocked_range<size_t>& block) {
+                    for (size_t i = block.begin(); i < block.end(); i++)
+                        memory->add(states->row(i), actions[i], rewards[i], next_states->row(i), dones[i] != 0);
+                });
+            std::swap(states, next_states);
+            step_count++;
+        }
+    }
+
+    // A newly trained network (or null: uniform actions again) for the following steps
+    void set_policy(mlp::Network* network) { policy = network; }
+
+    uint64_t steps() const { return step_count; }
+    VectorEnv& environments() const { return envs; }
+    const int32_t* last_actions() const { return actions.data(); }
+    const float* last_rewards() const { return rewards.data(); }
+};
+
+} // namespace rollout
@@ -0,0 +1,222 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace venue_metrics
+{
+
+enum class ReportType : uint8_t { SENT, ACK, PARTIAL_FILL, FILL, REJECTED, CANCELLED };
+
+// One execution report, as much of it as the venue statistics need
+struct VenueReport {
+    uint64_t time_ns;
+    int32_t venue;
+    ReportType type;
+    int32_t quantity;       // fills
+    double slippage_bps;    // fills, against the arrival price, positive = cost
+    uint64_t latency_ns;    // ACK: time from SENT to the venue's ack
+};
+
+// What the router reads for one venue, always a consistent set of values, as of time_ns.
+// Rates are exponentially decayed (recent reports weigh more), the window_* counts cover
+// the last WINDOW_BUCKETS seconds.
+struct VenueSnapshot {
+    uint64_t time_ns;
+    double fill_rate;
+    double reject_rate;
+    double cancel_rate;
+    double slippage_bps;
+    double ack_latency_us;
+    uint32_t window_orders;
+    uint32_t window_fills;
+    uint32_t window_rejects;
+    uint32_t window_cancels;
+};
+
+const uint64_t WINDOW_BUCKET_NS = 1000000000ull;
+const uint64_t WINDOW_BUCKETS = 60;
+
+// Single writer / many readers, no locks on either side.
+// The writer makes the sequence odd, copies the value, makes it even again; a reader copies the value
+// between two loads of the sequence and retries if it changed or was odd (a write was in progress).
+// Readers never block the writer; a read only retries when it overlaps a write (tens of ns).
+template <class T>
+class Seqlock {
+private:
+    alignas(64) std::atomic<uint64_t> sequence{0};
+    T value{};
+
+public:
+    void store(const T& v) {
+        uint64_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(static_cast<void*>(&value), &v, sizeof(T));
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    // Returns the number of retries (0 unless the read raced a write)
+    size_t load(T& out) const {
+        size_t retries = 0;
+        while (true) {
+            uint64_t before = sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                std::memcpy(static_cast<void*>(&out), &value, sizeof(T));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before)
+                    return retries;
+            }
+            retries++;
+        }
+    }
+};
+
+// Live venue statistics built from the execution report stream (writer: the thread that
+// receives the reports), published per venue through a seqlock so the router can read them
+// on every routing decision.
+// - decayed rates: every count is multiplied by 2^(-dt / half_life) before an event is added,
+//   so a rate reacts in about one half-life and there is no window edge
+// - windowed counts: a ring of 1s buckets with running totals, a bucket leaving the window
+//   is subtracted once
+class VenueMetricsStore {
+private:
+    struct Bucket {
+        uint64_t second;
+        uint32_t orders, fills, rejects, cancels;
+    };
+    // writer side state, one per venue
+    struct VenueState {
+        uint64_t last_ns;
+        double orders, fills, rejects, cancels;        // decayed counts
+        double slippage, slippage_qty;                 // decayed, quantity weighted
+        double latency, latency_count;                 // decayed
+        uint64_t window_head;                          // newest second in the ring
+        Bucket window[WINDOW_BUCKETS];
+        uint32_t window_orders, window_fills, window_rejects, window_cancels;
+    };
+    struct alignas(64) Published {
+        Seqlock<VenueSnapshot> snapshot;
+    };
+
+    std::vector<VenueState> state;
+    std::vector<Published> published;
+    double decay_per_ns;   // ln(2) / half_life
+
+    void decay(VenueState& v, uint64_t now) {
+        if (now <= v.last_ns)
+            return;
+        double f = std::exp(-static_cast<double>(now - v.last_ns) * decay_per_ns);
+        v.orders *= f;
+        v.fills *= f;
+        v.rejects *= f;
+        v.cancels *= f;
+        v.slippage *= f;
+        v.slippage_qty *= f;
+        v.latency *= f;
+        v.latency_count *= f;
+        v.last_ns = now;
+    }
+
+    Bucket& window_bucket(VenueState& v, uint64_t now) {
+        uint64_t second = now / WINDOW_BUCKET_NS;
+        if (second > v.window_head) {
+            uint64_t from = second - v.window_head > WINDOW_BUCKETS ? second - WINDOW_BUCKETS + 1 : v.window_head + 1;
+            for (uint64_t s = from; s <= second; s++) {
+                Bucket& old = v.window[s % WINDOW_BUCKETS];
+                v.window_orders -= old.orders;
+                v.window_fills -= old.fills;
+                v.window_rejects -= old.rejects;
+                v.window_cancels -= old.cancels;
+                old = Bucket{s, 0, 0, 0, 0};
+            }
+            v.window_head = second;
+        }
+        return v.window[v.window_head % WINDOW_BUCKETS];
+    }
+
+    void publish(int32_t venue) {
+        const VenueState& v = state[venue];
+        VenueSnapshot s;
+        s.time_ns = v.last_ns;
+        s.fill_rate = v.orders > 0 ? v.fills / v.orders : 0;
+        s.reject_rate = v.orders > 0 ? v.rejects / v.orders : 0;
+        s.cancel_rate = v.orders > 0 ? v.cancels / v.orders : 0;
+        s.slippage_bps = v.slippage_qty > 0 ? v.slippage / v.slippage_qty : 0;
+        s.ack_latency_us = v.latency_count > 0 ? v.latency / v.latency_count * 1e-3 : 0;
+        s.window_orders = v.window_orders;
+        s.window_fills = v.window_fills;
+        s.window_rejects = v.window_rejects;
+        s.window_cancels = v.window_cancels;
+        published[venue].snapshot.store(s);
+    }
+
+public:
+    VenueMetricsStore(int num_venues, uint64_t half_life_ns)
+        : state(num_venues), published(num_venues), decay_per_ns(std::log(2.0) / half_life_ns) {
+        for (VenueState& v : state)
+            std::memset(static_cast<void*>(&v), 0, sizeof(VenueState));
+    }
+
+    // Writer thread
+    void on_report(const VenueReport& r) {
+        VenueState& v = state[r.venue];
+        decay(v, r.time_ns);
+        Bucket& bucket = window_bucket(v, r.time_ns);
+        switch (r.type) {
+        case ReportType::SENT:
+            v.orders += 1;
+            bucket.orders++;
+            v.window_orders++;
+            break;
+        case ReportType::ACK:
+            v.latency += static_cast<double>(r.latency_ns);
+            v.latency_count += 1;
+            break;
+        case ReportType::PARTIAL_FILL:
+        case ReportType::FILL:
+            v.slippage += r.slippage_bps * r.quantity;
+            v.slippage_qty += r.quantity;
+            if (r.type == ReportType::FILL) {
+                v.fills += 1;
+                bucket.fills++;
+                v.window_fills++;
+            }
+            break;
+        case ReportType::REJECTED:
+            v.rejects += 1;
+            bucket.rejects++;
+            v.window_rejects++;
+            break;
+        case ReportType::CANCELLED:
+            v.cancels += 1;
+            bucket.cancels++;
+            v.window_cancels++;
+            break;
+        }
+        publish(r.venue);
+    }
+
+    // Writer thread, on a timer: ages the statistics of venues that stopped reporting
+    void on_timer(uint64_t now) {
+        for (int32_t venue = 0; venue < venues(); venue++) {
+            decay(state[venue], now);
+            window_bucket(state[venue], now);
+            publish(venue);
+        }
+    }
+
+    // Any thread
+    VenueSnapshot read(int32_t venue) const {
+        VenueSnapshot s;
+        published[venue].snapshot.load(s);
+        return s;
+    }
+
+    int venues() const { return static_cast<int>(state.size()); }
+};
+
+} // namespace venue_metrics
@@ -1,36 +1,47 @@
+#include <chrono>
+#include "../chapter_3/hot_path_warmup.hpp"
 
-bool check_for_critical_message() {
-    auto msg = check_network_messaged();    
-    return msg == 1;
+// The warm-up loop of chapter_3's trading stack (hot_path_warmup.hpp): while no message
+// arrives, the same parser -> book -> strategy -> risk -> encoder path runs on synthetic events,
+// and only the final send is skipped.
+
+// Simulated function to check for network messages: size of the message copied into buffer, 0 if none
+size_t check_network_messaged(char* buffer)
+{
+    (void)buffer;
+    return 0; // return the message
+}
+
+int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool check_for_critical_message(char* buffer, size_t& size) {
+    size = check_network_messaged(buffer);
+    return size > 0;
 }
 
-void process_critical_message(bool warmup_mode) 
+void process_critical_message(warmup::TradingLoop& loop, const char* buffer, size_t size, bool warmup_mode)
 {
     if (warmup_mode) {
-        //do nothing
+        loop.on_idle(now_ns());                 // synthetic event, nothing sent
     } else {
-        // Process actual critical message        
+        loop.on_message(buffer, size, now_ns()); // Process actual critical message
     }
 }
 
 // Main loop with warm-up routine
-void run_trading_system() {
+void run_trading_system(warmup::TradingLoop& loop) {
+    char buffer[sizeof(warmup::FeedMessage)];
+    size_t size = 0;
     while (true) {
         // Check for critical message in real-time
-        if (check_for_critical_message()) {
-            process_critical_message(false); // Real mode
+        if (check_for_critical_message(buffer, size)) {
+            process_critical_message(loop, buffer, size, false); // Real mode
         }
         else {
-            process_critical_message(true); // Warm-up mode
+            process_critical_message(loop, buffer, size, true); // Warm-up mode
         }
     }
 }
-
-
-
-
-// Simulated function to check for network messages
-int check_network_messaged()
-{
-    return 0; // return the message
-}